@@ -0,0 +1,19 @@
+#!/usr/bin/env bash
+# Measures cold start to the first playable frame. Each run launches the game headless with the
+# GAM312 game mode, which logs "Time to first playable frame" and quits on -gamstartupexit.
+#
+# Usage: ColdStartBenchmark.sh <UnrealEditor binary or packaged game> <GAM312.uproject or ""> [Runs=5] [Map=/Game/FirstPerson/Maps/Langlash]
+# Clear the OS file cache between runs for a true cold start, e.g. "sync; echo 3 > /proc/sys/vm/drop_caches" as root.
+
+set -euo pipefail
+
+GAME="$1"
+PROJECT="$2"
+RUNS="${3:-5}"
+MAP="${4:-/Game/FirstPerson/Maps/Langlash}"
+
+for ((Run = 1; Run <= RUNS; Run++)); do
+	LOG="ColdStart_${Run}.log"
+	"$GAME" $PROJECT "${MAP}?game=/Script/GAM312.GAM312GameMode" -game -nullrhi -nosound -unattended -nosplash -gamstartupexit -abslog="$LOG" || true
+	grep -o "Time to first playable frame: [0-9.]* s" "$LOG" || echo "Run $Run did not reach a playable frame, see $LOG"
+done
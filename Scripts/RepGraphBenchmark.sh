@@ -0,0 +1,33 @@
+#!/usr/bin/env bash
+# Runs a dedicated server with the replication graph benchmark enabled and connects
+# N headless clients to it. The server log (Saved/Logs) gets one "Replication benchmark" line per window.
+#
+# Usage: RepGraphBenchmark.sh <UnrealEditor binary> <GAM312.uproject> [Clients=16] [Seconds=120] [Map=/Game/FirstPerson/Maps/Langlash]
+# Run it once with 16 and once with 64 clients and compare the per connection cost.
+
+set -euo pipefail
+
+EDITOR="$1"
+PROJECT="$2"
+CLIENTS="${3:-16}"
+SECONDS_TO_RUN="${4:-120}"
+MAP="${5:-/Game/FirstPerson/Maps/Langlash}"
+
+"$EDITOR" "$PROJECT" "$MAP" -server -nullrhi -nosound -unattended -log -gamrepbench=10 -abslog="RepGraphBenchmark_${CLIENTS}.log" &
+SERVER_PID=$!
+sleep 20
+
+CLIENT_PIDS=()
+for ((Index = 0; Index < CLIENTS; Index++)); do
+	"$EDITOR" "$PROJECT" 127.0.0.1 -game -nullrhi -nosound -unattended -nosplash -ResX=320 -ResY=240 -windowed &
+	CLIENT_PIDS+=($!)
+	sleep 0.5
+done
+
+sleep "$SECONDS_TO_RUN"
+
+kill "${CLIENT_PIDS[@]}" 2>/dev/null || true
+kill "$SERVER_PID" 2>/dev/null || true
+wait || true
+
+grep "Replication benchmark" "RepGraphBenchmark_${CLIENTS}.log" || true
@@ -0,0 +1,29 @@
+#!/usr/bin/env bash
+# Measures the stall of a seamless travel. Each run launches the game headless on the start map, the
+# travel subsystem travels to the destination with -gamtravel=, logs the total stall and quits on
+# -gamtravelexit with exit code 1 when the travel failed or went over gam.Travel.StallBudgetMs.
+#
+# Usage: TravelBenchmark.sh <UnrealEditor binary or packaged game> <GAM312.uproject or ""> [Runs=3] [From=/Game/FirstPerson/Maps/Langlash] [To=/Game/FirstPerson/Maps/FirstPersonMap] [BudgetMs=250]
+
+set -euo pipefail
+
+GAME="$1"
+PROJECT="$2"
+RUNS="${3:-3}"
+FROM="${4:-/Game/FirstPerson/Maps/Langlash}"
+TO="${5:-/Game/FirstPerson/Maps/FirstPersonMap}"
+BUDGET_MS="${6:-250}"
+
+FAILED=0
+for ((Run = 1; Run <= RUNS; Run++)); do
+	LOG="Travel_${Run}.log"
+	STATUS=0
+	"$GAME" $PROJECT "${FROM}?game=/Script/GAM312.GAM312GameMode" -game -nullrhi -nosound -unattended -nosplash -gamtravel="$TO" -gamtravelexit -ExecCmds="gam.Travel.StallBudgetMs $BUDGET_MS" -abslog="$LOG" || STATUS=$?
+	grep -o "Travel to .*" "$LOG" || echo "Run $Run did not finish a travel, see $LOG"
+	if [ "$STATUS" -ne 0 ]; then
+		echo "Run $Run failed with exit code $STATUS"
+		FAILED=1
+	fi
+done
+
+exit "$FAILED"
@@ -2,52 +2,185 @@
 
 
 #include "CameraDirector.h"
+#include "GAM312StreamingSubsystem.h"
+#include "ContentStreaming.h"
+#include "EngineUtils.h"
 #include "Kismet/GameplayStatics.h"
+#include "TimerManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Camera, Log, All);
+
+static FAutoConsoleCommandWithWorldAndArgs GCameraPlayCommand(
+	TEXT("gam.Camera.Play"),
+	TEXT("Plays the first camera director in the world."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		TActorIterator<ACameraDirector> It(World);
+		if (It)
+		{
+			It->Play();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GCameraStopCommand(
+	TEXT("gam.Camera.Stop"),
+	TEXT("Stops the first camera director in the world and logs how many shots started before their cells loaded."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		TActorIterator<ACameraDirector> It(World);
+		if (It)
+		{
+			It->Stop();
+		}
+	}));
 
 // Sets default values
 ACameraDirector::ACameraDirector()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
-
-	
+ 	// Shots are switched by timers, the director never ticks
+	PrimaryActorTick.bCanEverTick = false;
 
+	CameraOne = nullptr;
+	CameraTwo = nullptr;
 }
 
 // Called when the game starts or when spawned
 void ACameraDirector::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	// The original two camera setup, cut to camera one and blend smoothly to camera two
+	if (Shots.Num() == 0)
+	{
+		if (CameraOne != nullptr)
+		{
+			FGAM312CameraShot& Shot = Shots.AddDefaulted_GetRef();
+			Shot.Camera = CameraOne;
+		}
+		if (CameraTwo != nullptr)
+		{
+			FGAM312CameraShot& Shot = Shots.AddDefaulted_GetRef();
+			Shot.Camera = CameraTwo;
+			Shot.BlendTime = 0.75f;
+		}
+	}
+
+	Transitions.Reset(Shots.Num());
+	for (const FGAM312CameraShot& Shot : Shots)
+	{
+		FViewTargetTransitionParams& Transition = Transitions.AddDefaulted_GetRef();
+		Transition.BlendTime = Shot.BlendTime;
+		Transition.BlendFunction = Shot.BlendFunction;
+		Transition.BlendExp = Shot.BlendExp;
+	}
+
+	if (bAutoPlay)
+	{
+		Play();
+	}
+}
+
+// Called when the director is destroyed or the level is unloaded
+void ACameraDirector::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorldTimerManager().ClearTimer(ShotTimer);
+	GetWorldTimerManager().ClearTimer(PrefetchTimer);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ACameraDirector::Play()
+{
+	if (Shots.Num() == 0)
+	{
+		return;
+	}
+
+	UnloadedShots = 0;
+
+	// The first camera has had no lead time, so it starts streaming now
+	PrefetchShot(0);
+	PlayShot(0);
+}
+
+void ACameraDirector::Stop()
+{
+	GetWorldTimerManager().ClearTimer(ShotTimer);
+	GetWorldTimerManager().ClearTimer(PrefetchTimer);
+
+	APlayerController* OurPlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	if (OurPlayerController && OurPlayerController->GetPawn())
+	{
+		OurPlayerController->SetViewTarget(OurPlayerController->GetPawn());
+	}
+
+	UE_LOG(LogGAM312Camera, Display, TEXT("%s stopped, %d shots started before their cells loaded"), *GetName(), UnloadedShots);
 }
 
-// Called every frame
-void ACameraDirector::Tick(float DeltaTime)
+int32 ACameraDirector::GetNextShot(int32 ShotIndex) const
 {
-	Super::Tick(DeltaTime);
-/*
-	const float TimeBetweenCameraChange = 2.0f;
-	const float SmoothBlendTime = 0.75f;
-	TimeToNextCameraChange -= DeltaTime;
-	if (TimeToNextCameraChange <= 0.0f)
+	if (ShotIndex + 1 < Shots.Num())
 	{
-		TimeToNextCameraChange += TimeBetweenCameraChange;
+		return ShotIndex + 1;
+	}
+	return bLoop ? 0 : INDEX_NONE;
+}
 
-		// Find the actor that handles control for the local player
-		APlayerController* OurPlayerController = UGameplayStatics::GetPlayerController(this, 0);
-		if (OurPlayerController)
+void ACameraDirector::PlayShot(int32 ShotIndex)
+{
+	const FGAM312CameraShot& Shot = Shots[ShotIndex];
+
+	// Find the actor that handles control for the local player
+	APlayerController* OurPlayerController = UGameplayStatics::GetPlayerController(this, 0);
+	if (OurPlayerController && Shot.Camera)
+	{
+		UGAM312StreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UGAM312StreamingSubsystem>();
+		if (Streaming && !Streaming->IsLocationStreamed(Shot.Camera->GetActorLocation()))
 		{
-			if ((OurPlayerController->GetViewTarget() != CameraOne) && (CameraOne != nullptr))
-			{
-				// Cut instantly to camera one
-				OurPlayerController->SetViewTarget(CameraOne);
-			}
-			else if ((OurPlayerController->GetViewTarget() != CameraTwo) && (CameraTwo != nullptr))
-			{
-				// Blend smoothly to camera two
-				OurPlayerController->SetViewTargetWithBlend(CameraTwo, SmoothBlendTime);
-			}
+			++UnloadedShots;
+			UE_LOG(LogGAM312Camera, Warning, TEXT("Shot %d on %s started before its cells loaded"), ShotIndex, *Shot.Camera->GetName());
 		}
-	}*/
+
+		// Cuts and blends both go through the precomputed transition
+		OurPlayerController->SetViewTarget(Shot.Camera, Transitions[ShotIndex]);
+	}
+
+	const int32 NextShot = GetNextShot(ShotIndex);
+	if (NextShot == INDEX_NONE)
+	{
+		return;
+	}
+
+	const float HoldTime = FMath::Max(Shot.HoldTime, 0.01f);
+	const float PrefetchDelay = HoldTime - PrefetchLeadTime;
+	if (PrefetchDelay > 0.0f)
+	{
+		GetWorldTimerManager().SetTimer(PrefetchTimer, FTimerDelegate::CreateUObject(this, &ACameraDirector::PrefetchShot, NextShot), PrefetchDelay, false);
+	}
+	else
+	{
+		PrefetchShot(NextShot);
+	}
+
+	GetWorldTimerManager().SetTimer(ShotTimer, FTimerDelegate::CreateUObject(this, &ACameraDirector::PlayShot, NextShot), HoldTime, false);
 }
 
+void ACameraDirector::PrefetchShot(int32 ShotIndex)
+{
+	const FGAM312CameraShot& Shot = Shots[ShotIndex];
+	if (Shot.Camera == nullptr)
+	{
+		return;
+	}
+
+	// Held through the lead time and the blend, after that the camera is the view target and streams itself
+	const FVector Location = Shot.Camera->GetActorLocation();
+	const float Duration = PrefetchLeadTime + Shot.BlendTime + 1.0f;
+
+	if (UGAM312StreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UGAM312StreamingSubsystem>())
+	{
+		Streaming->AddPrefetchLocation(Location, Duration);
+	}
+
+	IStreamingManager::Get().AddViewLocation(Location, 1.0f, false, Duration);
+}
@@ -4,8 +4,44 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Camera/PlayerCameraManager.h"
 #include "CameraDirector.generated.h"
 
+// One camera on the director's timeline
+USTRUCT(BlueprintType)
+struct FGAM312CameraShot
+{
+	GENERATED_BODY()
+
+	// Camera to view through
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	AActor* Camera = nullptr;
+
+	// Seconds on this camera before the next shot starts
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float HoldTime = 2.0f;
+
+	// Seconds blending in from the previous camera, 0 cuts
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BlendTime = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TEnumAsByte<EViewTargetBlendFunction> BlendFunction = VTBlend_Cubic;
+
+	// Exponent for the ease blend functions
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BlendExp = 2.0f;
+};
+
+/**
+ * Plays the first player's view through a timeline of cameras using timers, without ticking. Each
+ * upcoming camera is prefetched PrefetchLeadTime seconds before its shot: its location becomes a
+ * World Partition streaming source and a texture streaming view, so its surroundings are loaded by
+ * the time the view switches. Every shot checks that its cells were loaded and counts the ones
+ * that were not.
+ *
+ * gam.Camera.Play starts the first director in the world and gam.Camera.Stop hands the view back.
+ */
 UCLASS()
 class GAM312_API ACameraDirector : public AActor
 {
@@ -19,16 +55,58 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called when the director is destroyed or the level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+public:	
 	UPROPERTY(EditAnywhere)
 	AActor* CameraOne;
 
 	UPROPERTY(EditAnywhere)
 	AActor* CameraTwo;
 
-	float TimeToNextCameraChange;
+	// Cameras in order, when empty CameraOne is cut to and CameraTwo blended to every 2 seconds
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	TArray<FGAM312CameraShot> Shots;
+
+	// Start over from the first shot after the last one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	bool bLoop = true;
+
+	// Start playing as soon as the director begins play
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	bool bAutoPlay = false;
+
+	// Seconds before a shot that its camera's surroundings start streaming in
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	float PrefetchLeadTime = 2.0f;
+
+	// Starts the timeline from the first shot
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void Play();
+
+	// Stops the timeline and gives the view back to the player's pawn
+	UFUNCTION(BlueprintCallable, Category = "Camera")
+	void Stop();
+
+	// Shots that started before their camera's cells had loaded
+	int32 GetUnloadedShots() const { return UnloadedShots; }
+
+private:
+	// Switches to a shot and schedules the prefetch and start of the one after it
+	void PlayShot(int32 ShotIndex);
+
+	// Starts streaming in a shot's surroundings ahead of the switch
+	void PrefetchShot(int32 ShotIndex);
+
+	// Shot after ShotIndex, INDEX_NONE at the end of a timeline that does not loop
+	int32 GetNextShot(int32 ShotIndex) const;
+
+	// Blend parameters for each shot, built once when play begins
+	TArray<FViewTargetTransitionParams> Transitions;
+
+	FTimerHandle ShotTimer;
+	FTimerHandle PrefetchTimer;
 
+	int32 UnloadedShots = 0;
 };
@@ -3,61 +3,100 @@
 
 #include "Cube.h"
 #include "Kismet/GameplayStatics.h"
+#include "GAM312DamageFlashComponent.h"
 #include "GAM312Projectile.h"
+#include "GAM312Stats.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
 
 
 // Sets default values
 ACube::ACube()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	LLM_SCOPE_BYTAG(GAM312_Cubes);
+
+ 	// Cubes only react to hits, they never need to tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Creates cubemesh component and sets it to start physics
 	CubeMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("CubeMesh"));
-	DamagedCubeMaterial = CreateDefaultSubobject<UMaterialInstance>(TEXT("DamageMaterial"));
-	CubeMaterial = CreateDefaultSubobject < UMaterialInstance>(TEXT("CubeMaterial"));
 
 	CubeMesh->SetSimulatePhysics(true);
+
+	// With async physics the cube's pushes are applied on the fixed physics step
+	bAsyncPhysicsTickEnabled = UPhysicsSettings::Get()->bTickPhysicsAsync;
+
+	DamageFlash = CreateDefaultSubobject<UGAM312DamageFlashComponent>(TEXT("DamageFlash"));
 }
 
 // Called when the game starts or when spawned
 void ACube::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(GAM312_Cubes);
+
 	Super::BeginPlay();
 	
 	// Gets the OnComponentHit function to handle hits
 	CubeMesh->OnComponentHit.AddDynamic(this, &ACube::OnComponentHit);
+
+	// Set once before the first frame, hits after this only write custom primitive data
+	if (CubeMaterial != nullptr)
+	{
+		CubeMesh->SetMaterial(0, CubeMaterial);
+	}
 }
 
-// Function that is called when cube takes damage
-void ACube::OnTakeDamage()
+// Called on the physics thread at the fixed step while physics runs async
+void ACube::AsyncPhysicsTickActor(float DeltaTime, float SimTime)
 {
-	CubeMesh->SetMaterial(0, DamagedCubeMaterial);
-	GetWorld()->GetTimerManager().SetTimer(DamageTimer, this, &ACube::ResetDamage, 1.5f, false);
+	Super::AsyncPhysicsTickActor(DeltaTime, SimTime);
+
+	FBodyInstance* Body = CubeMesh->GetBodyInstance();
+	Chaos::FRigidBodyHandle_Internal* Handle = Body && Body->ActorHandle ? Body->ActorHandle->GetPhysicsThreadAPI() : nullptr;
+
+	// Each impulse is spread over this one step as a force and a torque about the body origin
+	TPair<FVector, FVector> Pending;
+	while (PendingImpulses.Dequeue(Pending))
+	{
+		if (Handle && DeltaTime > 0.0f)
+		{
+			Handle->AddForce(Pending.Key / DeltaTime);
+			Handle->AddTorque(FVector::CrossProduct(Pending.Value - Handle->X(), Pending.Key) / DeltaTime);
+		}
+	}
 }
 
-// Function that resets the material back to blue after a delay
-void ACube::ResetDamage()
+void ACube::AddHitImpulse(const FVector& Impulse, const FVector& Location)
 {
-	CubeMesh->SetMaterial(0, CubeMaterial);
+	if (bAsyncPhysicsTickEnabled)
+	{
+		PendingImpulses.Enqueue(TPair<FVector, FVector>(Impulse, Location));
+	}
+	else
+	{
+		CubeMesh->AddImpulseAtLocation(Impulse, Location);
+	}
+}
+
+// Function that is called when cube takes damage
+void ACube::OnTakeDamage()
+{
+	// Stamps the hit time, the cube material turns red and fades back to blue from it
+	DamageFlash->Flash(CubeMesh);
 }
 
 // Function that is called when the cube is hit by GAM312Projectile
 void ACube::OnComponentHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_CubeHit);
+
 	// Checks to see if the cube is hit by the GAM312Projectile
 	if (AGAM312Projectile* HitActor = Cast<AGAM312Projectile>(OtherActor))
 	{
+		GAM312Stats::AddHit();
+
 		// This applies damage and triggers the effect
 		UGameplayStatics::ApplyDamage(this, 20.0f, nullptr, OtherActor, UDamageType::StaticClass());
 		OnTakeDamage();
 	}
 }
-
-// Called every frame
-void ACube::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
-
-}
-
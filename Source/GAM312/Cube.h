@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Containers/Queue.h"
 #include "Cube.generated.h"
 
 UCLASS()
@@ -19,24 +20,22 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called on every fixed physics step while bTickPhysicsAsync is on
+	virtual void AsyncPhysicsTickActor(float DeltaTime, float SimTime) override;
 
-	// Material for cube
+public:	
+	// Cube mesh
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
 	class UStaticMeshComponent* CubeMesh;
 
-	// Damage material for cube
-	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
-	UMaterialInstance* CubeMaterial;
-
-	// Function that is called when cube is hit by GAM312Projectile
+	// Material put on the cube mesh at BeginPlay, empty keeps the mesh's own. Whichever is used has to
+	// fade the damage flash from the hit time in custom primitive data, see UGAM312DamageFlashComponent
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite)
-	UMaterialInstance* DamagedCubeMaterial;
+	class UMaterialInterface* CubeMaterial = nullptr;
 
-	// Handles timer for cube after being hit
-	FTimerHandle DamageTimer;
+	// Writes the hit time the cube material fades the flash from
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	class UGAM312DamageFlashComponent* DamageFlash;
 
 	// Function that is called when cube is hit by another component
 	UFUNCTION()
@@ -45,6 +44,11 @@ public:
 	
 	// Function called when cube takes damage
 	void OnTakeDamage();
-	// Function that resets cube color after being struck
-	void ResetDamage();
+
+	// Pushes the cube, on the next fixed physics step when physics runs async
+	void AddHitImpulse(const FVector& Impulse, const FVector& Location);
+
+private:
+	// Impulses and where they hit, queued on the game thread for the physics thread
+	TQueue<TPair<FVector, FVector>, EQueueMode::Mpsc> PendingImpulses;
 };
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CubeField.h"
+#include "GAM312DamageFlashComponent.h"
+#include "GAM312Projectile.h"
+#include "GAM312Stats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Kismet/GameplayStatics.h"
+
+// Sets default values
+ACubeField::ACubeField()
+{
+	LLM_SCOPE_BYTAG(GAM312_Cubes);
+
+	// The field only reacts to hits and sleep events, it never needs to tick
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Resting cubes are static instances, only the ones knocked loose simulate
+	Instances = CreateDefaultSubobject<UInstancedStaticMeshComponent>(TEXT("Instances"));
+	Instances->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Instances->SetSimulatePhysics(false);
+	RootComponent = Instances;
+
+	// One custom data float per instance holds the hit time for the damage flash
+	DamageFlash = CreateDefaultSubobject<UGAM312DamageFlashComponent>(TEXT("DamageFlash"));
+}
+
+void ACubeField::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	Instances->SetStaticMesh(CubeMesh);
+	Instances->SetMaterial(0, CubeMaterial);
+	Instances->NumCustomDataFloats = FMath::Max(Instances->NumCustomDataFloats, DamageFlash->HitTimeDataIndex + 1);
+
+	// Lay the cubes out as a grid centered on X and Y, growing up from the actor
+	if (GridCount.X > 0 && GridCount.Y > 0 && GridCount.Z > 0)
+	{
+		Instances->ClearInstances();
+
+		TArray<FTransform> Transforms;
+		Transforms.Reserve(GridCount.X * GridCount.Y * GridCount.Z);
+		const FVector Offset(-(GridCount.X - 1) * Spacing * 0.5f, -(GridCount.Y - 1) * Spacing * 0.5f, Spacing * 0.5f);
+		for (int32 Z = 0; Z < GridCount.Z; ++Z)
+		{
+			for (int32 Y = 0; Y < GridCount.Y; ++Y)
+			{
+				for (int32 X = 0; X < GridCount.X; ++X)
+				{
+					Transforms.Add(FTransform(Offset + FVector(X, Y, Z) * Spacing));
+				}
+			}
+		}
+		Instances->AddInstances(Transforms, false);
+	}
+}
+
+// Called when the game starts or when spawned
+void ACubeField::BeginPlay()
+{
+	LLM_SCOPE_BYTAG(GAM312_Cubes);
+
+	Super::BeginPlay();
+
+	Instances->OnComponentHit.AddDynamic(this, &ACubeField::OnInstancesHit);
+
+	DamageFlash->FlashMaterial = DamagedCubeMaterial;
+	DamageFlash->RestoreMaterial = CubeMaterial;
+	DamageFlash->FlashDuration = DamageFlashDuration;
+
+	// Create the whole pool up front so a hit never has to create a component
+	for (int32 Index = 0; Index < MaxActiveCubes; ++Index)
+	{
+		UStaticMeshComponent* Component = NewObject<UStaticMeshComponent>(this);
+		Component->SetStaticMesh(CubeMesh);
+		Component->SetMaterial(0, CubeMaterial);
+		Component->SetCollisionProfileName(UCollisionProfile::PhysicsActor_ProfileName);
+		Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		Component->SetVisibility(false);
+		Component->BodyInstance.bGenerateWakeEvents = true;
+		Component->OnComponentHit.AddDynamic(this, &ACubeField::OnActiveCubeHit);
+		Component->OnComponentSleep.AddDynamic(this, &ACubeField::OnActiveCubeSleep);
+		Component->RegisterComponent();
+
+		FreeComponents.Add(Component);
+	}
+}
+
+// Function that is called when a resting cube is hit
+void ACubeField::OnInstancesHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_CubeHit);
+
+	// Checks to see if the cube is hit by the GAM312Projectile
+	if (Cast<AGAM312Projectile>(OtherActor) == nullptr)
+	{
+		return;
+	}
+
+	// The hit is reported from the projectile's side, so this component's instance is MyItem
+	const int32 InstanceIndex = Hit.MyItem != INDEX_NONE ? Hit.MyItem : Hit.Item;
+	if (!Instances->IsValidInstance(InstanceIndex))
+	{
+		return;
+	}
+
+	GAM312Stats::AddHit();
+
+	if (UStaticMeshComponent* Component = ActivateInstance(InstanceIndex))
+	{
+		// Same push the projectile gives a simulating ACube
+		Component->AddImpulseAtLocation(OtherActor->GetVelocity() * 100.0f * HitImpulseScale, Hit.ImpactPoint);
+		TakeHit(Component, OtherActor);
+	}
+}
+
+// Function that is called when a simulating cube is hit
+void ACubeField::OnActiveCubeHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_CubeHit);
+
+	if (Cast<AGAM312Projectile>(OtherActor))
+	{
+		GAM312Stats::AddHit();
+		TakeHit(Cast<UStaticMeshComponent>(HitComp), OtherActor);
+	}
+}
+
+// Function that is called when a simulating cube comes to rest
+void ACubeField::OnActiveCubeSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	const int32 ActiveIndex = ActiveCubes.IndexOfByKey(SleepingComponent);
+	if (ActiveIndex != INDEX_NONE)
+	{
+		DeactivateCube(ActiveIndex);
+	}
+}
+
+// Function that is called when a hitscan shot hits the field
+void ACubeField::TakeTraceHit(const FHitResult& Hit, const FVector& Impulse, AActor* DamageCauser)
+{
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_CubeHit);
+
+	// A resting cube is taken out of the instances first, a trace reports the instance as Item
+	UStaticMeshComponent* Component = nullptr;
+	if (Hit.GetComponent() == Instances)
+	{
+		if (Instances->IsValidInstance(Hit.Item))
+		{
+			Component = ActivateInstance(Hit.Item);
+		}
+	}
+	else if (ActiveCubes.Contains(Hit.GetComponent()))
+	{
+		Component = Cast<UStaticMeshComponent>(Hit.GetComponent());
+	}
+
+	if (Component)
+	{
+		Component->AddImpulseAtLocation(Impulse * HitImpulseScale, Hit.ImpactPoint);
+		TakeHit(Component, DamageCauser);
+	}
+}
+
+UStaticMeshComponent* ACubeField::ActivateInstance(int32 InstanceIndex)
+{
+	LLM_SCOPE_BYTAG(GAM312_Cubes);
+
+	// Out of components, settle the cube that has been moving the longest
+	if (FreeComponents.Num() == 0)
+	{
+		if (ActiveCubes.Num() == 0)
+		{
+			return nullptr;
+		}
+		DeactivateCube(0);
+	}
+
+	FTransform InstanceTransform;
+	Instances->GetInstanceTransform(InstanceIndex, InstanceTransform, true);
+	const float HitTime = DamageFlash->GetHitTime(Instances, InstanceIndex);
+	Instances->RemoveInstance(InstanceIndex);
+
+	UStaticMeshComponent* Component = FreeComponents.Pop(false);
+	DamageFlash->SetHitTime(Component, HitTime);
+	Component->SetWorldTransform(InstanceTransform, false, nullptr, ETeleportType::TeleportPhysics);
+	Component->SetVisibility(true);
+	Component->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+	Component->SetSimulatePhysics(true);
+
+	ActiveCubes.Add(Component);
+	GAM312Stats::SetGauge(TEXT("CubeField.ActiveCubes"), ActiveCubes.Num(), MaxActiveCubes);
+
+	return Component;
+}
+
+void ACubeField::DeactivateCube(int32 ActiveIndex)
+{
+	UStaticMeshComponent* Component = ActiveCubes[ActiveIndex];
+	ActiveCubes.RemoveAt(ActiveIndex, 1, false);
+	DamageFlash->EndFlash(Component);
+
+	// Back into the instance buffer where it came to rest, a flash in progress carries on there
+	const int32 InstanceIndex = Instances->AddInstance(Component->GetComponentTransform(), true);
+	DamageFlash->SetHitTime(Instances, DamageFlash->GetHitTime(Component), InstanceIndex);
+
+	Component->SetSimulatePhysics(false);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetVisibility(false);
+	FreeComponents.Add(Component);
+
+	GAM312Stats::SetGauge(TEXT("CubeField.ActiveCubes"), ActiveCubes.Num(), MaxActiveCubes);
+}
+
+void ACubeField::TakeHit(UStaticMeshComponent* Component, AActor* DamageCauser)
+{
+	// This applies damage and triggers the effect
+	UGameplayStatics::ApplyDamage(this, 20.0f, nullptr, DamageCauser, UDamageType::StaticClass());
+	DamageFlash->Flash(Component);
+}
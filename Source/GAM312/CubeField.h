@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CubeField.generated.h"
+
+class UInstancedStaticMeshComponent;
+class UStaticMeshComponent;
+class UStaticMesh;
+class UMaterialInterface;
+class UGAM312DamageFlashComponent;
+
+/**
+ * A wall or field of target cubes drawn as instances of one instanced static mesh with static
+ * collision. A cube hit by a GAM312Projectile is taken out of the instances and handed to a pooled
+ * simulating mesh component, which is put back into the instances once its body falls asleep.
+ * Hits do the same damage and flash as ACube. The flash lives in custom data, one float per
+ * instance, and moves with the cube between the instances and the pooled components. While
+ * DamagedCubeMaterial is set the simulating cubes swap materials instead, and a cube that is put
+ * back into the instances ends its flash.
+ */
+UCLASS()
+class GAM312_API ACubeField : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this actor's properties
+	ACubeField();
+
+	virtual void OnConstruction(const FTransform& Transform) override;
+
+protected:
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+public:
+	// Cubes that are not moving
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UInstancedStaticMeshComponent* Instances;
+
+	// Mesh used for every cube
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh* CubeMesh;
+
+	// Material for cube, it shows the damage flash from custom data
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UMaterialInterface* CubeMaterial;
+
+	// Material shown for a moment after a cube is hit, leave empty once CubeMaterial reads the hit time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UMaterialInterface* DamagedCubeMaterial;
+
+	// Writes the hit time the cube material fades the flash from, or swaps in DamagedCubeMaterial
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	UGAM312DamageFlashComponent* DamageFlash;
+
+	// Cubes along X, Y and Z, the field is rebuilt in this shape when it is constructed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Field")
+	FIntVector GridCount = FIntVector(10, 1, 10);
+
+	// Distance between cube centers
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Field")
+	float Spacing = 110.0f;
+
+	// Seconds DamagedCubeMaterial stays on a hit cube
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Field")
+	float DamageFlashDuration = 1.5f;
+
+	// Most cubes simulating at once, the longest simulating cube is put back when more are needed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Field")
+	int32 MaxActiveCubes = 64;
+
+	// Scales the projectile's velocity into the impulse given to a cube it knocks loose
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Field")
+	float HitImpulseScale = 1.0f;
+
+	// Function that is called when a resting cube is hit
+	UFUNCTION()
+	void OnInstancesHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	// Function that is called when a simulating cube is hit
+	UFUNCTION()
+	void OnActiveCubeHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	// Function that is called when a simulating cube comes to rest
+	UFUNCTION()
+	void OnActiveCubeSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	// Knocks loose and damages the cube a trace hit, the same as a projectile hit
+	void TakeTraceHit(const FHitResult& Hit, const FVector& Impulse, AActor* DamageCauser);
+
+private:
+	// Takes an instance out of the instance buffer and starts simulating it
+	UStaticMeshComponent* ActivateInstance(int32 InstanceIndex);
+
+	// Puts a simulating cube back into the instance buffer
+	void DeactivateCube(int32 ActiveIndex);
+
+	// Applies damage and the damage flash, the same as ACube
+	void TakeHit(UStaticMeshComponent* Component, AActor* DamageCauser);
+
+	// Simulating cubes, oldest first
+	UPROPERTY(Transient)
+	TArray<UStaticMeshComponent*> ActiveCubes;
+
+	// Mesh components not in use
+	UPROPERTY(Transient)
+	TArray<UStaticMeshComponent*> FreeComponents;
+};
@@ -7,10 +7,17 @@
 #include "Perception/AIPerceptionComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Perception/AISenseConfig_Sight.h"
+#include "GAM312WorldBoundsSubsystem.h"
+#include "GAM312AudioSubsystem.h"
+#include "GAM312HitchSubsystem.h"
+#include "GAM312Stats.h"
+#include "GAM312Assets.h"
 
 // Sets default values
 AEnemy::AEnemy()
 {
+	LLM_SCOPE_BYTAG(GAM312_Enemies);
+
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
@@ -42,19 +49,42 @@ AEnemy::AEnemy()
 	MovementSpeed = 375.0f;
 	DistanceSquared = BIG_NUMBER;
 
-	// Initialize BiteMontage
-	static ConstructorHelpers::FObjectFinder<UAnimMontage> BiteMontageAsset(TEXT("/Game/_EnemyAnim/BiteMontage"));
-	if (BiteMontageAsset.Succeeded())
-	{
-		BiteMontage = BiteMontageAsset.Object;
-	}
+	// Initialize BiteMontage, the asset itself is loaded in BeginPlay
+	BiteMontage = TSoftObjectPtr<UAnimMontage>(FSoftObjectPath(TEXT("/Game/_EnemyAnim/BiteMontage.BiteMontage")));
 }
 
 // Called when the game starts or when spawned
 void AEnemy::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(GAM312_Enemies);
+
 	Super::BeginPlay();
 
+	GAM312Stats::AddLiveEnemies(1);
+
+	// Stream the bite montage and sound in the background through the class's Gameplay bundle, every enemy shares the same load
+	TArray<FSoftObjectPath> BiteAssets;
+	if (!BiteMontage.IsNull())
+	{
+		BiteAssets.Add(BiteMontage.ToSoftObjectPath());
+	}
+	if (!BiteSound.IsNull())
+	{
+		BiteAssets.Add(BiteSound.ToSoftObjectPath());
+	}
+	if (BiteAssets.Num() > 0)
+	{
+		BiteMontageHandle = GAM312Assets::LoadGameplayBundle(GAM312Assets::GetClassAssetId(GAM312Assets::EnemyType, GetClass()), GetClass(), BiteAssets);
+	}
+
+	// Store the initial location so the enemy can be returned there if it falls out of the world
+	BaseLocation = GetActorLocation();
+
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->RegisterActor(this, KillHeight);
+	}
+
 	// Bind OnHit function to DamageCollision's overlap event
 	/*DamageCollision->OnComponentBeginOverlap.AddDynamic(this, &AEnemy::OnHit);
 
@@ -89,9 +119,35 @@ void AEnemy::BeginPlay()
 
 
 
+// Registers enemy classes with the asset manager so their class can be loaded by id
+FPrimaryAssetId AEnemy::GetPrimaryAssetId() const
+{
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		return GAM312Assets::GetClassAssetId(GAM312Assets::EnemyType, GetClass());
+	}
+	return Super::GetPrimaryAssetId();
+}
+
+// Called when the enemy is destroyed or the level is unloaded
+void AEnemy::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GAM312Stats::AddLiveEnemies(-1);
+
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 // Called every frame
 void AEnemy::Tick(float DeltaTime)
 {
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_EnemyTick);
+	GAM312_HITCH_SCOPE(Enemy, GetWorld());
+
 	Super::Tick(DeltaTime);
 
 	// Move the enemy only if it's not currently attacking
@@ -145,9 +201,9 @@ void AEnemy::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveC
 		// Deal damage to the character
 		//Char->DealDamage(DamageValue);
 
-		//if (BiteMontage)
+		//if (BiteMontage.IsValid())
 		{
-			//PlayAnimMontage(BiteMontage);
+			//PlayAnimMontage(BiteMontage.Get());
 
 			//UE_LOG(LogTemp, Display, TEXT("Montage Worked"));
 		}
@@ -159,6 +215,9 @@ void AEnemy::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveC
 // Function called when the enemy senses other actors
 void AEnemy::OnSensed(const TArray<AActor*>& UpdatedActors)
 {
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_EnemyOnSensed);
+	GAM312_HITCH_SCOPE(Enemy, GetWorld());
+
 	for (int i = 0; i < UpdatedActors.Num(); i++)
 	{
 		FActorPerceptionBlueprintInfo Info;
@@ -220,6 +279,9 @@ void AEnemy::SetNewRotation(FVector TargetPosition, FVector CurrentPosition)
 // Function to apply damage to the enemy and destroy it if health is zero or below
 void AEnemy::DealDamage(float DamageAmount)
 {
+	GAM312_HITCH_SCOPE(Damage, GetWorld());
+	GAM312Stats::AddDamageEvent();
+
 	Health -= DamageAmount;
 
 	if (Health <= 0.0f)
@@ -228,8 +290,32 @@ void AEnemy::DealDamage(float DamageAmount)
 	}
 }
 
+void AEnemy::FellOutOfWorld(const UDamageType& DmgType)
+{
+	// Respawn at the base location instead of destroying the enemy
+	ResetToBase();
+}
+
+void AEnemy::ResetToBase()
+{
+	// Stop chasing and attacking
+	GetWorld()->GetTimerManager().ClearTimer(AttackTimerHandle);
+	CurrentVelocity = FVector::ZeroVector;
+	DistanceSquared = BIG_NUMBER;
+	BackToBaseLocation = false;
+	bIsAttacking = false;
+
+	// Move back to where the enemy started
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
+	TeleportTo(BaseLocation, GetActorRotation(), false, true);
+}
+
 void AEnemy::AttackPlayer(AGAM312Character* Char)
 {
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_EnemyAttackPlayer);
+	GAM312_HITCH_SCOPE(Enemy, GetWorld());
+
 	if (Char && Char->Health > 0)  // Check if player character is still alive
 	{
 		// Calculate distance to the player
@@ -252,10 +338,18 @@ void AEnemy::AttackPlayer(AGAM312Character* Char)
 			// Apply damage to the player
 			Char->DealDamage(DamageValue);
 
+			// Budgeted with every other enemy, a pack biting at once does not take every voice
+			USoundBase* Sound = BiteSound.Get();
+			UGAM312AudioSubsystem* Audio = GetWorld()->GetSubsystem<UGAM312AudioSubsystem>();
+			if (Sound && Audio)
+			{
+				Audio->PlaySoundAtLocation(Sound, GetActorLocation(), EGAM312SoundCategory::Enemy);
+			}
+
 			// Play bite animation if available
-			//if (BiteMontage)
+			//if (BiteMontage.IsValid())
 			{
-				//PlayAnimMontage(BiteMontage);
+				//PlayAnimMontage(BiteMontage.Get());
 			}
 		}
 		//else
@@ -10,6 +10,7 @@
 #include "Enemy.generated.h"
 
 class AGAM312Character;
+class USoundBase;
 UCLASS()
 class GAM312_API AEnemy : public ACharacter
 {
@@ -23,12 +24,26 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the enemy is destroyed or the level is unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Enemy blueprints are GAM312Enemy primary assets, so the asset manager knows their Gameplay bundle
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
 	// Box component for handling damage collision
 	UPROPERTY(EditAnywhere)
 	class UBoxComponent* DamageCollision;
 
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Animation")
-	UAnimMontage* BiteMontage;
+	// Streamed in when the enemy begins play instead of being loaded with the class defaults
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Animation", meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<UAnimMontage> BiteMontage;
+
+	// Played through the audio subsystem when a bite lands, streamed in with BiteMontage
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Audio", meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<USoundBase> BiteSound;
+
+	// Gameplay bundle load with BiteMontage and BiteSound
+	TSharedPtr<struct FStreamableHandle> BiteMontageHandle;
 
 	FTimerHandle AttackTimerHandle;
 
@@ -101,9 +116,19 @@ public:
 
 	void AttackPlayer(AGAM312Character* Char);
 
+	// Height below which the enemy is sent back to its base location
+	UPROPERTY(EditAnywhere, Category = Movement)
+	float KillHeight = -1000.0f;
+
+	// Function that puts the enemy back at its base location and clears its chase state
+	void ResetToBase();
+
 	bool bIsAttacking;
 
 public:
 	// Function to apply damage to the enemy and destroy it if health is zero or below
 	void DealDamage(float DamageAmount);
+
+	// Called by kill volumes, the world KillZ and the world bounds sweep
+	virtual void FellOutOfWorld(const class UDamageType& DmgType) override;
 };
\ No newline at end of file
@@ -3,3 +3,8 @@
 
 #include "FPSGameMode.h"
 
+AFPSGameMode::AFPSGameMode()
+{
+	// Keep controllers and player states when changing maps
+	bUseSeamlessTravel = true;
+}
@@ -14,4 +14,6 @@ class GAM312_API AFPSGameMode : public AGameMode
 {
 	GENERATED_BODY()
 	
+public:
+	AFPSGameMode();
 };
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312Assets.h"
+#include "Engine/AssetManager.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Misc/PackageName.h"
+
+const FPrimaryAssetType GAM312Assets::EnemyType(TEXT("GAM312Enemy"));
+const FPrimaryAssetType GAM312Assets::GameModeType(TEXT("GAM312GameMode"));
+const FPrimaryAssetType GAM312Assets::WeaponType(TEXT("GAM312Weapon"));
+const FName GAM312Assets::GameplayBundle(TEXT("Gameplay"));
+
+FPrimaryAssetId GAM312Assets::GetClassAssetId(const FPrimaryAssetType& Type, const UClass* Class)
+{
+	if (Class == nullptr)
+	{
+		return FPrimaryAssetId();
+	}
+
+	// Blueprints are named like the asset manager scan names them, after their package
+	if (Class->IsA<UBlueprintGeneratedClass>())
+	{
+		return FPrimaryAssetId(Type, FPackageName::GetShortFName(Class->GetOutermost()->GetFName()));
+	}
+	return FPrimaryAssetId(Type, Class->GetFName());
+}
+
+TSharedPtr<FStreamableHandle> GAM312Assets::LoadGameplayBundle(const FPrimaryAssetId& AssetId, const UClass* Class, const TArray<FSoftObjectPath>& Paths,
+	FStreamableDelegate Delegate, TAsyncLoadPriority Priority)
+{
+	UAssetManager& AssetManager = UAssetManager::Get();
+
+	if (!AssetManager.GetPrimaryAssetPath(AssetId).IsValid())
+	{
+		FAssetBundleData BundleData;
+		BundleData.AddBundleAssets(GameplayBundle, Paths);
+		AssetManager.AddDynamicAsset(AssetId, FSoftObjectPath(Class), BundleData);
+	}
+
+	return AssetManager.LoadPrimaryAsset(AssetId, { GameplayBundle }, MoveTemp(Delegate), Priority);
+}
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "UObject/PrimaryAssetId.h"
+
+namespace GAM312Assets
+{
+	// Primary asset types. Enemies and game modes are scanned from the paths in
+	// [/Script/Engine.AssetManagerSettings] in DefaultGame.ini, weapons are only registered at runtime
+	extern GAM312_API const FPrimaryAssetType EnemyType;
+	extern GAM312_API const FPrimaryAssetType GameModeType;
+	extern GAM312_API const FPrimaryAssetType WeaponType;
+
+	// Bundle with the assets a class only needs once it is in play, tagged with meta = (AssetBundles = "Gameplay")
+	extern GAM312_API const FName GameplayBundle;
+
+	// Id of a class under Type, named after the blueprint package or the native class
+	GAM312_API FPrimaryAssetId GetClassAssetId(const FPrimaryAssetType& Type, const UClass* Class);
+
+	/**
+	 * Streams the Gameplay bundle of a primary asset through the asset manager. Scanned blueprints
+	 * already have their bundle from the AssetBundles metadata; anything the scan does not cover,
+	 * such as native classes or the component templates of a weapon pickup, is registered as a
+	 * dynamic asset with Paths as its bundle. The asset manager keeps the bundle loaded, so every
+	 * instance of a class shares one load.
+	 */
+	GAM312_API TSharedPtr<FStreamableHandle> LoadGameplayBundle(const FPrimaryAssetId& AssetId, const UClass* Class, const TArray<FSoftObjectPath>& Paths,
+		FStreamableDelegate Delegate = FStreamableDelegate(), TAsyncLoadPriority Priority = FStreamableManager::DefaultAsyncLoadPriority);
+}
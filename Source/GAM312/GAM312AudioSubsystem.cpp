@@ -0,0 +1,234 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312AudioSubsystem.h"
+#include "GAM312Stats.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Kismet/GameplayStatics.h"
+#include "Sound/SoundBase.h"
+#include "TimerManager.h"
+
+static TAutoConsoleVariable<int32> CVarAudioWeaponVoices(
+	TEXT("gam.Audio.WeaponVoices"),
+	12,
+	TEXT("Weapon sounds that may play at once."));
+
+static TAutoConsoleVariable<int32> CVarAudioEnemyVoices(
+	TEXT("gam.Audio.EnemyVoices"),
+	8,
+	TEXT("Enemy sounds that may play at once."));
+
+static TAutoConsoleVariable<float> CVarAudioMaxDistance(
+	TEXT("gam.Audio.MaxDistance"),
+	6000.0f,
+	TEXT("Gameplay sounds further than this from every listener are not played."));
+
+static TAutoConsoleVariable<float> CVarAudioMergeWindow(
+	TEXT("gam.Audio.MergeWindow"),
+	0.05f,
+	TEXT("Seconds within which a repeat of the same sound nearby plays through the voice already running."));
+
+static TAutoConsoleVariable<float> CVarAudioMergeDistance(
+	TEXT("gam.Audio.MergeDistance"),
+	300.0f,
+	TEXT("Distance within which a repeat of the same sound is merged."));
+
+// Sounds longer than this, such as loops, are not tracked past it
+static constexpr double MaxVoiceSeconds = 10.0;
+
+static const TCHAR* SoundCategoryGauges[] = { TEXT("Audio.WeaponVoices"), TEXT("Audio.EnemyVoices") };
+static_assert(UE_ARRAY_COUNT(SoundCategoryGauges) == (int32)EGAM312SoundCategory::Count, "Every sound category needs a gauge");
+
+static int32 GetVoiceBudget(EGAM312SoundCategory Category)
+{
+	switch (Category)
+	{
+	case EGAM312SoundCategory::Weapon:
+		return CVarAudioWeaponVoices.GetValueOnGameThread();
+	case EGAM312SoundCategory::Enemy:
+		return CVarAudioEnemyVoices.GetValueOnGameThread();
+	default:
+		return 0;
+	}
+}
+
+bool UGAM312AudioSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312AudioSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Voices end on their own, so the gauges are also refreshed between sounds
+	InWorld.GetTimerManager().SetTimer(GaugeTimer, this, &UGAM312AudioSubsystem::PublishVoiceCounts, 0.25f, true);
+}
+
+void UGAM312AudioSubsystem::Deinitialize()
+{
+	GetWorld()->GetTimerManager().ClearTimer(GaugeTimer);
+
+	for (UAudioComponent* Component : Components)
+	{
+		if (Component)
+		{
+			Component->DestroyComponent();
+		}
+	}
+	Components.Reset();
+	Voices.Reset();
+
+	Super::Deinitialize();
+}
+
+int32 UGAM312AudioSubsystem::GetActiveVoices(EGAM312SoundCategory Category) const
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+
+	int32 Count = 0;
+	for (const FVoice& Voice : Voices)
+	{
+		if (Voice.Category == Category && Voice.EndTime > Now)
+		{
+			++Count;
+		}
+	}
+	return Count;
+}
+
+bool UGAM312AudioSubsystem::IsAudible(const FVector& Location, float MaxDistance) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (PlayerController == nullptr || !PlayerController->IsLocalController())
+		{
+			continue;
+		}
+
+		FVector ListenerLocation;
+		FVector FrontDir;
+		FVector RightDir;
+		PlayerController->GetAudioListenerPosition(ListenerLocation, FrontDir, RightDir);
+		if (FVector::DistSquared(ListenerLocation, Location) <= FMath::Square(MaxDistance))
+		{
+			return true;
+		}
+	}
+
+	// A dedicated server has no listeners, nothing it plays is heard
+	return false;
+}
+
+bool UGAM312AudioSubsystem::PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, EGAM312SoundCategory Category, float Priority)
+{
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_AudioPlay);
+
+	if (Sound == nullptr)
+	{
+		return false;
+	}
+
+	if (!IsAudible(Location, CVarAudioMaxDistance.GetValueOnGameThread()))
+	{
+		GAM312Stats::AddDroppedSound();
+		return false;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	const double MergeWindow = CVarAudioMergeWindow.GetValueOnGameThread();
+	const float MergeDistanceSquared = FMath::Square(CVarAudioMergeDistance.GetValueOnGameThread());
+
+	// One pass finds a voice to merge with, the category's load, the voice to steal and a free voice
+	int32 ActiveInCategory = 0;
+	FVoice* Victim = nullptr;
+	FVoice* Free = nullptr;
+	for (FVoice& Voice : Voices)
+	{
+		if (Voice.EndTime <= Now)
+		{
+			Free = Free ? Free : &Voice;
+			continue;
+		}
+
+		if (Voice.Category != Category)
+		{
+			continue;
+		}
+
+		if (Voice.Sound == Sound && Now - Voice.StartTime < MergeWindow && FVector::DistSquared(Voice.Location, Location) < MergeDistanceSquared)
+		{
+			return false;
+		}
+
+		++ActiveInCategory;
+		if (Victim == nullptr || Voice.Priority < Victim->Priority || (Voice.Priority == Victim->Priority && Voice.StartTime < Victim->StartTime))
+		{
+			Victim = &Voice;
+		}
+	}
+
+	FVoice* Target = Free;
+	if (ActiveInCategory >= GetVoiceBudget(Category))
+	{
+		// Over budget, only a sound at least as important as the weakest one may replace it
+		if (Victim == nullptr || Victim->Priority > Priority)
+		{
+			GAM312Stats::AddDroppedSound();
+			return false;
+		}
+
+		if (UAudioComponent* Stolen = Victim->Component.Get())
+		{
+			Stolen->Stop();
+		}
+		Target = Victim;
+	}
+
+	if (Target == nullptr)
+	{
+		Target = &Voices.AddDefaulted_GetRef();
+	}
+
+	// Reuse the voice's component, a new one is only made when the pool grows
+	UAudioComponent* Component = Target->Component.Get();
+	if (Component)
+	{
+		Component->SetSound(Sound);
+		Component->SetWorldLocation(Location);
+		Component->Play();
+	}
+	else
+	{
+		Component = UGameplayStatics::SpawnSoundAtLocation(this, Sound, Location, FRotator::ZeroRotator, 1.0f, 1.0f, 0.0f, nullptr, nullptr, false);
+		if (Component)
+		{
+			Components.Add(Component);
+		}
+	}
+
+	const float Duration = Sound->GetDuration();
+	Target->Component = Component;
+	Target->Sound = Sound;
+	Target->Location = Location;
+	Target->Category = Category;
+	Target->Priority = Priority;
+	Target->StartTime = Now;
+	Target->EndTime = Now + FMath::Min((double)Duration, MaxVoiceSeconds);
+
+	PublishVoiceCounts();
+	return true;
+}
+
+void UGAM312AudioSubsystem::PublishVoiceCounts()
+{
+	for (int32 CategoryIndex = 0; CategoryIndex < (int32)EGAM312SoundCategory::Count; ++CategoryIndex)
+	{
+		const EGAM312SoundCategory Category = (EGAM312SoundCategory)CategoryIndex;
+		GAM312Stats::SetGauge(SoundCategoryGauges[CategoryIndex], GetActiveVoices(Category), GetVoiceBudget(Category));
+	}
+	GAM312Stats::SetGauge(TEXT("Audio.PooledComponents"), Components.Num());
+}
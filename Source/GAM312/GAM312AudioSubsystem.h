@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312AudioSubsystem.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+
+// Gameplay sounds that share a voice budget
+enum class EGAM312SoundCategory : uint8
+{
+	Weapon,
+	Enemy,
+	Count
+};
+
+/**
+ * Plays one-shot gameplay sounds through a pool of audio components instead of a new component per
+ * sound. Each category has a voice budget, gam.Audio.WeaponVoices and gam.Audio.EnemyVoices; a sound
+ * over budget takes the voice of the lowest priority, oldest sound in its category or is dropped.
+ * Sounds out of every listener's gam.Audio.MaxDistance are culled, and a repeat of the same sound
+ * nearby within gam.Audio.MergeWindow plays through the voice already running.
+ *
+ * Voices are tracked by their own start and end times rather than by the components, so the budget
+ * works the same with the null audio device (-nosound) where no components are created. Voice
+ * counts are published as Audio.* gauges.
+ */
+UCLASS()
+class GAM312_API UGAM312AudioSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Plays a one-shot sound within its category's budget, returns false if it was culled, merged or dropped
+	bool PlaySoundAtLocation(USoundBase* Sound, const FVector& Location, EGAM312SoundCategory Category, float Priority = 1.0f);
+
+	// Voices playing in a category right now
+	int32 GetActiveVoices(EGAM312SoundCategory Category) const;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	struct FVoice
+	{
+		// Pooled component, null with the null audio device
+		TWeakObjectPtr<UAudioComponent> Component;
+
+		TWeakObjectPtr<USoundBase> Sound;
+		FVector Location = FVector::ZeroVector;
+		EGAM312SoundCategory Category = EGAM312SoundCategory::Weapon;
+		float Priority = 0.0f;
+		double StartTime = 0.0;
+		double EndTime = 0.0;
+	};
+
+	// True if any local listener is within range of Location
+	bool IsAudible(const FVector& Location, float MaxDistance) const;
+
+	// Updates the Audio.* gauges
+	void PublishVoiceCounts();
+
+	// Every voice ever started, finished ones are reused
+	TArray<FVoice> Voices;
+
+	// Keeps the pooled components alive
+	UPROPERTY(Transient)
+	TArray<UAudioComponent*> Components;
+
+	FTimerHandle GaugeTimer;
+};
@@ -9,7 +9,17 @@
 #include "EnhancedInputSubsystems.h"
 #include "Engine.h"
 #include "Kismet/GameplayStatics.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ContentStreaming.h"
 #include "FPSGameMode.h"
+#include "GAM312WorldBoundsSubsystem.h"
+#include "GAM312HitchSubsystem.h"
+#include "GAM312Stats.h"
+#include "GAM312StreamingSubsystem.h"
+#include "GAM312TravelSubsystem.h"
+#include "PlayerInteractionComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Character, Log, All);
 
 
 
@@ -19,6 +29,11 @@
 
 AGAM312Character::AGAM312Character()
 {
+	LLM_SCOPE_BYTAG(GAM312_Player);
+
+	// Falling out of the world is handled by the world bounds subsystem, so no Tick is needed
+	PrimaryActorTick.bCanEverTick = false;
+
 	// Character doesnt have a rifle at start
 	bHasRifle = false;
 	
@@ -39,15 +54,38 @@ AGAM312Character::AGAM312Character()
 	Mesh1P->CastShadow = false;
 	//Mesh1P->SetRelativeRotation(FRotator(0.9f, -19.19f, 5.2f));
 	Mesh1P->SetRelativeLocation(FVector(-30.f, 0.f, -150.f));
+
+	// Create the component that traces from the camera for interaction and inspection
+	InteractionComponent = CreateDefaultSubobject<UPlayerInteractionComponent>(TEXT("InteractionComponent"));
 }
 
 
 
 void AGAM312Character::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(GAM312_Player);
+
 	// Call the base class  
 	Super::BeginPlay();
 
+	// Remember the starting health so respawn can restore it
+	StartingHealth = Health;
+
+	// Validate the respawn point once so respawning never has to search for a free spot
+	ValidatedRespawnLocation = RespawnLocation;
+	if (!GetWorld()->FindTeleportSpot(this, ValidatedRespawnLocation, GetActorRotation()))
+	{
+		// Nothing free nearby, use the configured point as is rather than a half adjusted one
+		UE_LOG(LogGAM312Character, Warning, TEXT("%s: no free spot near respawn location %s, using it unchanged"), *GetName(), *RespawnLocation.ToString());
+		ValidatedRespawnLocation = RespawnLocation;
+	}
+
+	// Let the world bounds sweep catch the player below KillHeight
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->RegisterActor(this, KillHeight);
+	}
+
 	//Add Input Mapping Context
 	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
 	{
@@ -58,6 +96,16 @@ void AGAM312Character::BeginPlay()
 	}
 }
 
+void AGAM312Character::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
 //////////////////////////////////////////////////////////////////////////// Input
 
 void AGAM312Character::SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent)
@@ -119,72 +167,90 @@ bool AGAM312Character::GetHasRifle()
 
 void AGAM312Character::DisplayRaycast()
 {
-	// Create a FHitResult object to store information about the hit
-	FHitResult HitResult;
+	// Use the trace the interaction component already ran this frame instead of tracing again
+	AActor* HitActor = InteractionComponent->GetHoveredActor();
+	if (HitActor == nullptr)
+	{
+		return;
+	}
 
-	// Get the starting position of the line trace from the camera component
-	FVector StartTrace = FirstPersonCameraComponent->GetComponentLocation();
+#if ENABLE_DRAW_DEBUG
+	// Draw a debug line in the world to visualize the line trace, it fades out instead of staying forever
+	DrawDebugLine(GetWorld(), InteractionComponent->GetHoveredHit().TraceStart, InteractionComponent->GetHoveredHit().ImpactPoint, FColor(255, 0, 0), false, 5.0f);
+#endif
 
-	// Get the forward vector of the camera component
-	FVector ForwardVector = FirstPersonCameraComponent->GetForwardVector();
+	// Display a debug message on the screen with information about the hit actor
+	GEngine->AddOnScreenDebugMessage(1, 5.0f, FColor::Red, FString::Printf(TEXT("You hit: %s"), *HitActor->GetName()));
+}
 
-	// Calculate the end position of the line trace based on the forward vector and distance
-	FVector EndTrace = (ForwardVector * 3319.0f) + StartTrace;
+void AGAM312Character::FellOutOfWorld(const UDamageType& DmgType)
+{
+	// If player fell off map activate respawn instead of destroying the pawn
+	Respawn();
+}
 
-	// Create a FCollisionQueryParams object to customize the behavior of the line trace
-	FCollisionQueryParams* TraceParams = new FCollisionQueryParams();
+void AGAM312Character::PossessedBy(AController* NewController)
+{
+	Super::PossessedBy(NewController);
 
-	// Perform a line trace using the specified parameters
-	if (GetWorld()->LineTraceSingleByChannel(HitResult, StartTrace, EndTrace, ECC_Visibility, *TraceParams))
+	if (UGAM312TravelSubsystem* Travel = GetGameInstance() ? GetGameInstance()->GetSubsystem<UGAM312TravelSubsystem>() : nullptr)
 	{
-		// Draw a debug line in the world to visualize the line trace
-		DrawDebugLine(GetWorld(), StartTrace, EndTrace, FColor(255, 0, 0), true);
-		// Display a debug message on the screen with information about the hit actor
-		GEngine->AddOnScreenDebugMessage(1, 5.0f, FColor::Red, FString::Printf(TEXT("You hit: %s"), *HitResult.GetActor()->GetName()));
+		Travel->RestoreCarriedState(NewController, this);
 	}
 }
 
-void AGAM312Character::Tick(float DeltaTime)
+void AGAM312Character::Respawn()
 {
-	Super::Tick(DeltaTime);
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_CharacterRespawn);
+	GAM312_HITCH_SCOPE(Respawn, GetWorld());
 
-	
+	// Keep the current controller and pawn, only their state is reset
+	Health = StartingHealth;
+
+	// Stop any movement and firing animation left over from before the death
+	GetCharacterMovement()->StopMovementImmediately();
+	GetCharacterMovement()->SetMovementMode(MOVE_Walking);
 
-	// Check to see if player has fell off the map
-	if (GetActorLocation().Z < KillHeight)
+	if (UAnimInstance* AnimInstance = Mesh1P->GetAnimInstance())
 	{
-		// If player fell off map activate respawn
-		Respawn();
+		AnimInstance->StopAllMontages(0.0f);
 	}
+
+	// Make sure the area is streaming before the teleport
+	PrefetchRespawnArea();
+
+	// The spot was checked at BeginPlay so the teleport can skip the encroachment test
+	TeleportTo(ValidatedRespawnLocation, GetActorRotation(), false, true);
 }
 
-void AGAM312Character::Respawn()
+void AGAM312Character::PrefetchRespawnArea()
 {
-	// Destroy the previous player controller
-	APlayerController* OldPlayerController = GetController<APlayerController>();
-	if (OldPlayerController)
+	// Boost texture streaming at the respawn point so it is resident when we arrive
+	IStreamingManager::Get().AddViewLocation(ValidatedRespawnLocation, 1.0f, false, RespawnPrefetchDuration);
+
+	// And keep the World Partition cells there loaded
+	if (UGAM312StreamingSubsystem* Streaming = GetWorld()->GetSubsystem<UGAM312StreamingSubsystem>())
 	{
-		OldPlayerController->UnPossess();
-		OldPlayerController->Destroy();
+		Streaming->AddPrefetchLocation(ValidatedRespawnLocation, RespawnPrefetchDuration);
 	}
-
-	// Spawn and possess a new player controller
-	APlayerController* NewPlayerController = GetWorld()->SpawnActor<APlayerController>(APlayerController::StaticClass());
-
-	// Reset the character's location to a spawn point
-	SetActorLocation(RespawnLocation);
-
-	//Possess the new player controller
-	NewPlayerController->Possess(this);
 }
 
 // Function that deals damage to enemy
 void AGAM312Character::DealDamage(float DamageAmount)
 {
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_CharacterDamage);
+	GAM312_HITCH_SCOPE(Damage, GetWorld());
+	GAM312Stats::AddDamageEvent();
+
 	Health -= DamageAmount;
 
 	if (Health <= 0.0f)
 	{
 		Respawn();
 	}
+	else if (Health <= StartingHealth * RespawnPrefetchHealthFraction)
+	{
+		// Likely to die soon, start loading the respawn area ahead of time
+		PrefetchRespawnArea();
+	}
 }
@@ -17,6 +17,7 @@ class USceneComponent;
 class UCameraComponent;
 class UAnimMontage;
 class USoundBase;
+class UPlayerInteractionComponent;
 
 
 UCLASS(config=Game)
@@ -35,6 +36,10 @@ class AGAM312Character : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FirstPersonCameraComponent;
 
+	/** Shared camera trace for everything that needs to know what the player is looking at */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Interaction, meta = (AllowPrivateAccess = "true"))
+	UPlayerInteractionComponent* InteractionComponent;
+
 	/** MappingContext */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category=Input, meta=(AllowPrivateAccess = "true"))
 	class UInputMappingContext* DefaultMappingContext;
@@ -55,6 +60,20 @@ class AGAM312Character : public ACharacter
 	UPROPERTY(EditDefaultsOnly, Category = "Respawn")
 	float KillHeight = -1000.0f;
 
+	// Health fraction below which the respawn area starts streaming in
+	UPROPERTY(EditDefaultsOnly, Category = "Respawn")
+	float RespawnPrefetchHealthFraction = 0.25f;
+
+	// How long the texture streamer keeps the respawn area boosted after a prefetch
+	UPROPERTY(EditDefaultsOnly, Category = "Respawn")
+	float RespawnPrefetchDuration = 5.0f;
+
+	// Respawn location after being checked for collision at BeginPlay
+	FVector ValidatedRespawnLocation;
+
+	// Health the character starts with, restored on respawn
+	float StartingHealth;
+
 	
 	
 public:
@@ -70,6 +89,9 @@ public:
 protected:
 	virtual void BeginPlay();
 
+	// Leaves the world bounds sweep
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	
 
 public:
@@ -115,9 +137,15 @@ public:
 	USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
 	/** Returns FirstPersonCameraComponent subobject **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+	/** Returns InteractionComponent subobject **/
+	UPlayerInteractionComponent* GetInteractionComponent() const { return InteractionComponent; }
 	
 	void DealDamage(float DamageAmount);
 
+	// Respawn point used by Respawn, kept in save games
+	FVector GetRespawnLocation() const { return ValidatedRespawnLocation; }
+	void SetRespawnLocation(const FVector& NewRespawnLocation) { ValidatedRespawnLocation = NewRespawnLocation; }
+
 	// Function to display Raycast
 private:
 	void DisplayRaycast();
@@ -126,9 +154,16 @@ private:
 protected:
 	void Respawn();
 
+	// Function to start streaming the area around the respawn point
+	void PrefetchRespawnArea();
+
 	
 
-protected:
-	virtual void Tick(float DeltaTime) override;
+public:
+	// Called by kill volumes, the world KillZ and the world bounds sweep
+	virtual void FellOutOfWorld(const class UDamageType& DmgType) override;
+
+	// Picks up the state carried over from the previous map after a seamless travel
+	virtual void PossessedBy(AController* NewController) override;
 };
 
@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312DamageFlashComponent.h"
+#include "GAM312Stats.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+#include "Materials/MaterialInterface.h"
+#include "TimerManager.h"
+
+// Sets default values for this component's properties
+UGAM312DamageFlashComponent::UGAM312DamageFlashComponent()
+{
+	// The material does the fade, swapped flashes are put back by a timer
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UGAM312DamageFlashComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GetWorld()->GetTimerManager().ClearTimer(RestoreTimer);
+	SwappedMaterials.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGAM312DamageFlashComponent::Flash(UPrimitiveComponent* Primitive, int32 InstanceIndex)
+{
+	if (Primitive == nullptr)
+	{
+		return;
+	}
+
+	GAM312Stats::AddDamageFlash();
+
+	// Instances cannot take a material of their own, they always use custom data
+	if (FlashMaterial == nullptr || InstanceIndex != INDEX_NONE)
+	{
+		SetHitTime(Primitive, GetWorld()->GetTimeSeconds(), InstanceIndex);
+		return;
+	}
+
+	// A mesh that is already flashing only has its flash extended
+	FSwappedMaterial* Swapped = SwappedMaterials.FindByPredicate([Primitive](const FSwappedMaterial& Entry) { return Entry.Primitive == Primitive; });
+	if (Swapped == nullptr)
+	{
+		Swapped = &SwappedMaterials.AddDefaulted_GetRef();
+		Swapped->Primitive = Primitive;
+		Swapped->Original = Primitive->GetMaterial(0);
+		Primitive->SetMaterial(0, FlashMaterial);
+	}
+	Swapped->EndTime = GetWorld()->GetTimeSeconds() + FlashDuration;
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(RestoreTimer))
+	{
+		TimerManager.SetTimer(RestoreTimer, this, &UGAM312DamageFlashComponent::RestoreExpired, FlashDuration, false);
+	}
+}
+
+void UGAM312DamageFlashComponent::EndFlash(UPrimitiveComponent* Primitive)
+{
+	const int32 Index = SwappedMaterials.IndexOfByPredicate([Primitive](const FSwappedMaterial& Entry) { return Entry.Primitive == Primitive; });
+	if (Index != INDEX_NONE)
+	{
+		Restore(SwappedMaterials[Index]);
+		SwappedMaterials.RemoveAtSwap(Index, 1, false);
+	}
+}
+
+void UGAM312DamageFlashComponent::RestoreExpired()
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	double NextEndTime = DBL_MAX;
+
+	for (int32 Index = SwappedMaterials.Num() - 1; Index >= 0; --Index)
+	{
+		const FSwappedMaterial& Swapped = SwappedMaterials[Index];
+		if (Swapped.EndTime <= Now || !Swapped.Primitive.IsValid())
+		{
+			Restore(Swapped);
+			SwappedMaterials.RemoveAtSwap(Index, 1, false);
+		}
+		else
+		{
+			NextEndTime = FMath::Min(NextEndTime, Swapped.EndTime);
+		}
+	}
+
+	// Come back for the meshes that are still flashing
+	if (NextEndTime < DBL_MAX)
+	{
+		GetWorld()->GetTimerManager().SetTimer(RestoreTimer, this, &UGAM312DamageFlashComponent::RestoreExpired, static_cast<float>(NextEndTime - Now), false);
+	}
+}
+
+void UGAM312DamageFlashComponent::Restore(const FSwappedMaterial& Swapped) const
+{
+	if (UPrimitiveComponent* Primitive = Swapped.Primitive.Get())
+	{
+		Primitive->SetMaterial(0, RestoreMaterial ? RestoreMaterial : Swapped.Original.Get());
+	}
+}
+
+float UGAM312DamageFlashComponent::GetHitTime(const UPrimitiveComponent* Primitive, int32 InstanceIndex) const
+{
+	if (const UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Primitive))
+	{
+		const int32 DataIndex = InstanceIndex * Instanced->NumCustomDataFloats + HitTimeDataIndex;
+		if (InstanceIndex != INDEX_NONE && HitTimeDataIndex < Instanced->NumCustomDataFloats && Instanced->PerInstanceSMCustomData.IsValidIndex(DataIndex))
+		{
+			return Instanced->PerInstanceSMCustomData[DataIndex];
+		}
+		return 0.0f;
+	}
+
+	const TArray<float>& Data = Primitive->GetCustomPrimitiveData().Data;
+	return Data.IsValidIndex(HitTimeDataIndex) ? Data[HitTimeDataIndex] : 0.0f;
+}
+
+void UGAM312DamageFlashComponent::SetHitTime(UPrimitiveComponent* Primitive, float HitTime, int32 InstanceIndex) const
+{
+	// Instances update their slice of the instance buffer, not the whole component's render state
+	if (UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Primitive))
+	{
+		if (InstanceIndex != INDEX_NONE && HitTimeDataIndex < Instanced->NumCustomDataFloats)
+		{
+			Instanced->SetCustomDataValue(InstanceIndex, HitTimeDataIndex, HitTime, true);
+		}
+		return;
+	}
+
+	Primitive->SetCustomPrimitiveDataFloat(HitTimeDataIndex, HitTime);
+}
@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "GAM312DamageFlashComponent.generated.h"
+
+class UMaterialInterface;
+
+/**
+ * Shows damage by writing the world time of the hit into custom primitive data, or into per
+ * instance custom data for instanced meshes. The material fades the flash itself from that time,
+ * for example Flash = HitTime > 0 ? saturate(1 - (Time - HitTime) / FlashDuration) : 0 with the
+ * Time node and a FlashDuration parameter of 1.5. Materials used on both plain and instanced
+ * meshes take HitTime as the max of CustomPrimitiveData and PerInstanceCustomData, since the one
+ * that does not apply reads 0. A hit costs one custom data write with no timers and no material
+ * swaps, so damaged meshes keep batching with the rest.
+ *
+ * Meshes whose material does not read the hit time yet set FlashMaterial. Those are flashed the
+ * old way instead: FlashMaterial is swapped in and RestoreMaterial, or the material the mesh had,
+ * is put back after FlashDuration. Each swap rebuilds the mesh's render state.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GAM312_API UGAM312DamageFlashComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UGAM312DamageFlashComponent();
+
+	// Custom data float the material reads the hit time from
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Damage")
+	int32 HitTimeDataIndex = 0;
+
+	// Material swapped in for the flash, leave empty once the mesh material reads the hit time
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	UMaterialInterface* FlashMaterial = nullptr;
+
+	// Material put back after a swapped flash, empty puts back the one the mesh had
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	UMaterialInterface* RestoreMaterial = nullptr;
+
+	// Seconds a swapped flash lasts
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	float FlashDuration = 1.5f;
+
+	/** Starts the flash on a mesh, or on one instance of an instanced mesh when InstanceIndex is set */
+	UFUNCTION(BlueprintCallable, Category = "Damage")
+	void Flash(UPrimitiveComponent* Primitive, int32 InstanceIndex = -1);
+
+	/** Ends a swapped flash on a mesh right away, does nothing for flashes kept in custom data */
+	UFUNCTION(BlueprintCallable, Category = "Damage")
+	void EndFlash(UPrimitiveComponent* Primitive);
+
+	// Hit time currently stored on a mesh or instance, used to carry a flash between the two
+	float GetHitTime(const UPrimitiveComponent* Primitive, int32 InstanceIndex = -1) const;
+	void SetHitTime(UPrimitiveComponent* Primitive, float HitTime, int32 InstanceIndex = -1) const;
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FSwappedMaterial
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Primitive;
+		TWeakObjectPtr<UMaterialInterface> Original;
+		double EndTime = 0.0;
+	};
+
+	// Puts the material back on meshes whose swapped flash has ended
+	void RestoreExpired();
+
+	void Restore(const FSwappedMaterial& Swapped) const;
+
+	// Meshes showing FlashMaterial
+	TArray<FSwappedMaterial> SwappedMaterials;
+
+	FTimerHandle RestoreTimer;
+};
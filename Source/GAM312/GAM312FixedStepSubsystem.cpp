@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312FixedStepSubsystem.h"
+#include "GAM312Projectile.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerStart.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "EngineUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312FixedStep, Log, All);
+
+static TAutoConsoleVariable<float> CVarProjectileFixedStepHz(
+	TEXT("gam.Projectile.FixedStepHz"),
+	0.0f,
+	TEXT("Rate projectiles are stepped at independent of the frame rate, 0 lets each projectile tick with the frame. Applies to projectiles spawned after it is set, setting 0 hands projectiles in flight back to their own tick."));
+
+static TAutoConsoleVariable<int32> CVarProjectileMaxStepsPerFrame(
+	TEXT("gam.Projectile.MaxStepsPerFrame"),
+	8,
+	TEXT("Most fixed steps run in one frame, time beyond that is dropped so a long frame cannot snowball."));
+
+static FAutoConsoleCommandWithWorldAndArgs GProjectileTraceCommand(
+	TEXT("gam.Projectile.Trace"),
+	TEXT("Fires a projectile from the first player start and writes its trajectory to Saved/Profiling/Trajectories. Usage: gam.Projectile.Trace Name"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312FixedStepSubsystem* FixedStep = World ? World->GetSubsystem<UGAM312FixedStepSubsystem>() : nullptr)
+		{
+			FixedStep->StartTrace(Args.IsValidIndex(0) ? Args[0] : TEXT("Trajectory"));
+		}
+	}));
+
+bool UGAM312FixedStepSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UGAM312FixedStepSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312FixedStepSubsystem, STATGROUP_Tickables);
+}
+
+void UGAM312FixedStepSubsystem::RegisterProjectile(UProjectileMovementComponent* Movement)
+{
+	if (Movement == nullptr || CVarProjectileFixedStepHz.GetValueOnGameThread() <= 0.0f)
+	{
+		return;
+	}
+
+	// From here on the movement only advances in Tick
+	Movement->SetComponentTickEnabled(false);
+	Projectiles.Add(Movement);
+}
+
+void UGAM312FixedStepSubsystem::Tick(float DeltaTime)
+{
+	Projectiles.RemoveAllSwap([](const TWeakObjectPtr<UProjectileMovementComponent>& Movement) { return !Movement.IsValid(); });
+
+	const float StepHz = CVarProjectileFixedStepHz.GetValueOnGameThread();
+	if (StepHz <= 0.0f)
+	{
+		// Fixed stepping was turned off, projectiles in flight go back to ticking themselves
+		for (const TWeakObjectPtr<UProjectileMovementComponent>& Movement : Projectiles)
+		{
+			Movement->SetComponentTickEnabled(true);
+		}
+		Projectiles.Reset();
+	}
+
+	if (Projectiles.Num() == 0)
+	{
+		Accumulator = 0.0f;
+		return;
+	}
+
+	const float Step = 1.0f / StepHz;
+	const int32 MaxSteps = FMath::Max(CVarProjectileMaxStepsPerFrame.GetValueOnGameThread(), 1);
+	Accumulator = FMath::Min(Accumulator + DeltaTime, Step * MaxSteps);
+
+	while (Accumulator >= Step)
+	{
+		Accumulator -= Step;
+
+		// Index loop, a hit can destroy a projectile or spawn a new one mid step
+		for (int32 Index = 0; Index < Projectiles.Num(); ++Index)
+		{
+			UProjectileMovementComponent* Movement = Projectiles[Index].Get();
+			if (Movement && Movement->UpdatedComponent && !Movement->HasStoppedSimulation())
+			{
+				Movement->TickComponent(Step, LEVELTICK_All, nullptr);
+			}
+		}
+
+		if (UProjectileMovementComponent* Traced = TracedProjectile.Get())
+		{
+			if (Traced->UpdatedComponent)
+			{
+				TracePositions.Add(Traced->UpdatedComponent->GetComponentLocation());
+			}
+		}
+	}
+}
+
+void UGAM312FixedStepSubsystem::StartTrace(const FString& Name)
+{
+	if (CVarProjectileFixedStepHz.GetValueOnGameThread() <= 0.0f)
+	{
+		UE_LOG(LogGAM312FixedStep, Warning, TEXT("gam.Projectile.Trace needs gam.Projectile.FixedStepHz above 0"));
+		return;
+	}
+
+	// The same start in every run, angled down so the projectile bounces
+	TActorIterator<APlayerStart> PlayerStart(GetWorld());
+	const FVector Location = PlayerStart ? PlayerStart->GetActorLocation() + FVector(0.0f, 0.0f, 100.0f) : FVector(0.0f, 0.0f, 200.0f);
+	const FRotator Rotation(-20.0f, PlayerStart ? PlayerStart->GetActorRotation().Yaw : 0.0f, 0.0f);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AGAM312Projectile* Projectile = GetWorld()->SpawnActor<AGAM312Projectile>(AGAM312Projectile::StaticClass(), Location, Rotation, SpawnParams);
+	if (Projectile == nullptr)
+	{
+		return;
+	}
+
+	TraceName = Name;
+	TracePositions.Reset();
+	TracePositions.Add(Location);
+	TracedProjectile = Projectile->GetProjectileMovement();
+	Projectile->OnDestroyed.AddDynamic(this, &UGAM312FixedStepSubsystem::OnTracedProjectileDestroyed);
+}
+
+void UGAM312FixedStepSubsystem::OnTracedProjectileDestroyed(AActor* DestroyedActor)
+{
+	FString Csv = TEXT("Step,X,Y,Z\n");
+	for (int32 Index = 0; Index < TracePositions.Num(); ++Index)
+	{
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f\n"), Index, TracePositions[Index].X, TracePositions[Index].Y, TracePositions[Index].Z);
+	}
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("Trajectories") / (TraceName + TEXT(".csv"));
+	FFileHelper::SaveStringToFile(Csv, *Path);
+	UE_LOG(LogGAM312FixedStep, Display, TEXT("Wrote %d trajectory steps to %s"), TracePositions.Num(), *Path);
+
+	TracedProjectile.Reset();
+	TracePositions.Reset();
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312FixedStepSubsystem.generated.h"
+
+class UProjectileMovementComponent;
+
+/**
+ * Opt-in fixed rate stepping for projectile flight. With gam.Projectile.FixedStepHz above 0, the
+ * projectile movement components registered here stop ticking themselves and are all stepped
+ * together at the fixed rate from an accumulator, so bounces come out the same at any frame rate.
+ * Hits are still handled one at a time, as each component's step sweeps into something, in the
+ * same order every run. Setting the rate back to 0 returns them to their own tick. Rigid bodies such as cubes get the same from Chaos async physics,
+ * bTickPhysicsAsync in [/Script/Engine.PhysicsSettings], which hands their hit events back to the
+ * game thread in batches. ACube then also applies its hit impulses from its async physics tick.
+ *
+ * gam.Projectile.Trace Name fires a projectile from the first player start and writes its position
+ * at every step to Saved/Profiling/Trajectories/Name.csv. Runs at different t.MaxFPS should give
+ * identical files.
+ */
+UCLASS()
+class GAM312_API UGAM312FixedStepSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Steps the projectile at the fixed rate while fixed stepping is on, does nothing otherwise
+	void RegisterProjectile(UProjectileMovementComponent* Movement);
+
+	// Fires a projectile from the first player start and records its trajectory
+	void StartTrace(const FString& Name);
+
+	// Positions of the traced projectile so far, one per step after its spawn location
+	const TArray<FVector>& GetTracePositions() const { return TracePositions; }
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	// Writes the recorded trajectory once the traced projectile is gone
+	UFUNCTION()
+	void OnTracedProjectileDestroyed(AActor* DestroyedActor);
+
+	TArray<TWeakObjectPtr<UProjectileMovementComponent>> Projectiles;
+
+	// Game time not yet simulated
+	float Accumulator = 0.0f;
+
+	// Projectile being traced and its position after each step
+	TWeakObjectPtr<UProjectileMovementComponent> TracedProjectile;
+	TArray<FVector> TracePositions;
+	FString TraceName;
+};
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312FrameTimingSubsystem.h"
+#include "GAM312Stats.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "UObject/UObjectGlobals.h"
+
+void FGAM312PhysicsTimingTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target)
+	{
+		if (bIsStart)
+		{
+			Target->MarkPhysicsStart();
+		}
+		else
+		{
+			Target->MarkPhysicsEnd();
+		}
+	}
+}
+
+FString FGAM312PhysicsTimingTickFunction::DiagnosticMessage()
+{
+	return bIsStart ? TEXT("GAM312 physics timing start") : TEXT("GAM312 physics timing end");
+}
+
+bool UGAM312FrameTimingSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312FrameTimingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Bracket the physics tick groups to measure how long physics holds the game thread
+	PhysicsStartTick.Target = this;
+	PhysicsStartTick.bIsStart = true;
+	PhysicsStartTick.bCanEverTick = true;
+	PhysicsStartTick.TickGroup = TG_StartPhysics;
+	PhysicsStartTick.RegisterTickFunction(InWorld.PersistentLevel);
+
+	PhysicsEndTick.Target = this;
+	PhysicsEndTick.bIsStart = false;
+	PhysicsEndTick.bCanEverTick = true;
+	PhysicsEndTick.TickGroup = TG_EndPhysics;
+	PhysicsEndTick.RegisterTickFunction(InWorld.PersistentLevel);
+
+	PreGCHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddUObject(this, &UGAM312FrameTimingSubsystem::OnPreGarbageCollect);
+	PostGCHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddUObject(this, &UGAM312FrameTimingSubsystem::OnPostGarbageCollect);
+
+	LastTickTime = FPlatformTime::Seconds();
+}
+
+void UGAM312FrameTimingSubsystem::Deinitialize()
+{
+	PhysicsStartTick.UnRegisterTickFunction();
+	PhysicsEndTick.UnRegisterTickFunction();
+
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGCHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGCHandle);
+
+	Super::Deinitialize();
+}
+
+TStatId UGAM312FrameTimingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312FrameTimingSubsystem, STATGROUP_Tickables);
+}
+
+void UGAM312FrameTimingSubsystem::Tick(float DeltaTime)
+{
+	const double Now = FPlatformTime::Seconds();
+
+	LastFrame.FrameMs = static_cast<float>((Now - LastTickTime) * 1000.0);
+	LastFrame.GameThreadMs = static_cast<float>(FPlatformTime::ToMilliseconds(GGameThreadTime));
+	LastFrame.PhysicsMs = static_cast<float>(PhysicsMs);
+	LastFrame.GCMs = static_cast<float>(GCMs);
+
+	LastTickTime = Now;
+	PhysicsMs = 0.0;
+	GCMs = 0.0;
+
+	GAM312Stats::RecordFrameCounts();
+	FrameTimedEvent.Broadcast(LastFrame);
+}
+
+void UGAM312FrameTimingSubsystem::MarkPhysicsStart()
+{
+	PhysicsStartTime = FPlatformTime::Seconds();
+}
+
+void UGAM312FrameTimingSubsystem::MarkPhysicsEnd()
+{
+	PhysicsMs += (FPlatformTime::Seconds() - PhysicsStartTime) * 1000.0;
+}
+
+void UGAM312FrameTimingSubsystem::OnPreGarbageCollect()
+{
+	GCStartTime = FPlatformTime::Seconds();
+}
+
+void UGAM312FrameTimingSubsystem::OnPostGarbageCollect()
+{
+	GCMs += (FPlatformTime::Seconds() - GCStartTime) * 1000.0;
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312FrameTimingSubsystem.generated.h"
+
+class UGAM312FrameTimingSubsystem;
+
+// Timings for one frame, in milliseconds
+struct FGAM312FrameTiming
+{
+	// Wall time since the previous frame
+	float FrameMs = 0.0f;
+
+	// Game thread time reported by the engine
+	float GameThreadMs = 0.0f;
+
+	// Time from the start of physics to the end of physics on the game thread
+	float PhysicsMs = 0.0f;
+
+	// Time spent in garbage collection
+	float GCMs = 0.0f;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnGAM312FrameTimed, const FGAM312FrameTiming&);
+
+// Tick function placed at the start or end of the physics tick groups
+USTRUCT()
+struct FGAM312PhysicsTimingTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	// Subsystem that receives the timestamps
+	UGAM312FrameTimingSubsystem* Target = nullptr;
+
+	// True for the tick at the start of physics, false for the one at the end
+	bool bIsStart = false;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FGAM312PhysicsTimingTickFunction> : public TStructOpsTypeTraitsBase2<FGAM312PhysicsTimingTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+/**
+ * Measures frame, game thread, physics and garbage collection time for every frame, so tools like
+ * the stress scenarios can read them without each hooking the engine themselves.
+ */
+UCLASS()
+class GAM312_API UGAM312FrameTimingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Returns the timings of the last finished frame
+	const FGAM312FrameTiming& GetLastFrame() const { return LastFrame; }
+
+	// Broadcast once per frame after the timings are updated
+	FOnGAM312FrameTimed& OnFrameTimed() { return FrameTimedEvent; }
+
+	// Called by the physics timing tick functions
+	void MarkPhysicsStart();
+	void MarkPhysicsEnd();
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void OnPreGarbageCollect();
+	void OnPostGarbageCollect();
+
+	FGAM312PhysicsTimingTickFunction PhysicsStartTick;
+	FGAM312PhysicsTimingTickFunction PhysicsEndTick;
+
+	FGAM312FrameTiming LastFrame;
+	FOnGAM312FrameTimed FrameTimedEvent;
+
+	double LastTickTime = 0.0;
+	double PhysicsStartTime = 0.0;
+	double PhysicsMs = 0.0;
+	double GCStartTime = 0.0;
+	double GCMs = 0.0;
+
+	FDelegateHandle PreGCHandle;
+	FDelegateHandle PostGCHandle;
+};
@@ -1,14 +1,118 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "GAM312GameMode.h"
+#include "GAM312Assets.h"
 #include "GAM312Character.h"
-#include "UObject/ConstructorHelpers.h"
+#include "Camera/PlayerCameraManager.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CommandLine.h"
+#include "TimerManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312GameMode, Log, All);
 
 AGAM312GameMode::AGAM312GameMode()
 	: Super()
 {
-	// set default pawn class to our Blueprinted character
-	static ConstructorHelpers::FClassFinder<APawn> PlayerPawnClassFinder(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter"));
-	DefaultPawnClass = PlayerPawnClassFinder.Class;
+	// set default pawn class to our Blueprinted character, loaded asynchronously in InitGame
+	PlayerPawnClass = TSoftClassPtr<APawn>(FSoftObjectPath(TEXT("/Game/FirstPerson/Blueprints/BP_FirstPersonCharacter.BP_FirstPersonCharacter_C")));
+
+	// Keep controllers and player states when changing maps
+	bUseSeamlessTravel = true;
+
+}
+
+void AGAM312GameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	if (PlayerPawnClass.IsNull())
+	{
+		bPlayerPawnClassReady = true;
+		return;
+	}
+
+	// Start streaming the pawn and everything it references while the rest of the map loads
+	PlayerPawnHandle = GAM312Assets::LoadGameplayBundle(GAM312Assets::GetClassAssetId(GAM312Assets::GameModeType, GetClass()), GetClass(), { PlayerPawnClass.ToSoftObjectPath() },
+		FStreamableDelegate::CreateUObject(this, &AGAM312GameMode::OnPlayerPawnClassLoaded), FStreamableManager::AsyncLoadHighPriority);
+
+	// No handle means the bundle is already loaded from an earlier map, or could not be requested
+	if (!PlayerPawnHandle.IsValid())
+	{
+		OnPlayerPawnClassLoaded();
+	}
+}
+
+FPrimaryAssetId AGAM312GameMode::GetPrimaryAssetId() const
+{
+	if (HasAnyFlags(RF_ClassDefaultObject))
+	{
+		return GAM312Assets::GetClassAssetId(GAM312Assets::GameModeType, GetClass());
+	}
+	return Super::GetPrimaryAssetId();
+}
+
+void AGAM312GameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	if (bPlayerPawnClassReady)
+	{
+		Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+		return;
+	}
+
+	// Hold the player on a black screen until there is a pawn to give them
+	if (NewPlayer && NewPlayer->PlayerCameraManager)
+	{
+		NewPlayer->PlayerCameraManager->SetManualCameraFade(1.0f, FLinearColor::Black, false);
+	}
+	WaitingPlayers.Add(NewPlayer);
+}
+
+void AGAM312GameMode::OnPlayerPawnClassLoaded()
+{
+	if (bPlayerPawnClassReady)
+	{
+		return;
+	}
+	bPlayerPawnClassReady = true;
+
+	if (UClass* LoadedClass = PlayerPawnClass.Get())
+	{
+		DefaultPawnClass = LoadedClass;
+	}
+	else
+	{
+		UE_LOG(LogGAM312GameMode, Error, TEXT("Could not load player pawn %s, using %s"), *PlayerPawnClass.ToString(), *GetNameSafe(DefaultPawnClass));
+	}
+
+	for (const TWeakObjectPtr<APlayerController>& WaitingPlayer : WaitingPlayers)
+	{
+		if (APlayerController* PlayerController = WaitingPlayer.Get())
+		{
+			Super::HandleStartingNewPlayer_Implementation(PlayerController);
+
+			if (PlayerController->PlayerCameraManager)
+			{
+				PlayerController->PlayerCameraManager->StartCameraFade(1.0f, 0.0f, FadeInDuration, FLinearColor::Black);
+			}
+		}
+	}
+	WaitingPlayers.Reset();
+
+	if (!bReportedFirstPlayableFrame)
+	{
+		GetWorldTimerManager().SetTimerForNextTick(this, &AGAM312GameMode::ReportFirstPlayableFrame);
+	}
+}
+
+void AGAM312GameMode::ReportFirstPlayableFrame()
+{
+	bReportedFirstPlayableFrame = true;
+
+	UE_LOG(LogGAM312GameMode, Display, TEXT("Time to first playable frame: %.3f s"), FPlatformTime::Seconds() - GStartTime);
 
+	// Headless startup benchmark: -nullrhi -gamstartupexit
+	if (FParse::Param(FCommandLine::Get(), TEXT("gamstartupexit")))
+	{
+		FPlatformMisc::RequestExit(false);
+	}
 }
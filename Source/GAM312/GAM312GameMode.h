@@ -6,6 +6,8 @@
 #include "GameFramework/GameModeBase.h"
 #include "GAM312GameMode.generated.h"
 
+struct FStreamableHandle;
+
 UCLASS(minimalapi)
 class AGAM312GameMode : public AGameModeBase
 {
@@ -13,6 +15,36 @@ class AGAM312GameMode : public AGameModeBase
 
 public:
 	AGAM312GameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
+	// Game mode blueprints are GAM312GameMode primary assets, their Gameplay bundle holds the player pawn
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+protected:
+	/** Player pawn, streamed in after the map starts loading instead of with the game mode defaults */
+	UPROPERTY(EditDefaultsOnly, Category = Classes, meta = (AssetBundles = "Gameplay"))
+	TSoftClassPtr<APawn> PlayerPawnClass;
+
+	/** Seconds the screen takes to fade in from black once the player has a pawn */
+	UPROPERTY(EditDefaultsOnly, Category = Classes)
+	float FadeInDuration = 0.5f;
+
+private:
+	// Spawns every player that joined while the pawn class was loading
+	void OnPlayerPawnClassLoaded();
+
+	// Logs the time from process start to the first frame with a controllable pawn
+	void ReportFirstPlayableFrame();
+
+	TSharedPtr<FStreamableHandle> PlayerPawnHandle;
+
+	// Players waiting behind a black screen for the pawn class
+	TArray<TWeakObjectPtr<APlayerController>> WaitingPlayers;
+
+	bool bPlayerPawnClassReady = false;
+	bool bReportedFirstPlayableFrame = false;
 };
 
 
@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312HitchSubsystem.h"
+#include "GAM312Stats.h"
+#include "Async/Async.h"
+#include "Engine/World.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectGlobals.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Hitch, Log, All);
+
+static TAutoConsoleVariable<bool> CVarHitchEnabled(
+	TEXT("gam.Hitch.Enabled"),
+	true,
+	TEXT("Records per frame hitch data and dumps it when a frame spikes."));
+
+static TAutoConsoleVariable<float> CVarHitchThresholdMs(
+	TEXT("gam.Hitch.ThresholdMs"),
+	50.0f,
+	TEXT("Frame time in milliseconds that counts as a hitch."));
+
+static TAutoConsoleVariable<float> CVarHitchSeconds(
+	TEXT("gam.Hitch.Seconds"),
+	5.0f,
+	TEXT("Seconds of records written to disk when a hitch is dumped."));
+
+static TAutoConsoleVariable<float> CVarHitchCooldown(
+	TEXT("gam.Hitch.Cooldown"),
+	10.0f,
+	TEXT("Minimum seconds between two automatic hitch dumps."));
+
+static FAutoConsoleCommandWithWorldAndArgs GHitchDumpCommand(
+	TEXT("gam.Hitch.Dump"),
+	TEXT("Writes the recent hitch records to Saved/Profiling/Hitches."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312HitchSubsystem* Hitch = World ? World->GetSubsystem<UGAM312HitchSubsystem>() : nullptr)
+		{
+			Hitch->DumpRecords(TEXT("Manual"));
+		}
+	}));
+
+// Enough records for the longest dump window at a high frame rate
+static constexpr int32 HitchMaxSeconds = 10;
+static constexpr int32 HitchMaxFramesPerSecond = 240;
+
+static const TCHAR* HitchScopeNames[] = { TEXT("EnemyMs"), TEXT("WeaponMs"), TEXT("DamageMs"), TEXT("RespawnMs") };
+static_assert(UE_ARRAY_COUNT(HitchScopeNames) == (int32)EGAM312HitchScope::Count, "Every hitch scope needs a column name");
+
+FGAM312HitchScopeTimer::FGAM312HitchScopeTimer(const UWorld* World, EGAM312HitchScope InScope)
+	: Hitch(World ? World->GetSubsystem<UGAM312HitchSubsystem>() : nullptr)
+	, Scope(InScope)
+	, StartCycles(FPlatformTime::Cycles64())
+{
+}
+
+FGAM312HitchScopeTimer::~FGAM312HitchScopeTimer()
+{
+	if (Hitch != nullptr)
+	{
+		Hitch->AddScopeCycles(Scope, FPlatformTime::Cycles64() - StartCycles);
+	}
+}
+
+bool UGAM312HitchSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312HitchSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	Super::Initialize(Collection);
+
+	Records.SetNum(HitchMaxSeconds * HitchMaxFramesPerSecond);
+
+	// Records are written when the frame timings for the frame are final
+	if (UGAM312FrameTimingSubsystem* Timing = Collection.InitializeDependency<UGAM312FrameTimingSubsystem>())
+	{
+		FrameTimedHandle = Timing->OnFrameTimed().AddUObject(this, &UGAM312HitchSubsystem::OnFrameTimed);
+	}
+
+	UWorld* World = GetWorld();
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UGAM312HitchSubsystem::OnActorSpawned));
+	ActorDestroyedHandle = World->AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UGAM312HitchSubsystem::OnActorDestroyed));
+	SyncLoadHandle = FCoreUObjectDelegates::OnSyncLoadPackage.AddUObject(this, &UGAM312HitchSubsystem::OnSyncLoadPackage);
+}
+
+void UGAM312HitchSubsystem::Deinitialize()
+{
+	if (UGAM312FrameTimingSubsystem* Timing = GetWorld()->GetSubsystem<UGAM312FrameTimingSubsystem>())
+	{
+		Timing->OnFrameTimed().Remove(FrameTimedHandle);
+	}
+
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	GetWorld()->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+	FCoreUObjectDelegates::OnSyncLoadPackage.Remove(SyncLoadHandle);
+
+	Super::Deinitialize();
+}
+
+void UGAM312HitchSubsystem::OnActorSpawned(AActor* Actor)
+{
+	++ActorsSpawned;
+}
+
+void UGAM312HitchSubsystem::OnActorDestroyed(AActor* Actor)
+{
+	++ActorsDestroyed;
+}
+
+void UGAM312HitchSubsystem::OnSyncLoadPackage(const FString& PackageName)
+{
+	++SyncLoads;
+}
+
+void UGAM312HitchSubsystem::OnFrameTimed(const FGAM312FrameTiming& Timing)
+{
+	const uint64 CaptureStart = FPlatformTime::Cycles64();
+
+	if (CVarHitchEnabled.GetValueOnGameThread())
+	{
+		// Overwrite the oldest record in place
+		FGAM312HitchRecord& Record = Records[NextRecord];
+		Record.Time = FPlatformTime::Seconds();
+		Record.Timing = Timing;
+		for (int32 ScopeIndex = 0; ScopeIndex < (int32)EGAM312HitchScope::Count; ++ScopeIndex)
+		{
+			Record.ScopeMs[ScopeIndex] = static_cast<float>(FPlatformTime::ToMilliseconds64(ScopeCycles[ScopeIndex]));
+		}
+		Record.ActorsSpawned = ActorsSpawned;
+		Record.ActorsDestroyed = ActorsDestroyed;
+		Record.SyncLoads = SyncLoads;
+		Record.AsyncPackages = static_cast<uint16>(FMath::Min(GetNumAsyncPackages(), (int32)MAX_uint16));
+
+		NextRecord = (NextRecord + 1) % Records.Num();
+		NumRecords = FMath::Min(NumRecords + 1, Records.Num());
+
+		Record.CaptureUs = static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - CaptureStart) * 1000.0);
+
+		if (Timing.FrameMs > CVarHitchThresholdMs.GetValueOnGameThread() && Record.Time - LastDumpTime > CVarHitchCooldown.GetValueOnGameThread())
+		{
+			LastDumpTime = Record.Time;
+			DumpRecords(FString::Printf(TEXT("%.0fms"), Timing.FrameMs));
+		}
+	}
+
+	FMemory::Memzero(ScopeCycles);
+	ActorsSpawned = 0;
+	ActorsDestroyed = 0;
+	SyncLoads = 0;
+}
+
+void UGAM312HitchSubsystem::DumpRecords(const FString& Reason)
+{
+	if (NumRecords == 0)
+	{
+		return;
+	}
+
+	// Copy out the records inside the window, oldest first
+	const double WindowStart = FPlatformTime::Seconds() - FMath::Min(CVarHitchSeconds.GetValueOnGameThread(), (float)HitchMaxSeconds);
+	TArray<FGAM312HitchRecord> Window;
+	Window.Reserve(NumRecords);
+	for (int32 Offset = NumRecords; Offset > 0; --Offset)
+	{
+		const FGAM312HitchRecord& Record = Records[(NextRecord - Offset + Records.Num()) % Records.Num()];
+		if (Record.Time >= WindowStart)
+		{
+			Window.Add(Record);
+		}
+	}
+
+	if (Window.Num() == 0)
+	{
+		return;
+	}
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("Hitches") / FString::Printf(TEXT("Hitch_%s_%s.csv"), *FDateTime::Now().ToString(), *Reason);
+	UE_LOG(LogGAM312Hitch, Warning, TEXT("Hitch (%s), writing %d frames to %s"), *Reason, Window.Num(), *Path);
+
+	// Formatting and writing happen off the game thread so the dump does not add to the hitch
+	Async(EAsyncExecution::ThreadPool, [Window = MoveTemp(Window), Path]()
+	{
+		FString Csv = TEXT("Time,FrameMs,GameThreadMs,PhysicsMs,GCMs");
+		for (const TCHAR* ScopeName : HitchScopeNames)
+		{
+			Csv += TEXT(",");
+			Csv += ScopeName;
+		}
+		Csv += TEXT(",ActorsSpawned,ActorsDestroyed,SyncLoads,AsyncPackages,CaptureUs\n");
+
+		const double EndTime = Window.Last().Time;
+		for (const FGAM312HitchRecord& Record : Window)
+		{
+			Csv += FString::Printf(TEXT("%.4f,%.3f,%.3f,%.3f,%.3f"), Record.Time - EndTime, Record.Timing.FrameMs, Record.Timing.GameThreadMs, Record.Timing.PhysicsMs, Record.Timing.GCMs);
+			for (float ScopeMs : Record.ScopeMs)
+			{
+				Csv += FString::Printf(TEXT(",%.3f"), ScopeMs);
+			}
+			Csv += FString::Printf(TEXT(",%u,%u,%u,%u,%.2f\n"), Record.ActorsSpawned, Record.ActorsDestroyed, Record.SyncLoads, Record.AsyncPackages, Record.CaptureUs);
+		}
+
+		FFileHelper::SaveStringToFile(Csv, *Path);
+	});
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312FrameTimingSubsystem.h"
+#include "GAM312HitchSubsystem.generated.h"
+
+// Gameplay code paths timed separately in the hitch records
+enum class EGAM312HitchScope : uint8
+{
+	Enemy,
+	Weapon,
+	Damage,
+	Respawn,
+	Count
+};
+
+// Everything recorded about one frame
+struct FGAM312HitchRecord
+{
+	// World real time at the end of the frame
+	double Time = 0.0;
+
+	FGAM312FrameTiming Timing;
+
+	// Inclusive time spent inside each hitch scope
+	float ScopeMs[(int32)EGAM312HitchScope::Count] = {};
+
+	uint16 ActorsSpawned = 0;
+	uint16 ActorsDestroyed = 0;
+	uint16 SyncLoads = 0;
+	uint16 AsyncPackages = 0;
+
+	// Time spent filling in this record
+	float CaptureUs = 0.0f;
+};
+
+class UGAM312HitchSubsystem;
+
+// Adds the time until the end of the enclosing block to a hitch scope of the given world, game thread only
+class FGAM312HitchScopeTimer
+{
+public:
+	GAM312_API FGAM312HitchScopeTimer(const UWorld* World, EGAM312HitchScope InScope);
+	GAM312_API ~FGAM312HitchScopeTimer();
+
+private:
+	// Null in worlds without hitch recording
+	UGAM312HitchSubsystem* Hitch;
+	EGAM312HitchScope Scope;
+	uint64 StartCycles;
+};
+
+#define GAM312_HITCH_SCOPE(Name, World) FGAM312HitchScopeTimer ANONYMOUS_VARIABLE(GAM312HitchScope_)(World, EGAM312HitchScope::Name)
+
+/**
+ * Keeps the last few seconds of per frame records in a fixed ring buffer and writes them to
+ * Saved/Profiling/Hitches as CSV whenever a frame goes over gam.Hitch.ThresholdMs. Each record
+ * holds the frame timings, the GAM312_HITCH_SCOPE timings, spawn and destroy counts, and sync and
+ * async loading activity. gam.Hitch.Dump writes the buffer by hand.
+ */
+UCLASS()
+class GAM312_API UGAM312HitchSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Writes the records from the last gam.Hitch.Seconds to disk on a background thread
+	void DumpRecords(const FString& Reason);
+
+	// Called by FGAM312HitchScopeTimer
+	void AddScopeCycles(EGAM312HitchScope Scope, uint64 Cycles) { ScopeCycles[(int32)Scope] += Cycles; }
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void OnFrameTimed(const FGAM312FrameTiming& Timing);
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+	void OnSyncLoadPackage(const FString& PackageName);
+
+	// Ring buffer of records, sized once so recording never allocates
+	TArray<FGAM312HitchRecord> Records;
+	int32 NextRecord = 0;
+	int32 NumRecords = 0;
+
+	// Counters for the frame in progress
+	uint16 ActorsSpawned = 0;
+	uint16 ActorsDestroyed = 0;
+	uint16 SyncLoads = 0;
+
+	// Real time of the last automatic dump, so one long hitch does not write many files
+	double LastDumpTime = -DBL_MAX;
+
+	FDelegateHandle FrameTimedHandle;
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+	FDelegateHandle SyncLoadHandle;
+
+	// Scope cycles for the frame in progress, kept per world so PIE instances do not mix their timings
+	uint64 ScopeCycles[(int32)EGAM312HitchScope::Count] = {};
+};
@@ -0,0 +1,588 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312InputReplaySubsystem.h"
+#include "GAM312Stats.h"
+#include "EnhancedInputComponent.h"
+#include "EnhancedInputSubsystems.h"
+#include "EnhancedPlayerInput.h"
+#include "InputAction.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerInput.h"
+#include "Components/InputComponent.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312InputReplay, Log, All);
+
+namespace GAM312InputReplay
+{
+	// File identifier and format version, bump the version when the layout changes
+	static const uint32 FileMagic = 0x50524947; // 'GIRP'
+	static const uint32 FileVersion = 1;
+
+	// Smallest serialized size of a channel (type and empty name), a frame (value count) and a value (channel and mask)
+	static const int64 MinChannelSize = sizeof(uint8) + sizeof(int32);
+	static const int64 MinFrameSize = sizeof(uint16);
+	static const int64 MinValueSize = sizeof(uint16) + sizeof(uint8);
+
+	// True when Count entries of at least MinSize bytes each could still fit in what is left of the file
+	static bool FitsInRemaining(FArchive& Reader, int64 Count, int64 MinSize)
+	{
+		return Count >= 0 && Count <= (Reader.TotalSize() - Reader.Tell()) / MinSize;
+	}
+}
+
+static TAutoConsoleVariable<float> CVarInputReplayFixedRate(
+	TEXT("gam.Input.FixedRate"),
+	60.0f,
+	TEXT("Fixed frame rate used while recording and playing back input."));
+
+static TAutoConsoleVariable<int32> CVarInputReplaySeed(
+	TEXT("gam.Input.Seed"),
+	312,
+	TEXT("Random seed used for new input recordings."));
+
+static FAutoConsoleCommandWithWorldAndArgs GInputRecordCommand(
+	TEXT("gam.Input.Record"),
+	TEXT("Starts recording player input. Usage: gam.Input.Record [Name]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312InputReplaySubsystem* Replay = World ? World->GetSubsystem<UGAM312InputReplaySubsystem>() : nullptr)
+		{
+			Replay->StartRecording(Args.Num() > 0 ? Args[0] : TEXT("Default"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GInputPlayCommand(
+	TEXT("gam.Input.Play"),
+	TEXT("Plays back a player input recording. Usage: gam.Input.Play [Name]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312InputReplaySubsystem* Replay = World ? World->GetSubsystem<UGAM312InputReplaySubsystem>() : nullptr)
+		{
+			Replay->StartPlayback(Args.Num() > 0 ? Args[0] : TEXT("Default"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GInputStopCommand(
+	TEXT("gam.Input.Stop"),
+	TEXT("Stops input recording or playback."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312InputReplaySubsystem* Replay = World ? World->GetSubsystem<UGAM312InputReplaySubsystem>() : nullptr)
+		{
+			Replay->Stop();
+		}
+	}));
+
+bool UGAM312InputReplaySubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312InputReplaySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Headless perf runs start playback straight from the command line
+	FString ReplayName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("gamreplay="), ReplayName))
+	{
+		bExitWhenDone = FParse::Param(FCommandLine::Get(), TEXT("gamreplayexit"));
+		StartPlayback(ReplayName);
+	}
+}
+
+void UGAM312InputReplaySubsystem::Deinitialize()
+{
+	Stop();
+
+	Super::Deinitialize();
+}
+
+TStatId UGAM312InputReplaySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312InputReplaySubsystem, STATGROUP_Tickables);
+}
+
+FString UGAM312InputReplaySubsystem::GetRecordingPath(const FString& Name)
+{
+	return FPaths::ProjectSavedDir() / TEXT("InputRecordings") / (Name + TEXT(".girp"));
+}
+
+void UGAM312InputReplaySubsystem::StartRecording(const FString& Name)
+{
+	Stop();
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr)
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("No local player to record"));
+		return;
+	}
+
+	const float Rate = CVarInputReplayFixedRate.GetValueOnGameThread();
+	if (Rate <= 0.0f)
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("gam.Input.FixedRate must be above 0 to record, it is %f"), Rate);
+		return;
+	}
+
+	RecordingName = Name;
+	Seed = CVarInputReplaySeed.GetValueOnGameThread();
+	FixedRate = Rate;
+	Frames.Reset();
+	GatherChannels(PlayerController);
+
+	BeginDeterministicRun();
+	Mode = EMode::Recording;
+
+	UE_LOG(LogGAM312InputReplay, Display, TEXT("Recording input to %s with %d channels"), *GetRecordingPath(Name), Channels.Num());
+}
+
+bool UGAM312InputReplaySubsystem::StartPlayback(const FString& Name)
+{
+	Stop();
+
+	if (!LoadRecording(Name))
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("Could not load input recording %s"), *GetRecordingPath(Name));
+		return false;
+	}
+
+	RecordingName = Name;
+	PlaybackFrame = 0;
+
+	BeginDeterministicRun();
+	Mode = EMode::Playing;
+
+	// Only the recording drives the player, live keys and mouse are ignored until playback stops.
+	// The console still gets input so the run can be stopped by hand.
+	if (UGameViewportClient* Viewport = GetWorld()->GetGameViewport())
+	{
+		bPreviousIgnoreInput = Viewport->IgnoreInput();
+		Viewport->SetIgnoreInput(true);
+	}
+	if (APlayerController* PlayerController = GetWorld()->GetFirstPlayerController())
+	{
+		PlayerController->FlushPressedKeys();
+	}
+
+#if CSV_PROFILER
+	// Capture frame times for the whole playback so runs can be compared between builds
+	FCsvProfiler::Get()->BeginCapture();
+#endif
+
+	UE_LOG(LogGAM312InputReplay, Display, TEXT("Playing %d frames of input from %s"), Frames.Num(), *GetRecordingPath(Name));
+	return true;
+}
+
+void UGAM312InputReplaySubsystem::Stop()
+{
+	if (Mode == EMode::Recording)
+	{
+		SaveRecording();
+	}
+	else if (Mode == EMode::Playing)
+	{
+#if CSV_PROFILER
+		FCsvProfiler::Get()->EndCapture();
+#endif
+		if (UGameViewportClient* Viewport = GetWorld()->GetGameViewport())
+		{
+			Viewport->SetIgnoreInput(bPreviousIgnoreInput);
+		}
+
+		UE_LOG(LogGAM312InputReplay, Display, TEXT("Finished playing %d of %d frames"), PlaybackFrame, Frames.Num());
+	}
+	else
+	{
+		return;
+	}
+
+	EndDeterministicRun();
+	Mode = EMode::Idle;
+
+	if (bExitWhenDone)
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+void UGAM312InputReplaySubsystem::Tick(float DeltaTime)
+{
+	if (Mode == EMode::Idle)
+	{
+		return;
+	}
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr)
+	{
+		return;
+	}
+
+	if (Mode == EMode::Recording)
+	{
+		RecordFrame(PlayerController);
+	}
+	else
+	{
+		PlayFrame(PlayerController);
+	}
+}
+
+void UGAM312InputReplaySubsystem::BeginDeterministicRun()
+{
+	bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+	PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+
+	// Every recorded frame is one fixed step, so playback advances the game by the same amount
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(1.0 / FixedRate);
+
+	FMath::RandInit(Seed);
+	FMath::SRandInit(Seed);
+}
+
+void UGAM312InputReplaySubsystem::EndDeterministicRun()
+{
+	FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+	FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+}
+
+void UGAM312InputReplaySubsystem::GatherChannels(APlayerController* PlayerController)
+{
+	Channels.Reset();
+
+	// The pawn has the movement bindings, the controller has the fire binding added by the weapon
+	APawn* Pawn = PlayerController->GetPawn();
+	UInputComponent* PawnInput = Pawn ? Pawn->InputComponent : nullptr;
+
+	for (UInputComponent* InputComponent : { PlayerController->InputComponent.Get(), PawnInput })
+	{
+		if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(InputComponent))
+		{
+			for (const TUniquePtr<FEnhancedInputActionEventBinding>& Binding : EnhancedInputComponent->GetActionEventBindings())
+			{
+				const UInputAction* Action = Binding->GetAction();
+				if (Action && !Channels.ContainsByPredicate([Action](const FChannel& Channel) { return Channel.Action == Action; }))
+				{
+					FChannel& Channel = Channels.AddDefaulted_GetRef();
+					Channel.Type = EChannelType::EnhancedAction;
+					Channel.Name = Action->GetPathName();
+					Channel.Action = Action;
+				}
+			}
+		}
+	}
+
+	// Legacy bindings are only made on the pawn
+	if (PawnInput)
+	{
+		for (const FInputAxisBinding& Binding : PawnInput->AxisBindings)
+		{
+			const FString AxisName = Binding.AxisName.ToString();
+			if (!Channels.ContainsByPredicate([&AxisName](const FChannel& Channel) { return Channel.Type == EChannelType::LegacyAxis && Channel.Name == AxisName; }))
+			{
+				Channels.Add({ EChannelType::LegacyAxis, AxisName });
+			}
+		}
+
+		for (int32 BindingIndex = 0; BindingIndex < PawnInput->GetNumActionBindings(); ++BindingIndex)
+		{
+			const FString ActionName = PawnInput->GetActionBinding(BindingIndex).GetActionName().ToString();
+			if (!Channels.ContainsByPredicate([&ActionName](const FChannel& Channel) { return Channel.Type == EChannelType::LegacyAction && Channel.Name == ActionName; }))
+			{
+				Channels.Add({ EChannelType::LegacyAction, ActionName });
+			}
+		}
+	}
+}
+
+void UGAM312InputReplaySubsystem::RecordFrame(APlayerController* PlayerController)
+{
+	UEnhancedInputLocalPlayerSubsystem* InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer());
+	UEnhancedPlayerInput* EnhancedInput = InputSubsystem ? InputSubsystem->GetPlayerInput() : nullptr;
+	APawn* Pawn = PlayerController->GetPawn();
+
+	FFrame& Frame = Frames.AddDefaulted_GetRef();
+
+	for (int32 ChannelIndex = 0; ChannelIndex < Channels.Num(); ++ChannelIndex)
+	{
+		const FChannel& Channel = Channels[ChannelIndex];
+		FVector Value = FVector::ZeroVector;
+
+		switch (Channel.Type)
+		{
+		case EChannelType::EnhancedAction:
+			if (EnhancedInput && Channel.Action.IsValid())
+			{
+				Value = EnhancedInput->GetActionValue(Channel.Action.Get()).Get<FVector>();
+			}
+			break;
+
+		case EChannelType::LegacyAxis:
+			if (Pawn && Pawn->InputComponent)
+			{
+				Value.X = Pawn->InputComponent->GetAxisValue(FName(*Channel.Name));
+			}
+			break;
+
+		case EChannelType::LegacyAction:
+			for (const FInputActionKeyMapping& Mapping : PlayerController->PlayerInput->GetKeysForAction(FName(*Channel.Name)))
+			{
+				if (PlayerController->IsInputKeyDown(Mapping.Key))
+				{
+					Value.X = 1.0f;
+					break;
+				}
+			}
+			break;
+		}
+
+		// Only non-zero values are stored to keep the file small
+		if (!Value.IsZero())
+		{
+			Frame.Values.Add({ static_cast<uint16>(ChannelIndex), Value });
+		}
+	}
+}
+
+void UGAM312InputReplaySubsystem::PlayFrame(APlayerController* PlayerController)
+{
+	if (PlaybackFrame >= Frames.Num())
+	{
+		Stop();
+		return;
+	}
+
+	UEnhancedInputLocalPlayerSubsystem* InputSubsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer());
+	APawn* Pawn = PlayerController->GetPawn();
+	UInputComponent* PawnInput = Pawn ? Pawn->InputComponent : nullptr;
+
+	// Expand the sparse frame so released actions can be detected
+	TArray<FVector, TInlineAllocator<32>> Values;
+	Values.SetNumZeroed(Channels.Num());
+	for (const FChannelValue& ChannelValue : Frames[PlaybackFrame].Values)
+	{
+		Values[ChannelValue.Channel] = ChannelValue.Value;
+	}
+
+	for (int32 ChannelIndex = 0; ChannelIndex < Channels.Num(); ++ChannelIndex)
+	{
+		FChannel& Channel = Channels[ChannelIndex];
+		const FVector& Value = Values[ChannelIndex];
+
+		switch (Channel.Type)
+		{
+		case EChannelType::EnhancedAction:
+			// Enhanced Input sends Completed on its own once the injected value stops
+			if (InputSubsystem && Channel.Action.IsValid() && !Value.IsZero())
+			{
+				InputSubsystem->InjectInputForAction(Channel.Action.Get(), FInputActionValue(Channel.Action->ValueType, Value), {}, {});
+			}
+			break;
+
+		case EChannelType::LegacyAxis:
+			if (PawnInput && Value.X != 0.0f)
+			{
+				for (FInputAxisBinding& Binding : PawnInput->AxisBindings)
+				{
+					if (Binding.AxisName.ToString() == Channel.Name)
+					{
+						Binding.AxisDelegate.Execute(static_cast<float>(Value.X));
+					}
+				}
+			}
+			break;
+
+		case EChannelType::LegacyAction:
+		{
+			// Only the press and release edges fire legacy action bindings
+			const bool bPressed = Value.X != 0.0f;
+			if (PawnInput && bPressed != Channel.bWasPressed)
+			{
+				const EInputEvent KeyEvent = bPressed ? IE_Pressed : IE_Released;
+				for (int32 BindingIndex = 0; BindingIndex < PawnInput->GetNumActionBindings(); ++BindingIndex)
+				{
+					FInputActionBinding& Binding = PawnInput->GetActionBinding(BindingIndex);
+					if (Binding.KeyEvent == KeyEvent && Binding.GetActionName().ToString() == Channel.Name)
+					{
+						Binding.ActionDelegate.Execute(FKey());
+					}
+				}
+			}
+			Channel.bWasPressed = bPressed;
+			break;
+		}
+		}
+	}
+
+	++PlaybackFrame;
+}
+
+bool UGAM312InputReplaySubsystem::SaveRecording() const
+{
+	TArray<uint8> Data;
+	FMemoryWriter Writer(Data);
+
+	uint32 Magic = GAM312InputReplay::FileMagic;
+	uint32 Version = GAM312InputReplay::FileVersion;
+	int32 SavedSeed = Seed;
+	float SavedRate = FixedRate;
+	Writer << Magic << Version << SavedSeed << SavedRate;
+
+	int32 NumChannels = Channels.Num();
+	Writer << NumChannels;
+	for (const FChannel& Channel : Channels)
+	{
+		uint8 Type = static_cast<uint8>(Channel.Type);
+		FString Name = Channel.Name;
+		Writer << Type << Name;
+	}
+
+	int32 NumFrames = Frames.Num();
+	Writer << NumFrames;
+	for (const FFrame& Frame : Frames)
+	{
+		uint16 NumValues = static_cast<uint16>(Frame.Values.Num());
+		Writer << NumValues;
+		for (const FChannelValue& ChannelValue : Frame.Values)
+		{
+			uint16 Channel = ChannelValue.Channel;
+
+			// Mask of which components follow, most channels only use X
+			uint8 Mask = (ChannelValue.Value.X != 0.0 ? 1 : 0) | (ChannelValue.Value.Y != 0.0 ? 2 : 0) | (ChannelValue.Value.Z != 0.0 ? 4 : 0);
+			Writer << Channel << Mask;
+
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				if (Mask & (1 << Axis))
+				{
+					float Component = static_cast<float>(ChannelValue.Value[Axis]);
+					Writer << Component;
+				}
+			}
+		}
+	}
+
+	const FString Path = GetRecordingPath(RecordingName);
+	if (!FFileHelper::SaveArrayToFile(Data, *Path))
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("Could not write input recording %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogGAM312InputReplay, Display, TEXT("Wrote %d frames (%d bytes) to %s"), Frames.Num(), Data.Num(), *Path);
+	return true;
+}
+
+bool UGAM312InputReplaySubsystem::LoadRecording(const FString& Name)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *GetRecordingPath(Name)))
+	{
+		return false;
+	}
+
+	FMemoryReader Reader(Data);
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic << Version;
+	if (Magic != GAM312InputReplay::FileMagic || Version != GAM312InputReplay::FileVersion)
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("%s is not a version %u input recording"), *Name, GAM312InputReplay::FileVersion);
+		return false;
+	}
+
+	Reader << Seed << FixedRate;
+
+	// The rate becomes the fixed delta time, a zero or negative one would stall or reverse the game
+	if (!(FixedRate > 0.0f))
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("%s has an invalid fixed rate %f"), *Name, FixedRate);
+		return false;
+	}
+
+	// Counts are checked against the bytes left before anything is reserved, a corrupt file can claim any size
+	int32 NumChannels = 0;
+	Reader << NumChannels;
+	if (Reader.IsError() || !GAM312InputReplay::FitsInRemaining(Reader, NumChannels, GAM312InputReplay::MinChannelSize))
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("%s claims %d channels, more than the file holds"), *Name, NumChannels);
+		return false;
+	}
+	Channels.Reset(NumChannels);
+	for (int32 ChannelIndex = 0; ChannelIndex < NumChannels && !Reader.IsError(); ++ChannelIndex)
+	{
+		uint8 Type = 0;
+		FChannel& Channel = Channels.AddDefaulted_GetRef();
+		Reader << Type << Channel.Name;
+		Channel.Type = static_cast<EChannelType>(Type);
+
+		if (Channel.Type == EChannelType::EnhancedAction)
+		{
+			Channel.Action = LoadObject<UInputAction>(nullptr, *Channel.Name);
+		}
+	}
+
+	int32 NumFrames = 0;
+	Reader << NumFrames;
+	if (Reader.IsError() || !GAM312InputReplay::FitsInRemaining(Reader, NumFrames, GAM312InputReplay::MinFrameSize))
+	{
+		UE_LOG(LogGAM312InputReplay, Warning, TEXT("%s claims %d frames, more than the file holds"), *Name, NumFrames);
+		return false;
+	}
+	Frames.Reset(NumFrames);
+	for (int32 FrameIndex = 0; FrameIndex < NumFrames && !Reader.IsError(); ++FrameIndex)
+	{
+		FFrame& Frame = Frames.AddDefaulted_GetRef();
+
+		uint16 NumValues = 0;
+		Reader << NumValues;
+		if (Reader.IsError() || !GAM312InputReplay::FitsInRemaining(Reader, NumValues, GAM312InputReplay::MinValueSize))
+		{
+			UE_LOG(LogGAM312InputReplay, Warning, TEXT("%s frame %d claims %u values, more than the file holds"), *Name, FrameIndex, NumValues);
+			return false;
+		}
+		Frame.Values.Reserve(NumValues);
+		for (int32 ValueIndex = 0; ValueIndex < NumValues && !Reader.IsError(); ++ValueIndex)
+		{
+			FChannelValue& ChannelValue = Frame.Values.AddDefaulted_GetRef();
+			uint8 Mask = 0;
+			Reader << ChannelValue.Channel << Mask;
+
+			ChannelValue.Value = FVector::ZeroVector;
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				if (Mask & (1 << Axis))
+				{
+					float Component = 0.0f;
+					Reader << Component;
+					ChannelValue.Value[Axis] = Component;
+				}
+			}
+
+			if (ChannelValue.Channel >= NumChannels)
+			{
+				Reader.SetError();
+			}
+		}
+	}
+
+	return !Reader.IsError();
+}
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312InputReplaySubsystem.generated.h"
+
+class APlayerController;
+class UInputAction;
+
+/**
+ * Records the first local player's input every frame into a small binary file and plays it back at
+ * a fixed timestep with a fixed random seed, so perf runs on a map do the same thing every time.
+ * Enhanced Input actions are captured by value, legacy axis bindings by axis value and legacy action
+ * bindings by pressed state. Live input from the viewport is ignored while a recording plays.
+ *
+ * Console: gam.Input.Record [Name], gam.Input.Play [Name], gam.Input.Stop
+ * Command line: -gamreplay=Name plays a recording when the map starts, -gamreplayexit quits after it
+ */
+UCLASS()
+class GAM312_API UGAM312InputReplaySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Starts recording the first local player's input
+	void StartRecording(const FString& Name);
+
+	// Loads a recording and starts playing it back
+	bool StartPlayback(const FString& Name);
+
+	// Stops recording or playback, a recording is written to disk here
+	void Stop();
+
+	bool IsRecording() const { return Mode == EMode::Recording; }
+	bool IsPlaying() const { return Mode == EMode::Playing; }
+
+	// Returns the file a recording with this name is stored in
+	static FString GetRecordingPath(const FString& Name);
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	enum class EMode : uint8
+	{
+		Idle,
+		Recording,
+		Playing,
+	};
+
+	// How a channel is captured and injected
+	enum class EChannelType : uint8
+	{
+		EnhancedAction,	// UInputAction value
+		LegacyAxis,		// UInputComponent axis binding
+		LegacyAction,	// UInputComponent action binding, value is pressed or not
+	};
+
+	struct FChannel
+	{
+		EChannelType Type;
+		FString Name;
+
+		// Resolved at runtime, not saved
+		TWeakObjectPtr<const UInputAction> Action;
+		bool bWasPressed = false;
+	};
+
+	// One non-zero channel value in a frame
+	struct FChannelValue
+	{
+		uint16 Channel;
+		FVector Value;
+	};
+
+	struct FFrame
+	{
+		TArray<FChannelValue> Values;
+	};
+
+	// Fills Channels with every action and binding the player currently has
+	void GatherChannels(APlayerController* PlayerController);
+
+	// Captures this frame's values into Frames
+	void RecordFrame(APlayerController* PlayerController);
+
+	// Injects the next recorded frame
+	void PlayFrame(APlayerController* PlayerController);
+
+	// Locks the game to the fixed timestep and seeds the random streams
+	void BeginDeterministicRun();
+	void EndDeterministicRun();
+
+	bool SaveRecording() const;
+	bool LoadRecording(const FString& Name);
+
+	EMode Mode = EMode::Idle;
+	FString RecordingName;
+	TArray<FChannel> Channels;
+	TArray<FFrame> Frames;
+	int32 PlaybackFrame = 0;
+
+	int32 Seed = 0;
+	float FixedRate = 60.0f;
+
+	// Timestep settings to restore when the run ends
+	bool bPreviousUseFixedTimeStep = false;
+	double PreviousFixedDeltaTime = 0.0;
+
+	// Viewport input setting to restore when playback ends
+	bool bPreviousIgnoreInput = false;
+
+	// Quit the game when playback finishes
+	bool bExitWhenDone = false;
+};
@@ -0,0 +1,218 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312LightZoneSubsystem.h"
+#include "GAM312Stats.h"
+#include "LightSwitchTrigger.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Pawn.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312LightZone, Log, All);
+
+static TAutoConsoleVariable<float> CVarLightZoneInterval(
+	TEXT("gam.LightZone.Interval"),
+	0.05f,
+	TEXT("Seconds between light zone occupancy passes, 0 runs one every frame."));
+
+static FAutoConsoleCommandWithWorldAndArgs GLightZoneVerifyCommand(
+	TEXT("gam.LightZone.Verify"),
+	TEXT("Checks light zone occupancy against a brute force pass over every zone and mover."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312LightZoneSubsystem* LightZones = World ? World->GetSubsystem<UGAM312LightZoneSubsystem>() : nullptr)
+		{
+			LightZones->VerifyOccupancy();
+		}
+	}));
+
+bool UGAM312LightZoneSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UGAM312LightZoneSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312LightZoneSubsystem, STATGROUP_Tickables);
+}
+
+void UGAM312LightZoneSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Every pawn can switch lights, the same as the old Trigger overlap spheres
+	for (TActorIterator<APawn> It(&InWorld); It; ++It)
+	{
+		RegisterMover(*It);
+	}
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UGAM312LightZoneSubsystem::OnActorSpawned));
+}
+
+void UGAM312LightZoneSubsystem::Deinitialize()
+{
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+
+	Super::Deinitialize();
+}
+
+void UGAM312LightZoneSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (Actor->IsA<APawn>())
+	{
+		RegisterMover(Actor);
+	}
+}
+
+void UGAM312LightZoneSubsystem::RegisterMover(AActor* Mover)
+{
+	Movers.AddUnique(Mover);
+}
+
+int32 UGAM312LightZoneSubsystem::RegisterZone(ALightSwitchTrigger* Trigger, const FVector& Center, float Radius)
+{
+	FLightZone Zone;
+	Zone.Trigger = Trigger;
+	Zone.Center = Center;
+	Zone.RadiusSquared = FMath::Square(Radius);
+
+	// Cells at least as big as the largest zone keep every zone in at most eight cells
+	CellSize = FMath::Max(CellSize, Radius * 2.0f);
+	bGridDirty = true;
+
+	GAM312Stats::SetGauge(TEXT("LightZones.Zones"), Zones.Num() + 1);
+	return Zones.Add(Zone);
+}
+
+void UGAM312LightZoneSubsystem::UnregisterZone(int32 ZoneHandle)
+{
+	if (Zones.IsValidIndex(ZoneHandle))
+	{
+		Zones.RemoveAt(ZoneHandle);
+		bGridDirty = true;
+		GAM312Stats::SetGauge(TEXT("LightZones.Zones"), Zones.Num());
+	}
+}
+
+int32 UGAM312LightZoneSubsystem::GetOccupancy(int32 ZoneHandle) const
+{
+	return Zones.IsValidIndex(ZoneHandle) ? Zones[ZoneHandle].Occupancy : 0;
+}
+
+FIntVector UGAM312LightZoneSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize), FMath::FloorToInt(Location.Z / CellSize));
+}
+
+void UGAM312LightZoneSubsystem::RebuildGrid()
+{
+	Grid.Reset();
+	for (auto It = Zones.CreateConstIterator(); It; ++It)
+	{
+		const float Radius = FMath::Sqrt(It->RadiusSquared);
+		const FIntVector MinCell = GetCell(It->Center - FVector(Radius));
+		const FIntVector MaxCell = GetCell(It->Center + FVector(Radius));
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+				{
+					Grid.FindOrAdd(FIntVector(X, Y, Z)).Add(It.GetIndex());
+				}
+			}
+		}
+	}
+	bGridDirty = false;
+}
+
+void UGAM312LightZoneSubsystem::Tick(float DeltaTime)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	if (Now < NextUpdateTime)
+	{
+		return;
+	}
+	NextUpdateTime = Now + CVarLightZoneInterval.GetValueOnGameThread();
+
+	UpdateOccupancy();
+}
+
+void UGAM312LightZoneSubsystem::UpdateOccupancy()
+{
+	if (Zones.Num() == 0)
+	{
+		return;
+	}
+
+	if (bGridDirty)
+	{
+		RebuildGrid();
+	}
+
+	for (FLightZone& Zone : Zones)
+	{
+		Zone.Occupancy = 0;
+	}
+
+	Movers.RemoveAllSwap([](const TWeakObjectPtr<AActor>& Mover) { return !Mover.IsValid(); });
+	for (const TWeakObjectPtr<AActor>& Mover : Movers)
+	{
+		const FVector Location = Mover->GetActorLocation();
+		if (const TArray<int32>* CellZones = Grid.Find(GetCell(Location)))
+		{
+			for (int32 ZoneIndex : *CellZones)
+			{
+				FLightZone& Zone = Zones[ZoneIndex];
+				if (FVector::DistSquared(Zone.Center, Location) <= Zone.RadiusSquared)
+				{
+					++Zone.Occupancy;
+				}
+			}
+		}
+	}
+
+	// Switch every light that changed in one pass, a light is dark while anything is in its zone
+	int32 Occupied = 0;
+	for (FLightZone& Zone : Zones)
+	{
+		const bool bShouldBeLit = Zone.Occupancy == 0;
+		Occupied += bShouldBeLit ? 0 : 1;
+		if (Zone.bLit != bShouldBeLit)
+		{
+			Zone.bLit = bShouldBeLit;
+			if (ALightSwitchTrigger* Trigger = Zone.Trigger.Get())
+			{
+				Trigger->SetLightOn(bShouldBeLit);
+			}
+		}
+	}
+
+	GAM312Stats::SetGauge(TEXT("LightZones.Occupied"), Occupied, Zones.Num());
+}
+
+int32 UGAM312LightZoneSubsystem::VerifyOccupancy()
+{
+	UpdateOccupancy();
+
+	int32 Mismatches = 0;
+	for (auto It = Zones.CreateConstIterator(); It; ++It)
+	{
+		int32 Expected = 0;
+		for (const TWeakObjectPtr<AActor>& Mover : Movers)
+		{
+			if (Mover.IsValid() && FVector::DistSquared(It->Center, Mover->GetActorLocation()) <= It->RadiusSquared)
+			{
+				++Expected;
+			}
+		}
+
+		if (Expected != It->Occupancy)
+		{
+			++Mismatches;
+			UE_LOG(LogGAM312LightZone, Warning, TEXT("Zone %d has occupancy %d, expected %d"), It.GetIndex(), It->Occupancy, Expected);
+		}
+	}
+
+	UE_LOG(LogGAM312LightZone, Display, TEXT("Verified %d zones against %d movers, %d mismatches"), Zones.Num(), Movers.Num(), Mismatches);
+	return Mismatches;
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312LightZoneSubsystem.generated.h"
+
+class ALightSwitchTrigger;
+
+/**
+ * Tracks how many movers are inside each light switch zone. Every gam.LightZone.Interval the
+ * registered movers are tested against the zones in their grid cell with a point-in-sphere check,
+ * and a zone's light is switched off while anything is inside and back on once it is empty. The
+ * lights that changed are switched together at the end of the pass, so a light changes at most once
+ * per frame no matter how many movers crossed it.
+ *
+ * Pawns register as movers automatically. gam.LightZone.Verify checks the grid results against a
+ * brute force pass over every zone and mover and logs any mismatch.
+ */
+UCLASS()
+class GAM312_API UGAM312LightZoneSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Adds a zone and returns its handle for UnregisterZone
+	int32 RegisterZone(ALightSwitchTrigger* Trigger, const FVector& Center, float Radius);
+	void UnregisterZone(int32 ZoneHandle);
+
+	// Adds an actor whose location counts towards zone occupancy
+	void RegisterMover(AActor* Mover);
+
+	// Movers inside a zone as of the last pass
+	int32 GetOccupancy(int32 ZoneHandle) const;
+
+	// Runs a pass and compares it with a brute force pass, returns the number of zones that differ
+	int32 VerifyOccupancy();
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	struct FLightZone
+	{
+		TWeakObjectPtr<ALightSwitchTrigger> Trigger;
+		FVector Center;
+		float RadiusSquared;
+		int32 Occupancy = 0;
+		bool bLit = true;
+	};
+
+	void OnActorSpawned(AActor* Actor);
+
+	// Recounts occupancy and switches the lights whose zones filled or emptied
+	void UpdateOccupancy();
+
+	// Rebuilds the cell lists after zones were added or removed
+	void RebuildGrid();
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	TSparseArray<FLightZone> Zones;
+	TArray<TWeakObjectPtr<AActor>> Movers;
+
+	// Zones overlapping each cell, a mover only tests the zones of the cell it is in
+	TMap<FIntVector, TArray<int32>> Grid;
+	float CellSize = 1.0f;
+	bool bGridDirty = false;
+
+	double NextUpdateTime = 0.0;
+
+	FDelegateHandle ActorSpawnedHandle;
+};
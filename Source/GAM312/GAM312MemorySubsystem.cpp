@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312MemorySubsystem.h"
+#include "GAM312Stats.h"
+#include "Engine/World.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/ArchiveCountMem.h"
+#include "TimerManager.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Memory, Log, All);
+
+TMap<FString, FGAM312MemoryEntry> UGAM312MemorySubsystem::LastReport;
+
+static FAutoConsoleCommandWithWorldAndArgs GMemReportCommand(
+	TEXT("gam.MemReport"),
+	TEXT("Writes per class and per content folder memory to Saved/Profiling/MemReports, diffed against the previous report or a given report file. Usage: gam.MemReport [BaselineCsv]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312MemorySubsystem* Memory = World ? World->GetSubsystem<UGAM312MemorySubsystem>() : nullptr)
+		{
+			Memory->WriteReport(Args.IsValidIndex(0) ? Args[0] : FString());
+		}
+	}));
+
+bool UGAM312MemorySubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312MemorySubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (Budgets.Num() > 0 && BudgetCheckInterval > 0.0f)
+	{
+		InWorld.GetTimerManager().SetTimer(BudgetTimer, this, &UGAM312MemorySubsystem::CheckBudgets, BudgetCheckInterval, true);
+	}
+}
+
+void UGAM312MemorySubsystem::Deinitialize()
+{
+	GetWorld()->GetTimerManager().ClearTimer(BudgetTimer);
+
+	Super::Deinitialize();
+}
+
+int64 UGAM312MemorySubsystem::GetObjectBytes(UObject* Object, bool bIncludeInner)
+{
+	FArchiveCountMem CountMem(Object);
+	int64 Bytes = CountMem.GetMax() + Object->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+
+	if (bIncludeInner)
+	{
+		ForEachObjectWithOuter(Object, [&Bytes](UObject* Inner)
+		{
+			FArchiveCountMem InnerCountMem(Inner);
+			Bytes += InnerCountMem.GetMax() + Inner->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		});
+	}
+
+	return Bytes;
+}
+
+void UGAM312MemorySubsystem::CheckBudgets()
+{
+	// Only instances are counted here, walking their memory would be a hitch every interval
+	for (const FGAM312MemoryBudget& Budget : Budgets)
+	{
+		// A class that is not loaded has no instances
+		UClass* BudgetClass = Budget.Class.Get();
+		if (BudgetClass == nullptr || Budget.MaxCount <= 0)
+		{
+			continue;
+		}
+
+		int32 Count = 0;
+		ForEachObjectOfClass(BudgetClass, [&Count](UObject*) { ++Count; }, true, RF_ClassDefaultObject, EInternalObjectFlags::Garbage);
+
+		if (Count > Budget.MaxCount)
+		{
+			UE_LOG(LogGAM312Memory, Warning, TEXT("%s over budget: %d instances, budget %d"), *BudgetClass->GetName(), Count, Budget.MaxCount);
+		}
+	}
+}
+
+void UGAM312MemorySubsystem::CheckMemoryBudgets()
+{
+	for (const FGAM312MemoryBudget& Budget : Budgets)
+	{
+		UClass* BudgetClass = Budget.Class.Get();
+		if (BudgetClass == nullptr || Budget.MaxMB <= 0.0f)
+		{
+			continue;
+		}
+
+		TArray<UObject*> Instances;
+		GetObjectsOfClass(BudgetClass, Instances, true, RF_ClassDefaultObject, EInternalObjectFlags::Garbage);
+
+		int64 Bytes = 0;
+		for (UObject* Instance : Instances)
+		{
+			Bytes += GetObjectBytes(Instance, true);
+		}
+
+		const float MB = Bytes / (1024.0f * 1024.0f);
+		if (MB > Budget.MaxMB)
+		{
+			UE_LOG(LogGAM312Memory, Warning, TEXT("%s over budget: %.2f MB, budget %.2f MB"), *BudgetClass->GetName(), MB, Budget.MaxMB);
+		}
+	}
+}
+
+void UGAM312MemorySubsystem::WriteReport(const FString& BaselinePath)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	TMap<FString, FGAM312MemoryEntry> Report;
+	for (TObjectIterator<UObject> It(RF_ClassDefaultObject, true, EInternalObjectFlags::Garbage); It; ++It)
+	{
+		UObject* Object = *It;
+
+		// Every object counts once towards its class
+		FGAM312MemoryEntry& ClassEntry = Report.FindOrAdd(TEXT("Class/") + Object->GetClass()->GetName());
+		ClassEntry.Count++;
+		ClassEntry.Bytes += GetObjectBytes(Object, false);
+
+		// Assets also count with their inner objects towards their top content folder, such as /Game/Megascans
+		if (Object->IsAsset())
+		{
+			TArray<FString> PathParts;
+			Object->GetOutermost()->GetName().ParseIntoArray(PathParts, TEXT("/"));
+			if (PathParts.Num() > 1)
+			{
+				FGAM312MemoryEntry& ContentEntry = Report.FindOrAdd(FString::Printf(TEXT("Content/%s/%s"), *PathParts[0], *PathParts[1]));
+				ContentEntry.Count++;
+				ContentEntry.Bytes += GetObjectBytes(Object, true);
+			}
+		}
+	}
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	// The gameplay LLM tags also see allocations that belong to no object, such as subsystem arrays
+	if (FLowLevelMemTracker::IsEnabled())
+	{
+		const FName Tags[] = { LLM_TAG_NAME(GAM312), LLM_TAG_NAME(GAM312_Enemies), LLM_TAG_NAME(GAM312_Projectiles), LLM_TAG_NAME(GAM312_Cubes), LLM_TAG_NAME(GAM312_Player), LLM_TAG_NAME(GAM312_Subsystems) };
+		for (const FName Tag : Tags)
+		{
+			FGAM312MemoryEntry& TagEntry = Report.FindOrAdd(TEXT("LLM/") + Tag.ToString());
+			TagEntry.Bytes = FLowLevelMemTracker::Get().GetTagAmountForTracker(ELLMTracker::Default, Tag, ELLMTagSet::None);
+		}
+	}
+#endif
+
+	// Compare against a report from disk, or the last one written this session
+	TMap<FString, FGAM312MemoryEntry> Baseline = LastReport;
+	if (!BaselinePath.IsEmpty())
+	{
+		Baseline.Reset();
+
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *BaselinePath);
+		for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+		{
+			TArray<FString> Columns;
+			if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) >= 3)
+			{
+				FGAM312MemoryEntry& Entry = Baseline.Add(Columns[0]);
+				Entry.Count = FCString::Atoi(*Columns[1]);
+				Entry.Bytes = FCString::Atoi64(*Columns[2]);
+			}
+		}
+	}
+
+	Report.ValueSort([](const FGAM312MemoryEntry& A, const FGAM312MemoryEntry& B) { return A.Bytes > B.Bytes; });
+
+	FString Csv = TEXT("Name,Count,Bytes,DeltaCount,DeltaBytes\n");
+	TArray<TPair<FString, int64>> Growth;
+	for (const TPair<FString, FGAM312MemoryEntry>& Row : Report)
+	{
+		const FGAM312MemoryEntry* Previous = Baseline.Find(Row.Key);
+		const int32 DeltaCount = Row.Value.Count - (Previous ? Previous->Count : 0);
+		const int64 DeltaBytes = Row.Value.Bytes - (Previous ? Previous->Bytes : 0);
+
+		Csv += FString::Printf(TEXT("%s,%d,%lld,%d,%lld\n"), *Row.Key, Row.Value.Count, Row.Value.Bytes, DeltaCount, DeltaBytes);
+
+		if (Baseline.Num() > 0 && DeltaBytes > 0)
+		{
+			Growth.Emplace(Row.Key, DeltaBytes);
+		}
+	}
+
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Profiling") / TEXT("MemReports") / FString::Printf(TEXT("MemReport_%s.csv"), *FDateTime::Now().ToString());
+	FFileHelper::SaveStringToFile(Csv, *Path);
+	UE_LOG(LogGAM312Memory, Display, TEXT("Wrote memory report with %d rows to %s"), Report.Num(), *Path);
+
+	// The rows that grew the most are the first place to look for a leak
+	Growth.Sort([](const TPair<FString, int64>& A, const TPair<FString, int64>& B) { return A.Value > B.Value; });
+	for (int32 Index = 0; Index < FMath::Min(Growth.Num(), 10); ++Index)
+	{
+		UE_LOG(LogGAM312Memory, Display, TEXT("  +%.1f KB %s"), Growth[Index].Value / 1024.0f, *Growth[Index].Key);
+	}
+
+	LastReport = MoveTemp(Report);
+
+	// The report already walked everything, so this is the place for the memory budgets
+	CheckBudgets();
+	CheckMemoryBudgets();
+}
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312MemorySubsystem.generated.h"
+
+// Limit on how many instances of a class may exist and how much memory they may use
+USTRUCT()
+struct FGAM312MemoryBudget
+{
+	GENERATED_BODY()
+
+	// Class being limited, subclasses count towards it
+	UPROPERTY(EditAnywhere, Config)
+	TSoftClassPtr<UObject> Class;
+
+	// Maximum live instances, 0 for no limit
+	UPROPERTY(EditAnywhere, Config)
+	int32 MaxCount = 0;
+
+	// Maximum memory in megabytes for the instances and the objects they own, 0 for no limit.
+	// Measuring it walks every instance, so it is only checked by gam.MemReport
+	UPROPERTY(EditAnywhere, Config)
+	float MaxMB = 0.0f;
+};
+
+// Instance count and memory of one row in a memory report
+struct FGAM312MemoryEntry
+{
+	int32 Count = 0;
+	int64 Bytes = 0;
+};
+
+/**
+ * Checks gameplay class instance counts against the budgets in [/Script/GAM312.GAM312MemorySubsystem]
+ * at a low cadence and logs a warning when one is exceeded. gam.MemReport also checks the memory
+ * budgets, and writes every class, every content folder and every GAM312 LLM tag sorted by size to
+ * Saved/Profiling/MemReports, with the change since the previous report so leaks show up as rows
+ * that only grow.
+ */
+UCLASS(config=Game)
+class GAM312_API UGAM312MemorySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Writes the sorted report, diffed against BaselinePath if given or else the previous report
+	void WriteReport(const FString& BaselinePath);
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	// Counts the live instances of every budgeted class and warns about the ones over budget
+	void CheckBudgets();
+
+	// Measures the memory of every budgeted class and warns about the ones over budget
+	void CheckMemoryBudgets();
+
+	// Memory of an object and all the objects inside it, such as an actor's components
+	static int64 GetObjectBytes(UObject* Object, bool bIncludeInner);
+
+	UPROPERTY(Config)
+	TArray<FGAM312MemoryBudget> Budgets;
+
+	// Seconds between budget checks
+	UPROPERTY(Config)
+	float BudgetCheckInterval = 10.0f;
+
+	FTimerHandle BudgetTimer;
+
+	// Rows of the last report, shared by every world so PIE sessions diff against each other
+	static TMap<FString, FGAM312MemoryEntry> LastReport;
+};
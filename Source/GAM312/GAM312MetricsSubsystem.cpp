@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312MetricsSubsystem.h"
+#include "GAM312Stats.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "HAL/RunnableThread.h"
+#include "HttpPath.h"
+#include "HttpServerModule.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "Misc/CommandLine.h"
+#include "UObject/UObjectHash.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Metrics, Log, All);
+
+static TAutoConsoleVariable<float> CVarMetricsPublishInterval(
+	TEXT("gam.Metrics.PublishInterval"),
+	0.25f,
+	TEXT("Seconds between snapshots handed to the metrics thread."));
+
+static TAutoConsoleVariable<float> CVarMetricsFormatInterval(
+	TEXT("gam.Metrics.FormatInterval"),
+	1.0f,
+	TEXT("Seconds between formatting passes on the metrics thread."));
+
+const float FGAM312MetricsSnapshot::BucketBounds[FGAM312MetricsSnapshot::NumBuckets] = { 8.0f, 16.7f, 33.3f, 50.0f, 100.0f, 250.0f, 1000.0f };
+
+uint32 FGAM312MetricsWorker::Run()
+{
+	while (!bStopping)
+	{
+		FGAM312MetricsSnapshot Snapshot;
+		bool bHasNewSnapshot = false;
+		{
+			FScopeLock Lock(&SnapshotLock);
+			if (bHasSnapshot)
+			{
+				Snapshot = PendingSnapshot;
+				bHasSnapshot = false;
+				bHasNewSnapshot = true;
+			}
+		}
+
+		if (bHasNewSnapshot)
+		{
+			FString Text = Format(Snapshot);
+
+			FScopeLock Lock(&TextLock);
+			FormattedText = MoveTemp(Text);
+		}
+
+		FPlatformProcess::Sleep(FMath::Max(CVarMetricsFormatInterval.GetValueOnAnyThread(), 0.05f));
+	}
+
+	return 0;
+}
+
+void FGAM312MetricsWorker::Stop()
+{
+	bStopping = true;
+}
+
+void FGAM312MetricsWorker::PublishSnapshot(const FGAM312MetricsSnapshot& Snapshot)
+{
+	FScopeLock Lock(&SnapshotLock);
+	PendingSnapshot = Snapshot;
+	bHasSnapshot = true;
+}
+
+FString FGAM312MetricsWorker::GetFormattedText() const
+{
+	FScopeLock Lock(&TextLock);
+	return FormattedText;
+}
+
+FString FGAM312MetricsWorker::Format(const FGAM312MetricsSnapshot& Snapshot) const
+{
+	FString Text;
+	Text.Reserve(4096);
+
+	Text += TEXT("# HELP gam312_frame_ms Server frame time of the last frame in milliseconds.\n# TYPE gam312_frame_ms gauge\n");
+	Text += FString::Printf(TEXT("gam312_frame_ms %.3f\n"), Snapshot.LastFrameMs);
+
+	// Cumulative buckets, the tick rate distribution falls out of these
+	Text += TEXT("# HELP gam312_frame_time_ms Server frame time distribution in milliseconds.\n# TYPE gam312_frame_time_ms histogram\n");
+	uint64 Cumulative = 0;
+	for (int32 Bucket = 0; Bucket < FGAM312MetricsSnapshot::NumBuckets; ++Bucket)
+	{
+		Cumulative += Snapshot.FrameBuckets[Bucket];
+		Text += FString::Printf(TEXT("gam312_frame_time_ms_bucket{le=\"%g\"} %llu\n"), FGAM312MetricsSnapshot::BucketBounds[Bucket], Cumulative);
+	}
+	Cumulative += Snapshot.FrameBuckets[FGAM312MetricsSnapshot::NumBuckets];
+	Text += FString::Printf(TEXT("gam312_frame_time_ms_bucket{le=\"+Inf\"} %llu\n"), Cumulative);
+	Text += FString::Printf(TEXT("gam312_frame_time_ms_sum %.3f\ngam312_frame_time_ms_count %llu\n"), Snapshot.FrameMsSum, Snapshot.FrameCount);
+
+	Text += TEXT("# HELP gam312_actors Live actors of each GAM312 class.\n# TYPE gam312_actors gauge\n");
+	for (const TPair<FString, int32>& Count : Snapshot.ActorCounts)
+	{
+		Text += FString::Printf(TEXT("gam312_actors{class=\"%s\"} %d\n"), *Count.Key, Count.Value);
+	}
+
+	Text += TEXT("# HELP gam312_net_bytes_total Bytes sent and received by the game net driver.\n# TYPE gam312_net_bytes_total counter\n");
+	Text += FString::Printf(TEXT("gam312_net_bytes_total{direction=\"in\"} %llu\n"), Snapshot.NetInBytes);
+	Text += FString::Printf(TEXT("gam312_net_bytes_total{direction=\"out\"} %llu\n"), Snapshot.NetOutBytes);
+	Text += TEXT("# HELP gam312_net_connections Open client connections.\n# TYPE gam312_net_connections gauge\n");
+	Text += FString::Printf(TEXT("gam312_net_connections %d\n"), Snapshot.NetConnections);
+
+	Text += TEXT("# HELP gam312_gc_pause_ms Garbage collection pauses in milliseconds.\n# TYPE gam312_gc_pause_ms summary\n");
+	Text += FString::Printf(TEXT("gam312_gc_pause_ms_sum %.3f\ngam312_gc_pause_ms_count %llu\n"), Snapshot.GCMsSum, Snapshot.GCCount);
+	Text += TEXT("# HELP gam312_gc_pause_max_ms Longest garbage collection pause in milliseconds.\n# TYPE gam312_gc_pause_max_ms gauge\n");
+	Text += FString::Printf(TEXT("gam312_gc_pause_max_ms %.3f\n"), Snapshot.GCMsMax);
+
+	return Text;
+}
+
+bool UGAM312MetricsSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UGAM312MetricsSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("gammetrics"));
+}
+
+void UGAM312MetricsSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	Super::Initialize(Collection);
+
+	// Native actor classes of this module, counted at every publish
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		if (It->IsChildOf(AActor::StaticClass()) && It->IsNative() && It->GetOutermost()->GetName() == TEXT("/Script/GAM312"))
+		{
+			ActorClasses.Add(*It);
+		}
+	}
+
+	if (UGAM312FrameTimingSubsystem* Timing = Collection.InitializeDependency<UGAM312FrameTimingSubsystem>())
+	{
+		FrameTimedHandle = Timing->OnFrameTimed().AddUObject(this, &UGAM312MetricsSubsystem::OnFrameTimed);
+	}
+
+	Worker = MakeUnique<FGAM312MetricsWorker>();
+	WorkerThread = FRunnableThread::Create(Worker.Get(), TEXT("GAM312Metrics"), 0, TPri_BelowNormal);
+
+	// The listener binds to the address in [HTTPServer.Listeners], kept at 127.0.0.1 in DefaultEngine.ini
+	Port = 9090;
+	FParse::Value(FCommandLine::Get(), TEXT("gammetricsport="), Port);
+
+	TSharedPtr<IHttpRouter> Router = FHttpServerModule::Get().GetHttpRouter(Port);
+	if (Router.IsValid())
+	{
+		FGAM312MetricsWorker* WorkerPtr = Worker.Get();
+		RouteHandle = Router->BindRoute(FHttpPath(TEXT("/metrics")), EHttpServerRequestVerbs::VERB_GET,
+			[WorkerPtr](const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+			{
+				OnComplete(FHttpServerResponse::Create(WorkerPtr->GetFormattedText(), TEXT("text/plain; version=0.0.4")));
+				return true;
+			});
+
+		FHttpServerModule::Get().StartAllListeners();
+		UE_LOG(LogGAM312Metrics, Display, TEXT("Serving metrics on port %u at /metrics"), Port);
+	}
+	else
+	{
+		UE_LOG(LogGAM312Metrics, Warning, TEXT("Could not create a metrics listener on port %u"), Port);
+	}
+}
+
+void UGAM312MetricsSubsystem::Deinitialize()
+{
+	// Unbind first so no request reaches the worker while it is destroyed
+	if (RouteHandle.IsValid())
+	{
+		if (TSharedPtr<IHttpRouter> Router = FHttpServerModule::Get().GetHttpRouter(Port))
+		{
+			Router->UnbindRoute(RouteHandle);
+		}
+		RouteHandle.Reset();
+	}
+
+	if (UGAM312FrameTimingSubsystem* Timing = GetWorld()->GetSubsystem<UGAM312FrameTimingSubsystem>())
+	{
+		Timing->OnFrameTimed().Remove(FrameTimedHandle);
+	}
+
+	if (WorkerThread)
+	{
+		WorkerThread->Kill(true);
+		delete WorkerThread;
+		WorkerThread = nullptr;
+	}
+	Worker.Reset();
+
+	Super::Deinitialize();
+}
+
+void UGAM312MetricsSubsystem::OnFrameTimed(const FGAM312FrameTiming& Timing)
+{
+	Snapshot.LastFrameMs = Timing.FrameMs;
+	Snapshot.FrameMsSum += Timing.FrameMs;
+	Snapshot.FrameCount++;
+
+	int32 Bucket = 0;
+	while (Bucket < FGAM312MetricsSnapshot::NumBuckets && Timing.FrameMs > FGAM312MetricsSnapshot::BucketBounds[Bucket])
+	{
+		++Bucket;
+	}
+	Snapshot.FrameBuckets[Bucket]++;
+
+	if (Timing.GCMs > 0.0f)
+	{
+		Snapshot.GCMsSum += Timing.GCMs;
+		Snapshot.GCMsMax = FMath::Max(Snapshot.GCMsMax, Timing.GCMs);
+		Snapshot.GCCount++;
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (Now - LastPublishTime >= CVarMetricsPublishInterval.GetValueOnGameThread())
+	{
+		LastPublishTime = Now;
+		Publish();
+	}
+}
+
+void UGAM312MetricsSubsystem::Publish()
+{
+	// Class counts come from the object hash, not from walking the level, and include Blueprint subclasses
+	Snapshot.ActorCounts.Reset(ActorClasses.Num());
+	for (UClass* ActorClass : ActorClasses)
+	{
+		int32 Count = 0;
+		ForEachObjectOfClass(ActorClass, [&Count](UObject* Object) { ++Count; }, true, RF_ClassDefaultObject, EInternalObjectFlags::Garbage);
+		Snapshot.ActorCounts.Emplace(ActorClass->GetName(), Count);
+	}
+
+	if (UNetDriver* NetDriver = GetWorld()->GetNetDriver())
+	{
+		Snapshot.NetInBytes = NetDriver->InTotalBytes;
+		Snapshot.NetOutBytes = NetDriver->OutTotalBytes;
+		Snapshot.NetConnections = NetDriver->ClientConnections.Num();
+	}
+
+	Worker->PublishSnapshot(Snapshot);
+}
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "HttpRouteHandle.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312FrameTimingSubsystem.h"
+#include "GAM312MetricsSubsystem.generated.h"
+
+// Counters copied from the game thread for the metrics thread to format
+struct FGAM312MetricsSnapshot
+{
+	// Upper bounds of the frame time histogram buckets, in milliseconds
+	static constexpr int32 NumBuckets = 7;
+	static const float BucketBounds[NumBuckets];
+
+	float LastFrameMs = 0.0f;
+	uint64 FrameBuckets[NumBuckets + 1] = {};
+	double FrameMsSum = 0.0;
+	uint64 FrameCount = 0;
+
+	double GCMsSum = 0.0;
+	float GCMsMax = 0.0f;
+	uint64 GCCount = 0;
+
+	uint64 NetInBytes = 0;
+	uint64 NetOutBytes = 0;
+	int32 NetConnections = 0;
+
+	// Live actors of each native GAM312 actor class
+	TArray<TPair<FString, int32>> ActorCounts;
+};
+
+// Background thread that turns the latest snapshot into Prometheus text
+class FGAM312MetricsWorker : public FRunnable
+{
+public:
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+	// Replaces the snapshot the next formatting pass reads, called on the game thread
+	void PublishSnapshot(const FGAM312MetricsSnapshot& Snapshot);
+
+	// Returns the last formatted text, called on the game thread
+	FString GetFormattedText() const;
+
+private:
+	FString Format(const FGAM312MetricsSnapshot& Snapshot) const;
+
+	mutable FCriticalSection SnapshotLock;
+	FGAM312MetricsSnapshot PendingSnapshot;
+	bool bHasSnapshot = false;
+
+	mutable FCriticalSection TextLock;
+	FString FormattedText;
+
+	TAtomic<bool> bStopping { false };
+};
+
+/**
+ * Serves server metrics at http://127.0.0.1:<port>/metrics in the Prometheus text format for soak
+ * tests. Off by default, started with -gammetrics and optionally -gammetricsport=<port>.
+ *
+ * The game thread only adds to counters each frame and hands a copy to the metrics thread a few
+ * times a second; the metrics thread formats the text, and the request handler returns the last
+ * formatted text without waiting on anything.
+ */
+UCLASS()
+class GAM312_API UGAM312MetricsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+private:
+	void OnFrameTimed(const FGAM312FrameTiming& Timing);
+
+	// Refreshes the actor counts and net totals and hands the snapshot to the worker
+	void Publish();
+
+	FGAM312MetricsSnapshot Snapshot;
+
+	// Native actor classes in this module, found once at startup
+	TArray<UClass*> ActorClasses;
+
+	TUniquePtr<FGAM312MetricsWorker> Worker;
+	FRunnableThread* WorkerThread = nullptr;
+
+	FHttpRouteHandle RouteHandle;
+	uint32 Port = 0;
+
+	double LastPublishTime = 0.0;
+
+	FDelegateHandle FrameTimedHandle;
+};
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312PerfOverlaySubsystem.h"
+#include "GAM312PerfOverlayWidget.h"
+#include "GAM312Stats.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Perf, Log, All);
+
+static FAutoConsoleCommandWithWorldAndArgs GPerfOverlayCommand(
+	TEXT("gam.Perf.Overlay"),
+	TEXT("Toggles the performance overlay."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312PerfOverlaySubsystem* Perf = World ? World->GetSubsystem<UGAM312PerfOverlaySubsystem>() : nullptr)
+		{
+			Perf->ToggleOverlay();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GPerfDumpCommand(
+	TEXT("gam.Perf.Dump"),
+	TEXT("Logs the data shown on the performance overlay, works without a viewport."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312PerfOverlaySubsystem* Perf = World ? World->GetSubsystem<UGAM312PerfOverlaySubsystem>() : nullptr)
+		{
+			Perf->DumpToLog();
+		}
+	}));
+
+bool UGAM312PerfOverlaySubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312PerfOverlaySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	Super::Initialize(Collection);
+
+	History.SetNum(HistorySize);
+
+	if (UGAM312FrameTimingSubsystem* Timing = Collection.InitializeDependency<UGAM312FrameTimingSubsystem>())
+	{
+		FrameTimedHandle = Timing->OnFrameTimed().AddUObject(this, &UGAM312PerfOverlaySubsystem::OnFrameTimed);
+	}
+}
+
+void UGAM312PerfOverlaySubsystem::Deinitialize()
+{
+	if (UGAM312FrameTimingSubsystem* Timing = GetWorld()->GetSubsystem<UGAM312FrameTimingSubsystem>())
+	{
+		Timing->OnFrameTimed().Remove(FrameTimedHandle);
+	}
+
+	if (Overlay)
+	{
+		Overlay->RemoveFromParent();
+		Overlay = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+void UGAM312PerfOverlaySubsystem::OnFrameTimed(const FGAM312FrameTiming& Timing)
+{
+	History[NextSample] = Timing;
+	NextSample = (NextSample + 1) % HistorySize;
+}
+
+void UGAM312PerfOverlaySubsystem::GetSummary(float FGAM312FrameTiming::* Member, float& OutAverage, float& OutPeak) const
+{
+	float Total = 0.0f;
+	OutPeak = 0.0f;
+	for (const FGAM312FrameTiming& Sample : History)
+	{
+		Total += Sample.*Member;
+		OutPeak = FMath::Max(OutPeak, Sample.*Member);
+	}
+	OutAverage = Total / HistorySize;
+}
+
+void UGAM312PerfOverlaySubsystem::ToggleOverlay()
+{
+	if (Overlay)
+	{
+		Overlay->RemoveFromParent();
+		Overlay = nullptr;
+		return;
+	}
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	if (PlayerController == nullptr || !PlayerController->IsLocalController())
+	{
+		UE_LOG(LogGAM312Perf, Warning, TEXT("No local player to show the overlay on, use gam.Perf.Dump instead"));
+		return;
+	}
+
+	Overlay = CreateWidget<UGAM312PerfOverlayWidget>(PlayerController, UGAM312PerfOverlayWidget::StaticClass());
+	Overlay->SetSource(this);
+	Overlay->AddToViewport(1000);
+}
+
+void UGAM312PerfOverlaySubsystem::DumpToLog() const
+{
+	float Average = 0.0f;
+	float Peak = 0.0f;
+
+	GetSummary(&FGAM312FrameTiming::FrameMs, Average, Peak);
+	UE_LOG(LogGAM312Perf, Display, TEXT("Frame       avg %6.2f ms  peak %6.2f ms"), Average, Peak);
+	GetSummary(&FGAM312FrameTiming::GameThreadMs, Average, Peak);
+	UE_LOG(LogGAM312Perf, Display, TEXT("GameThread  avg %6.2f ms  peak %6.2f ms"), Average, Peak);
+	GetSummary(&FGAM312FrameTiming::PhysicsMs, Average, Peak);
+	UE_LOG(LogGAM312Perf, Display, TEXT("Physics     avg %6.2f ms  peak %6.2f ms"), Average, Peak);
+	GetSummary(&FGAM312FrameTiming::GCMs, Average, Peak);
+	UE_LOG(LogGAM312Perf, Display, TEXT("GC          avg %6.2f ms  peak %6.2f ms"), Average, Peak);
+
+	UE_LOG(LogGAM312Perf, Display, TEXT("Enemies %d  Projectiles %d  Pickups %d"), GAM312Stats::GetLiveEnemies(), GAM312Stats::GetInFlightProjectiles(), GAM312Stats::GetLivePickups());
+
+	for (const TPair<FName, GAM312Stats::FGauge>& Gauge : GAM312Stats::GetGauges())
+	{
+		if (Gauge.Value.Capacity > 0)
+		{
+			UE_LOG(LogGAM312Perf, Display, TEXT("%s %d / %d"), *Gauge.Key.ToString(), Gauge.Value.Value, Gauge.Value.Capacity);
+		}
+		else
+		{
+			UE_LOG(LogGAM312Perf, Display, TEXT("%s %d"), *Gauge.Key.ToString(), Gauge.Value.Value);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312FrameTimingSubsystem.h"
+#include "GAM312PerfOverlaySubsystem.generated.h"
+
+class UGAM312PerfOverlayWidget;
+
+/**
+ * Keeps a rolling history of frame timings for the performance overlay. The overlay and the
+ * headless gam.Perf.Dump command both read this history and the counters in GAM312Stats, so
+ * neither walks the world.
+ *
+ * Console:
+ *   gam.Perf.Overlay   toggle the overlay on the first local player
+ *   gam.Perf.Dump      log the same data the overlay shows
+ */
+UCLASS()
+class GAM312_API UGAM312PerfOverlaySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Number of frames kept in the history
+	static constexpr int32 HistorySize = 240;
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Shows the overlay if it is hidden, hides it if it is shown
+	void ToggleOverlay();
+
+	// Logs the averages, peaks, counters and gauges
+	void DumpToLog() const;
+
+	// Frame timings, oldest first when read from GetHistoryStart
+	const TArray<FGAM312FrameTiming>& GetHistory() const { return History; }
+	int32 GetHistoryStart() const { return NextSample; }
+
+	// Average and peak of one timing over the history
+	void GetSummary(float FGAM312FrameTiming::* Member, float& OutAverage, float& OutPeak) const;
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void OnFrameTimed(const FGAM312FrameTiming& Timing);
+
+	// Fixed size ring of frame timings
+	TArray<FGAM312FrameTiming> History;
+	int32 NextSample = 0;
+
+	UPROPERTY()
+	TObjectPtr<UGAM312PerfOverlayWidget> Overlay;
+
+	FDelegateHandle FrameTimedHandle;
+};
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312PerfOverlayWidget.h"
+#include "GAM312PerfOverlaySubsystem.h"
+#include "GAM312Stats.h"
+#include "Fonts/SlateFontInfo.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+
+void UGAM312PerfOverlayWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	// The overlay never takes mouse or focus away from the game
+	SetVisibility(ESlateVisibility::HitTestInvisible);
+}
+
+void UGAM312PerfOverlayWidget::PaintGraph(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId, float FGAM312FrameTiming::* Member, const FLinearColor& Color) const
+{
+	const TArray<FGAM312FrameTiming>& History = Source->GetHistory();
+	const int32 Start = Source->GetHistoryStart();
+	const float StepX = GraphSize.X / (History.Num() - 1);
+
+	GraphPoints.Reset(History.Num());
+	for (int32 Index = 0; Index < History.Num(); ++Index)
+	{
+		const float Value = FMath::Min(History[(Start + Index) % History.Num()].*Member / GraphMaxMs, 1.0f);
+		GraphPoints.Add(GraphPosition + FVector2D(Index * StepX, GraphSize.Y * (1.0f - Value)));
+	}
+
+	FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(), GraphPoints, ESlateDrawEffect::None, Color, true, 1.0f);
+}
+
+int32 UGAM312PerfOverlayWidget::NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	LayerId = Super::NativePaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
+
+	if (!Source.IsValid())
+	{
+		return LayerId;
+	}
+
+	// Dark panel behind the graphs and text, tall enough for the fixed lines and one per gauge
+	const TMap<FName, GAM312Stats::FGauge>& Gauges = GAM312Stats::GetGauges();
+	const int32 NumLines = 4 + Gauges.Num();
+	const FVector2D PanelSize(GraphSize.X, GraphSize.Y + 8.0f + NumLines * LineHeight);
+	FSlateDrawElement::MakeBox(OutDrawElements, ++LayerId, AllottedGeometry.ToPaintGeometry(GraphPosition, PanelSize), FCoreStyle::Get().GetBrush("GenericWhiteBox"), ESlateDrawEffect::None, FLinearColor(0.0f, 0.0f, 0.0f, 0.6f));
+
+	++LayerId;
+	PaintGraph(AllottedGeometry, OutDrawElements, LayerId, &FGAM312FrameTiming::GameThreadMs, FLinearColor::Green);
+	PaintGraph(AllottedGeometry, OutDrawElements, LayerId, &FGAM312FrameTiming::PhysicsMs, FLinearColor(0.2f, 0.6f, 1.0f));
+	PaintGraph(AllottedGeometry, OutDrawElements, LayerId, &FGAM312FrameTiming::GCMs, FLinearColor::Red);
+
+	// Text lines below the graph, formatted into a stack buffer and copied into the reused line string
+	const FSlateFontInfo Font = FCoreStyle::GetDefaultFontStyle("Mono", 9);
+	FVector2D TextPosition = GraphPosition + FVector2D(4.0f, GraphSize.Y + 4.0f);
+	TCHAR Buffer[128];
+	auto PaintLine = [&](int32 Length, const FLinearColor& Color)
+	{
+		Line.Reset();
+		Line.AppendChars(Buffer, FMath::Clamp(Length, 0, (int32)UE_ARRAY_COUNT(Buffer) - 1));
+		FSlateDrawElement::MakeText(OutDrawElements, LayerId, AllottedGeometry.ToOffsetPaintGeometry(TextPosition), Line, Font, ESlateDrawEffect::None, Color);
+		TextPosition.Y += LineHeight;
+	};
+
+	float Average = 0.0f;
+	float Peak = 0.0f;
+	Source->GetSummary(&FGAM312FrameTiming::GameThreadMs, Average, Peak);
+	PaintLine(FCString::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), TEXT("Game    %5.2f ms  peak %5.2f"), Average, Peak), FLinearColor::Green);
+	Source->GetSummary(&FGAM312FrameTiming::PhysicsMs, Average, Peak);
+	PaintLine(FCString::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), TEXT("Physics %5.2f ms  peak %5.2f"), Average, Peak), FLinearColor(0.2f, 0.6f, 1.0f));
+	Source->GetSummary(&FGAM312FrameTiming::GCMs, Average, Peak);
+	PaintLine(FCString::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), TEXT("GC      %5.2f ms  peak %5.2f"), Average, Peak), FLinearColor::Red);
+
+	PaintLine(FCString::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), TEXT("Enemies %d  Projectiles %d  Pickups %d"), GAM312Stats::GetLiveEnemies(), GAM312Stats::GetInFlightProjectiles(), GAM312Stats::GetLivePickups()), FLinearColor::White);
+
+	TCHAR NameBuffer[NAME_SIZE];
+	for (const TPair<FName, GAM312Stats::FGauge>& Gauge : Gauges)
+	{
+		Gauge.Key.ToString(NameBuffer, UE_ARRAY_COUNT(NameBuffer));
+		const int32 Length = Gauge.Value.Capacity > 0
+			? FCString::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), TEXT("%s %d / %d"), NameBuffer, Gauge.Value.Value, Gauge.Value.Capacity)
+			: FCString::Snprintf(Buffer, UE_ARRAY_COUNT(Buffer), TEXT("%s %d"), NameBuffer, Gauge.Value.Value);
+		PaintLine(Length, FLinearColor::White);
+	}
+
+	return LayerId;
+}
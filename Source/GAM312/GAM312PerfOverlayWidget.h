@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "GAM312FrameTimingSubsystem.h"
+#include "GAM312PerfOverlayWidget.generated.h"
+
+class UGAM312PerfOverlaySubsystem;
+
+/**
+ * Draws rolling graphs of game thread, physics and GC time, and the live gameplay counters and
+ * gauges. Everything is painted directly from the overlay subsystem's history, there are no child
+ * widgets to lay out.
+ */
+UCLASS()
+class GAM312_API UGAM312PerfOverlayWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	// Subsystem the history and counters are read from
+	void SetSource(UGAM312PerfOverlaySubsystem* InSource) { Source = InSource; }
+
+	// Graph value shown at the top of the graph, in milliseconds
+	UPROPERTY(EditAnywhere, Category = "Overlay")
+	float GraphMaxMs = 33.3f;
+
+	UPROPERTY(EditAnywhere, Category = "Overlay")
+	FVector2D GraphPosition = FVector2D(20.0f, 80.0f);
+
+	UPROPERTY(EditAnywhere, Category = "Overlay")
+	FVector2D GraphSize = FVector2D(360.0f, 120.0f);
+
+protected:
+	virtual void NativeConstruct() override;
+	virtual int32 NativePaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
+private:
+	// Draws one timing from the history as a line across the graph
+	void PaintGraph(const FGeometry& AllottedGeometry, FSlateWindowElementList& OutDrawElements, int32 LayerId, float FGAM312FrameTiming::* Member, const FLinearColor& Color) const;
+
+	TWeakObjectPtr<UGAM312PerfOverlaySubsystem> Source;
+
+	// Height of one text line below the graph
+	static constexpr float LineHeight = 14.0f;
+
+	// Reused for every graph line and text line so painting does not allocate once they have grown
+	mutable TArray<FVector2D> GraphPoints;
+	mutable FString Line;
+};
@@ -0,0 +1,288 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312PickupSubsystem.h"
+#include "GAM312Stats.h"
+#include "TP_PickUpComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "TimerManager.h"
+
+static TAutoConsoleVariable<float> CVarPickupsSpawnRadius(
+	TEXT("gam.Pickups.SpawnRadius"),
+	3000.0f,
+	TEXT("Pickups within this distance of a player exist as actors."));
+
+static TAutoConsoleVariable<float> CVarPickupsReleaseRadius(
+	TEXT("gam.Pickups.ReleaseRadius"),
+	3500.0f,
+	TEXT("Pickup actors further than this from every player are turned back into records, kept above SpawnRadius so pickups at the edge do not flicker."));
+
+static TAutoConsoleVariable<int32> CVarPickupsMaxSpawnsPerUpdate(
+	TEXT("gam.Pickups.MaxSpawnsPerUpdate"),
+	16,
+	TEXT("Most pickup actors spawned by one check, so a player arriving among many records does not spawn them all in one frame. 0 for no limit."));
+
+static TAutoConsoleVariable<float> CVarPickupsInterval(
+	TEXT("gam.Pickups.Interval"),
+	0.25f,
+	TEXT("Seconds between checks of pickup records against player positions."));
+
+bool UGAM312PickupSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+bool UGAM312PickupSubsystem::IsActive() const
+{
+	return GetWorld()->GetNetMode() != NM_Client;
+}
+
+void UGAM312PickupSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (IsActive())
+	{
+		InWorld.GetTimerManager().SetTimer(UpdateTimer, this, &UGAM312PickupSubsystem::UpdateRecords, CVarPickupsInterval.GetValueOnGameThread(), true);
+	}
+}
+
+void UGAM312PickupSubsystem::Deinitialize()
+{
+	GetWorld()->GetTimerManager().ClearTimer(UpdateTimer);
+	Records.Empty();
+	PlacedRecords.Empty();
+	RemovedPlacedIds.Empty();
+
+	Super::Deinitialize();
+}
+
+FGAM312PickupRecord* UGAM312PickupSubsystem::FindRecord(FGAM312PickupHandle Handle)
+{
+	if (Records.IsValidIndex(Handle.Index) && Records[Handle.Index].Generation == Handle.Generation)
+	{
+		return &Records[Handle.Index];
+	}
+	return nullptr;
+}
+
+FGAM312PickupHandle UGAM312PickupSubsystem::AddPickup(TSubclassOf<AActor> Class, const FTransform& Transform, int32 Payload)
+{
+	FGAM312PickupRecord Record;
+	Record.Class = Class;
+	Record.Transform = Transform;
+	Record.Payload = Payload;
+	Record.Generation = NextGeneration++;
+
+	FGAM312PickupHandle Handle;
+	Handle.Generation = Record.Generation;
+	Handle.Index = Records.Add(MoveTemp(Record));
+	return Handle;
+}
+
+FGAM312PickupHandle UGAM312PickupSubsystem::AdoptPickup(UTP_PickUpComponent* PickUp)
+{
+	if (!IsActive())
+	{
+		return FGAM312PickupHandle();
+	}
+
+	// An actor spawned for a record already has one
+	if (SpawningHandle.IsValid())
+	{
+		return SpawningHandle;
+	}
+
+	// Placed pickups only opt in, the registry brings them back from class defaults
+	if (!PickUp->bUsePickupRegistry)
+	{
+		return FGAM312PickupHandle();
+	}
+
+	AActor* Owner = PickUp->GetOwner();
+	const FName PlacedId(*Owner->GetPathName());
+
+	// A pickup in a cell that streamed back in, its record remembers what happened to it meanwhile
+	if (RemovedPlacedIds.Contains(PlacedId))
+	{
+		Owner->Destroy();
+		return FGAM312PickupHandle();
+	}
+	if (const FGAM312PickupHandle* Existing = PlacedRecords.Find(PlacedId))
+	{
+		FGAM312PickupRecord& Record = Records[Existing->Index];
+		if (Record.Actor.IsValid())
+		{
+			// Spawned from the record while the cell was out
+			Owner->Destroy();
+			return FGAM312PickupHandle();
+		}
+
+		Record.Actor = Owner;
+		PickUp->Payload = Record.Payload;
+		return *Existing;
+	}
+
+	// A placed pickup becomes a record, its actor stays until the next check finds it far from every player
+	const FGAM312PickupHandle Handle = AddPickup(Owner->GetClass(), Owner->GetActorTransform(), PickUp->Payload);
+	Records[Handle.Index].Actor = Owner;
+	Records[Handle.Index].PlacedId = PlacedId;
+	PlacedRecords.Add(PlacedId, Handle);
+	return Handle;
+}
+
+void UGAM312PickupSubsystem::ConsumePickup(FGAM312PickupHandle Handle)
+{
+	// The actor now belongs to whoever picked it up
+	if (FindRecord(Handle))
+	{
+		RemoveRecord(Handle.Index);
+	}
+}
+
+void UGAM312PickupSubsystem::OnPickupEndPlay(FGAM312PickupHandle Handle, UTP_PickUpComponent* PickUp, EEndPlayReason::Type EndPlayReason)
+{
+	// Records released by the registry have already let go of their actor
+	FGAM312PickupRecord* Record = FindRecord(Handle);
+	AActor* Owner = PickUp->GetOwner();
+	if (Record == nullptr || Record->Actor.Get() != Owner)
+	{
+		return;
+	}
+
+	// Destroyed by gameplay, the pickup is gone for good
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		RemoveRecord(Handle.Index);
+		return;
+	}
+
+	// Streamed out or unloaded, the record stands in for it until a player comes near or the cell is back
+	Record->Payload = PickUp->Payload;
+	Record->Transform = Owner->GetActorTransform();
+	Record->Actor.Reset();
+}
+
+void UGAM312PickupSubsystem::RemovePickup(FGAM312PickupHandle Handle)
+{
+	if (FGAM312PickupRecord* Record = FindRecord(Handle))
+	{
+		// The record goes first so the actor's EndPlay finds nothing left to update
+		AActor* Actor = Record->Actor.Get();
+		RemoveRecord(Handle.Index);
+		if (Actor)
+		{
+			Actor->Destroy();
+		}
+	}
+}
+
+void UGAM312PickupSubsystem::RemoveRecord(int32 Index)
+{
+	const FName PlacedId = Records[Index].PlacedId;
+	if (!PlacedId.IsNone())
+	{
+		PlacedRecords.Remove(PlacedId);
+		RemovedPlacedIds.Add(PlacedId);
+	}
+	Records.RemoveAt(Index);
+}
+
+void UGAM312PickupSubsystem::UpdateRecords()
+{
+	TArray<FVector, TInlineAllocator<8>> PlayerLocations;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+		{
+			PlayerLocations.Add(Pawn->GetActorLocation());
+		}
+	}
+
+	const float SpawnRadiusSquared = FMath::Square(CVarPickupsSpawnRadius.GetValueOnGameThread());
+	const float ReleaseRadiusSquared = FMath::Square(FMath::Max(CVarPickupsReleaseRadius.GetValueOnGameThread(), CVarPickupsSpawnRadius.GetValueOnGameThread()));
+
+	const int32 MaxSpawns = CVarPickupsMaxSpawnsPerUpdate.GetValueOnGameThread();
+	int32 NumSpawned = 0;
+	int32 NumMaterialized = 0;
+	for (auto It = Records.CreateIterator(); It; ++It)
+	{
+		float NearestSquared = MAX_flt;
+		for (const FVector& PlayerLocation : PlayerLocations)
+		{
+			NearestSquared = FMath::Min(NearestSquared, FVector::DistSquared(PlayerLocation, It->Transform.GetLocation()));
+		}
+
+		const bool bMaterialized = It->Actor.IsValid();
+		if (!bMaterialized && NearestSquared <= SpawnRadiusSquared && (MaxSpawns <= 0 || NumSpawned < MaxSpawns))
+		{
+			Materialize(It.GetIndex());
+			++NumSpawned;
+		}
+		else if (bMaterialized && NearestSquared > ReleaseRadiusSquared)
+		{
+			Release(It.GetIndex());
+		}
+		NumMaterialized += It->Actor.IsValid() ? 1 : 0;
+	}
+
+	GAM312Stats::SetGauge(TEXT("Pickups.Records"), Records.Num());
+	GAM312Stats::SetGauge(TEXT("Pickups.Materialized"), NumMaterialized, Records.Num());
+}
+
+void UGAM312PickupSubsystem::Materialize(int32 Index)
+{
+	FGAM312PickupRecord& Record = Records[Index];
+	if (Record.Class == nullptr)
+	{
+		return;
+	}
+
+	AActor* Actor = GetWorld()->SpawnActorDeferred<AActor>(Record.Class, Record.Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	// BeginPlay links the pickup component to this record instead of adopting it as a new one
+	FGAM312PickupHandle Handle;
+	Handle.Index = Index;
+	Handle.Generation = Record.Generation;
+	SpawningHandle = Handle;
+	Actor->FinishSpawning(Record.Transform);
+	SpawningHandle = FGAM312PickupHandle();
+
+	// Looked up again, BeginPlay may have added records and moved this one
+	FGAM312PickupRecord* Spawned = FindRecord(Handle);
+	if (Spawned == nullptr)
+	{
+		Actor->Destroy();
+		return;
+	}
+
+	// The payload goes back on after construction, which would otherwise reset it to the class default
+	if (UTP_PickUpComponent* PickUp = Actor->FindComponentByClass<UTP_PickUpComponent>())
+	{
+		PickUp->Payload = Spawned->Payload;
+	}
+	Spawned->Actor = Actor;
+}
+
+void UGAM312PickupSubsystem::Release(int32 Index)
+{
+	FGAM312PickupRecord& Record = Records[Index];
+	AActor* Actor = Record.Actor.Get();
+
+	// Anything the actor changed while it was around is kept in the record
+	if (UTP_PickUpComponent* PickUp = Actor->FindComponentByClass<UTP_PickUpComponent>())
+	{
+		Record.Payload = PickUp->Payload;
+	}
+	Record.Transform = Actor->GetActorTransform();
+	Record.Actor.Reset();
+
+	Actor->Destroy();
+}
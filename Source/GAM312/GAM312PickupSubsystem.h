@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312PickupSubsystem.generated.h"
+
+class UTP_PickUpComponent;
+
+// Refers to one pickup record, the generation keeps a handle from reaching a later record in the same slot
+struct FGAM312PickupHandle
+{
+	int32 Index = INDEX_NONE;
+	uint32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+};
+
+// Everything needed to bring a pickup back as an actor
+struct FGAM312PickupRecord
+{
+	TSubclassOf<AActor> Class;
+	FTransform Transform;
+	int32 Payload = 0;
+
+	// Actor standing in for the record while a player is near, null otherwise
+	TWeakObjectPtr<AActor> Actor;
+
+	// Matches FGAM312PickupHandle::Generation
+	uint32 Generation = 0;
+
+	// Path of the placed actor the record was made from, none for records added in code
+	FName PlacedId;
+};
+
+/**
+ * Keeps pickups as compact records and only spawns their actors within gam.Pickups.SpawnRadius of a
+ * player, destroying them again beyond gam.Pickups.ReleaseRadius. At most gam.Pickups.MaxSpawnsPerUpdate
+ * actors are spawned per check, the rest follow on the next ones. Placed pickups with bUsePickupRegistry
+ * are turned into records when they begin play. A materialized pickup is an ordinary actor
+ * with its UTP_PickUpComponent, so OnPickUp broadcasts exactly as before; a picked up record is
+ * removed and never spawned again.
+ *
+ * Records made from placed pickups are keyed by the actor's path. When a streamed out cell comes back
+ * its pickups link to their old records instead of adding new ones, and pickups that were picked up or
+ * destroyed meanwhile, or whose record already has an actor, are destroyed again.
+ *
+ * Runs on the server and in standalone games only, clients see the replicated actors. Record and
+ * actor counts are published as Pickups.* gauges.
+ */
+UCLASS()
+class GAM312_API UGAM312PickupSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Adds a pickup as a record, it is spawned once a player comes near
+	FGAM312PickupHandle AddPickup(TSubclassOf<AActor> Class, const FTransform& Transform, int32 Payload);
+
+	// Called by every pickup component as it begins play, returns the record handle or an invalid one if the registry does not manage it
+	FGAM312PickupHandle AdoptPickup(UTP_PickUpComponent* PickUp);
+
+	// Called by a pickup component once it has been picked up
+	void ConsumePickup(FGAM312PickupHandle Handle);
+
+	// Called by a pickup component as it ends play, keeps the record if the actor was only streamed out
+	void OnPickupEndPlay(FGAM312PickupHandle Handle, UTP_PickUpComponent* PickUp, EEndPlayReason::Type EndPlayReason);
+
+	// Removes a record and destroys its actor if it has one
+	void RemovePickup(FGAM312PickupHandle Handle);
+
+	int32 GetNumRecords() const { return Records.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	// Spawns the records near players and releases the actors far from them
+	void UpdateRecords();
+
+	void Materialize(int32 Index);
+	void Release(int32 Index);
+
+	// Record the handle refers to, null once that record is gone
+	FGAM312PickupRecord* FindRecord(FGAM312PickupHandle Handle);
+
+	// Removes a record for good, a placed pickup's path is remembered so it is not brought back
+	void RemoveRecord(int32 Index);
+
+	bool IsActive() const;
+
+	TSparseArray<FGAM312PickupRecord> Records;
+	uint32 NextGeneration = 1;
+
+	// Records of placed pickups by actor path, and the paths of placed pickups that are gone
+	TMap<FName, FGAM312PickupHandle> PlacedRecords;
+	TSet<FName> RemovedPlacedIds;
+
+	// Record being spawned, so its actor links to it instead of being adopted as a new record
+	FGAM312PickupHandle SpawningHandle;
+
+	FTimerHandle UpdateTimer;
+};
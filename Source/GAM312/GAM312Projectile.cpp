@@ -4,9 +4,14 @@
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
 #include <Kismet/GameplayStatics.h>
+#include "GAM312FixedStepSubsystem.h"
+#include "GAM312WorldBoundsSubsystem.h"
+#include "GAM312Stats.h"
 
 AGAM312Projectile::AGAM312Projectile() 
 {
+	LLM_SCOPE_BYTAG(GAM312_Projectiles);
+
 	// Use a sphere as a simple collision representation
 	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	CollisionComp->InitSphereRadius(5.0f);
@@ -30,5 +35,43 @@ AGAM312Projectile::AGAM312Projectile()
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
 
+	// Replicate only the spawn, clients simulate the flight themselves
+	bReplicates = true;
+	bNetTemporary = true;
+	SetReplicateMovement(false);
+
 	DamageAmount = 10.0f;
 }
+
+void AGAM312Projectile::BeginPlay()
+{
+	LLM_SCOPE_BYTAG(GAM312_Projectiles);
+
+	Super::BeginPlay();
+
+	GAM312Stats::AddInFlightProjectiles(1);
+
+	// Projectiles that leave the world are destroyed by the world bounds sweep
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->RegisterActor(this);
+	}
+
+	// Flight is stepped at a fixed rate when gam.Projectile.FixedStepHz is set
+	if (UGAM312FixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UGAM312FixedStepSubsystem>())
+	{
+		FixedStep->RegisterProjectile(ProjectileMovement);
+	}
+}
+
+void AGAM312Projectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GAM312Stats::AddInFlightProjectiles(-1);
+
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
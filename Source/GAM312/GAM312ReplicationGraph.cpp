@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312ReplicationGraph.h"
+#include "Enemy.h"
+#include "Projectile.h"
+#include "GAM312Projectile.h"
+#include "GAM312Stats.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameStateBase.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Engine/LevelScriptActor.h"
+#include "Engine/NetConnection.h"
+#include "Misc/CommandLine.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312RepGraph, Log, All);
+
+// Sets default values
+UGAM312ReplicationGraph::UGAM312ReplicationGraph()
+{
+	GridNode = nullptr;
+	AlwaysRelevantNode = nullptr;
+}
+
+EGAM312RepNodeMapping UGAM312ReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+	EGAM312RepNodeMapping* Policy = ClassRepNodePolicies.Get(Class);
+	return Policy ? *Policy : EGAM312RepNodeMapping::NotRouted;
+}
+
+void UGAM312ReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const
+{
+	const AActor* CDO = Class->GetDefaultObject<AActor>();
+	if (bSpatialize)
+	{
+		Info.SetCullDistanceSquared(CDO->NetCullDistanceSquared);
+	}
+
+	Info.ReplicationPeriodFrame = GetReplicationPeriodFrameForFrequency(CDO->NetUpdateFrequency);
+}
+
+void UGAM312ReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	// Routing for the engine classes, AActor is the fallback for anything not listed
+	ClassRepNodePolicies.Set(AActor::StaticClass(), EGAM312RepNodeMapping::Spatialize_Dormancy);
+	ClassRepNodePolicies.Set(AGameStateBase::StaticClass(), EGAM312RepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EGAM312RepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(APlayerController::StaticClass(), EGAM312RepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EGAM312RepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(ACharacter::StaticClass(), EGAM312RepNodeMapping::Spatialize_Dynamic);
+
+	// Routing for the game classes
+	ClassRepNodePolicies.Set(AEnemy::StaticClass(), EGAM312RepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AProjectile::StaticClass(), EGAM312RepNodeMapping::Projectile);
+	ClassRepNodePolicies.Set(AGAM312Projectile::StaticClass(), EGAM312RepNodeMapping::Projectile);
+
+	// Set up the replication info for every replicated actor class that is loaded
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+		if (!ActorCDO || !ActorCDO->GetIsReplicated())
+		{
+			continue;
+		}
+
+		// Skip skeleton and reinstanced blueprint classes
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+		{
+			continue;
+		}
+
+		// Relevancy flags on the defaults win over a policy inherited from a parent class, the same
+		// way the legacy net driver treats them. Classes mapped above by name and player controllers
+		// keep their policy.
+		if (!ClassRepNodePolicies.Contains(Class, false) && GetMappingPolicy(Class) != EGAM312RepNodeMapping::NotRouted)
+		{
+			if (ActorCDO->bOnlyRelevantToOwner)
+			{
+				ClassRepNodePolicies.Set(Class, EGAM312RepNodeMapping::RelevantOwnerConnection);
+			}
+			else if (ActorCDO->bAlwaysRelevant)
+			{
+				ClassRepNodePolicies.Set(Class, EGAM312RepNodeMapping::RelevantAllConnections);
+			}
+		}
+
+		const EGAM312RepNodeMapping Policy = GetMappingPolicy(Class);
+		const bool bSpatialize = Policy == EGAM312RepNodeMapping::Spatialize_Dynamic
+			|| Policy == EGAM312RepNodeMapping::Spatialize_Dormancy
+			|| Policy == EGAM312RepNodeMapping::Projectile;
+
+		FClassReplicationInfo ClassInfo;
+		InitClassReplicationInfo(ClassInfo, Class, bSpatialize);
+
+		// Projectiles live a few seconds, so keep their range small and close their channels quickly
+		if (Policy == EGAM312RepNodeMapping::Projectile)
+		{
+			ClassInfo.SetCullDistanceSquared(FMath::Square(ProjectileCullDistance));
+			ClassInfo.ReplicationPeriodFrame = 1;
+			ClassInfo.ActorChannelFrameTimeout = ProjectileChannelFrameTimeout;
+		}
+
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, ClassInfo);
+	}
+}
+
+void UGAM312ReplicationGraph::InitGlobalGraphNodes()
+{
+	// Preallocate the replication lists so they do not grow during play
+	PreAllocateRepList(3, 12);
+	PreAllocateRepList(6, 12);
+	PreAllocateRepList(128, 64);
+	PreAllocateRepList(512, 16);
+
+	// Spatial grid for everything that has a location that matters
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = SpatialCellSize;
+	GridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	// Always relevant node for game state and player states
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	FParse::Value(FCommandLine::Get(), TEXT("gamrepbench="), BenchmarkSeconds);
+}
+
+void UGAM312ReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	// Each connection always gets its own player controller and view target
+	UGAM312ReplicationGraphNode_AlwaysRelevant_ForConnection* AlwaysRelevantConnectionNode = CreateNewNode<UGAM312ReplicationGraphNode_AlwaysRelevant_ForConnection>();
+	AlwaysRelevantConnectionNode->Graph = this;
+	AddConnectionGraphNode(AlwaysRelevantConnectionNode, RepGraphConnection);
+}
+
+void UGAM312ReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EGAM312RepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EGAM312RepNodeMapping::RelevantOwnerConnection:
+		OwnerRelevantActors.Add(ActorInfo.Actor);
+		break;
+
+	case EGAM312RepNodeMapping::Spatialize_Dynamic:
+	case EGAM312RepNodeMapping::Projectile:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case EGAM312RepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UGAM312ReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EGAM312RepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EGAM312RepNodeMapping::RelevantOwnerConnection:
+		OwnerRelevantActors.RemoveFast(ActorInfo.Actor);
+		break;
+
+	case EGAM312RepNodeMapping::Spatialize_Dynamic:
+	case EGAM312RepNodeMapping::Projectile:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case EGAM312RepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+
+	default:
+		break;
+	}
+}
+
+int32 UGAM312ReplicationGraph::ServerReplicateActors(float DeltaSeconds)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	const int32 Replicated = Super::ServerReplicateActors(DeltaSeconds);
+	const float FrameMs = static_cast<float>(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles));
+
+	const int32 NumConnections = Connections.Num();
+	GAM312Stats::SetGauge(TEXT("RepGraph.Connections"), NumConnections);
+	if (NumConnections > 0)
+	{
+		CSV_CUSTOM_STAT(GAM312, RepGraphMsPerConnection, FrameMs / NumConnections, ECsvCustomStatOp::Set);
+	}
+
+	// Benchmark windows only start once clients are connected
+	if (BenchmarkSeconds > 0.0f && NumConnections > 0)
+	{
+		const double Now = FPlatformTime::Seconds();
+		if (BenchmarkFrameMs.Num() == 0)
+		{
+			BenchmarkWindowStart = Now;
+		}
+
+		BenchmarkFrameMs.Add(FrameMs);
+		BenchmarkConnections = FMath::Max(BenchmarkConnections, NumConnections);
+
+		if (Now - BenchmarkWindowStart >= BenchmarkSeconds)
+		{
+			FinishBenchmarkWindow();
+		}
+	}
+
+	return Replicated;
+}
+
+void UGAM312ReplicationGraph::FinishBenchmarkWindow()
+{
+	float TotalMs = 0.0f;
+	for (float FrameMs : BenchmarkFrameMs)
+	{
+		TotalMs += FrameMs;
+	}
+	BenchmarkFrameMs.Sort();
+
+	const float AverageMs = TotalMs / BenchmarkFrameMs.Num();
+	const float P95Ms = BenchmarkFrameMs[FMath::Min(BenchmarkFrameMs.Num() - 1, FMath::FloorToInt(BenchmarkFrameMs.Num() * 0.95f))];
+	UE_LOG(LogGAM312RepGraph, Display, TEXT("Replication benchmark: %d connections, %d frames, avg %.3f ms per frame (p95 %.3f), %.4f ms per connection"),
+		BenchmarkConnections, BenchmarkFrameMs.Num(), AverageMs, P95Ms, AverageMs / BenchmarkConnections);
+
+	BenchmarkFrameMs.Reset();
+	BenchmarkConnections = 0;
+}
+
+void UGAM312ReplicationGraphNode_AlwaysRelevant_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	ReplicationActorList.Reset();
+
+	// Add the viewing player controller and whatever it is looking through
+	for (const FNetViewer& CurViewer : Params.Viewers)
+	{
+		ReplicationActorList.ConditionalAdd(CurViewer.InViewer);
+		ReplicationActorList.ConditionalAdd(CurViewer.ViewTarget);
+	}
+
+	// Owner only actors of this connection, there are only a handful so a scan is cheaper than a map
+	if (Graph)
+	{
+		for (AActor* Actor : Graph->OwnerRelevantActors)
+		{
+			if (Actor->GetNetConnection() == Params.ConnectionManager.NetConnection)
+			{
+				ReplicationActorList.ConditionalAdd(Actor);
+			}
+		}
+	}
+
+	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+}
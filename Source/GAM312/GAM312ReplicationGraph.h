@@ -0,0 +1,107 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "GAM312ReplicationGraph.generated.h"
+
+class UReplicationGraphNode_GridSpatialization2D;
+class UReplicationGraphNode_ActorList;
+
+// How an actor class is routed into the replication graph
+UENUM()
+enum class EGAM312RepNodeMapping : uint8
+{
+	NotRouted,				// Not put in any global node (player controllers are handled per connection)
+	RelevantAllConnections,	// Always relevant node (game state, player states, bAlwaysRelevant actors)
+	RelevantOwnerConnection,	// Only gathered for the owning connection (bOnlyRelevantToOwner actors)
+	Spatialize_Dynamic,		// Grid node, re-bucketed every frame (enemies, characters)
+	Spatialize_Dormancy,	// Grid node, static while dormant and dynamic while awake (pickups)
+	Projectile,				// Grid node using the short-lived projectile settings
+};
+
+/**
+ * Replication graph for GAM312. Enemies, pickups and projectiles are put in a spatial grid so each
+ * connection only gathers the cells around its viewer instead of looping over every actor in the map.
+ * Classes without an explicit policy are routed from their defaults: bAlwaysRelevant actors go to
+ * every connection and bOnlyRelevantToOwner actors only to their owner's.
+ *
+ * Server replication time is measured every frame. With -gamrepbench=Seconds the server logs the
+ * average time per frame and per connection over each window, for the 16 and 64 client runs in
+ * Scripts/RepGraphBenchmark.sh.
+ */
+UCLASS(transient, config=Engine)
+class GAM312_API UGAM312ReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UGAM312ReplicationGraph();
+
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+	virtual int32 ServerReplicateActors(float DeltaSeconds) override;
+
+	// Size of one grid cell in world units
+	UPROPERTY(config)
+	float SpatialCellSize = 10000.0f;
+
+	// Grid origin offset, should cover the most negative corner of the largest map
+	UPROPERTY(config)
+	FVector2D SpatialBias = FVector2D(-200000.0f, -200000.0f);
+
+	// Cull distance used for projectiles, they only matter to connections close to them
+	UPROPERTY(config)
+	float ProjectileCullDistance = 8000.0f;
+
+	// Frames a projectile channel is kept open after it stops being relevant
+	UPROPERTY(config)
+	int32 ProjectileChannelFrameTimeout = 2;
+
+	// Spatial grid for enemies, pickups and projectiles
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	// Node for actors every connection needs (game state, player states)
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	// Actors only relevant to their owner, each connection gathers the ones it owns
+	FActorRepListRefView OwnerRelevantActors;
+
+private:
+	// Returns the routing policy for a class, walking up to the closest mapped parent
+	EGAM312RepNodeMapping GetMappingPolicy(UClass* Class);
+
+	// Fills in the class replication info from the class default object
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize) const;
+
+	// Logs the replication time of the benchmark window that just ended
+	void FinishBenchmarkWindow();
+
+	TClassMap<EGAM312RepNodeMapping> ClassRepNodePolicies;
+
+	// Benchmark window length from -gamrepbench=, 0 when not benchmarking
+	float BenchmarkSeconds = 0.0f;
+	double BenchmarkWindowStart = 0.0;
+	TArray<float> BenchmarkFrameMs;
+	int32 BenchmarkConnections = 0;
+};
+
+// Per connection node that always replicates the connection's own controller, view target and owner only actors
+UCLASS()
+class GAM312_API UGAM312ReplicationGraphNode_AlwaysRelevant_ForConnection : public UReplicationGraphNode_AlwaysRelevant_ForConnection
+{
+	GENERATED_BODY()
+
+public:
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+	// Graph holding the owner only actors
+	UPROPERTY()
+	UGAM312ReplicationGraph* Graph = nullptr;
+};
@@ -0,0 +1,659 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312SaveSubsystem.h"
+#include "GAM312Character.h"
+#include "GAM312Stats.h"
+#include "Cube.h"
+#include "Enemy.h"
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Save, Log, All);
+
+static TAutoConsoleVariable<int32> CVarSaveMaxDeltas(
+	TEXT("gam.Save.MaxDeltas"),
+	8,
+	TEXT("Delta saves written after a base before the next save writes a new base."));
+
+static TAutoConsoleVariable<float> CVarSaveAutoInterval(
+	TEXT("gam.Save.AutoInterval"),
+	0.0f,
+	TEXT("Seconds between automatic checkpoints to the Default slot, 0 turns them off."));
+
+static FAutoConsoleCommandWithWorldAndArgs GSaveCommand(
+	TEXT("gam.Save"),
+	TEXT("Writes a checkpoint of the gameplay state in the background. Usage: gam.Save [Slot]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312SaveSubsystem* SaveSubsystem = World ? World->GetSubsystem<UGAM312SaveSubsystem>() : nullptr)
+		{
+			SaveSubsystem->Save(Args.IsValidIndex(0) ? Args[0] : TEXT("Default"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GLoadCommand(
+	TEXT("gam.Load"),
+	TEXT("Reads a slot's base and deltas in the background and applies them. Usage: gam.Load [Slot]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312SaveSubsystem* SaveSubsystem = World ? World->GetSubsystem<UGAM312SaveSubsystem>() : nullptr)
+		{
+			SaveSubsystem->Load(Args.IsValidIndex(0) ? Args[0] : TEXT("Default"));
+		}
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GSaveBenchmarkCommand(
+	TEXT("gam.Save.Benchmark"),
+	TEXT("Times a full save, a delta save and a load of the current world into the Benchmark slot."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (UGAM312SaveSubsystem* SaveSubsystem = World ? World->GetSubsystem<UGAM312SaveSubsystem>() : nullptr)
+		{
+			SaveSubsystem->RunBenchmark();
+		}
+	}));
+
+// Bump when the record layout changes, files with a newer version are refused
+static constexpr uint32 SaveMagic = 0x32313347;
+static constexpr uint16 SaveVersion = 1;
+
+// Smallest record on disk, a destroyed entity's id and kind
+static constexpr int32 SaveMinRecordSize = sizeof(uint64) + sizeof(uint8);
+
+// Far above any real save, a header claiming more is corrupt
+static constexpr int32 SaveMaxRawSize = 256 * 1024 * 1024;
+
+// Uncompressed start of every save file
+struct FGAM312SaveHeader
+{
+	uint32 Magic = SaveMagic;
+	uint16 Version = SaveVersion;
+	uint8 bDelta = 0;
+	uint32 BaseId = 0;
+	int32 DeltaIndex = 0;
+	int32 NumRecords = 0;
+	int32 RawSize = 0;
+	int32 CompressedSize = 0;
+
+	friend FArchive& operator<<(FArchive& Ar, FGAM312SaveHeader& Header)
+	{
+		return Ar << Header.Magic << Header.Version << Header.bDelta << Header.BaseId << Header.DeltaIndex << Header.NumRecords << Header.RawSize << Header.CompressedSize;
+	}
+};
+
+FArchive& operator<<(FArchive& Ar, FGAM312SaveRecord& Record)
+{
+	uint8 Kind = (uint8)Record.Kind;
+	Ar << Record.Id << Kind;
+	Record.Kind = (EGAM312SaveKind)Kind;
+
+	// Destroyed entities only need their id
+	if (Record.Kind != EGAM312SaveKind::Destroyed)
+	{
+		Ar << Record.Health << Record.Location << Record.Anchor;
+	}
+	return Ar;
+}
+
+static FString GetDeltaPath(const FGAM312SaveSlot& Slot, int32 DeltaIndex)
+{
+	return Slot.Directory / FString::Printf(TEXT("Delta_%d.sav"), DeltaIndex);
+}
+
+// Runs on the thread pool: works out what changed since the slot's last checkpoint and writes it
+static FGAM312SaveResult WriteCheckpoint(FGAM312SaveSlot& Slot, TArray<FGAM312SaveRecord>& Records, bool bForceFull, int32 MaxDeltas)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	FGAM312SaveResult Result;
+	Result.bDelta = !bForceFull && Slot.BaseId != 0 && Slot.NumDeltas < MaxDeltas;
+
+	if (Result.bDelta)
+	{
+		// Keep only the records that differ from the last checkpoint
+		Records.RemoveAllSwap([&Slot](const FGAM312SaveRecord& Record)
+		{
+			const FGAM312SaveRecord* Previous = Slot.Baseline.Find(Record.Id);
+			return Previous && *Previous == Record;
+		}, false);
+	}
+	else
+	{
+		Slot.Baseline.Reset();
+	}
+
+	TArray<uint8> Raw;
+	FMemoryWriter RawWriter(Raw);
+	for (FGAM312SaveRecord& Record : Records)
+	{
+		RawWriter << Record;
+	}
+
+	FGAM312SaveHeader Header;
+	Header.bDelta = Result.bDelta;
+	Header.BaseId = Result.bDelta ? Slot.BaseId : (GetTypeHash(FGuid::NewGuid()) | 1);
+	Header.DeltaIndex = Result.bDelta ? Slot.NumDeltas + 1 : 0;
+	Header.NumRecords = Records.Num();
+	Header.RawSize = Raw.Num();
+
+	// Header first with the compressed size filled in once it is known
+	TArray<uint8> File;
+	FMemoryWriter FileWriter(File);
+	FileWriter << Header;
+	const int32 HeaderSize = File.Num();
+
+	int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Raw.Num());
+	File.SetNumUninitialized(HeaderSize + CompressedSize);
+	if (!FCompression::CompressMemory(NAME_Zlib, File.GetData() + HeaderSize, CompressedSize, Raw.GetData(), Raw.Num()))
+	{
+		UE_LOG(LogGAM312Save, Error, TEXT("Could not compress %d bytes for slot %s"), Raw.Num(), *Slot.Name);
+		return Result;
+	}
+	File.SetNum(HeaderSize + CompressedSize);
+
+	Header.CompressedSize = CompressedSize;
+	FileWriter.Seek(0);
+	FileWriter << Header;
+
+	// Written under a temporary name and moved, so a crash never leaves a half written file
+	const FString Path = Result.bDelta ? GetDeltaPath(Slot, Header.DeltaIndex) : Slot.Directory / TEXT("Base.sav");
+	const FString TempPath = Path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(File, *TempPath) || !IFileManager::Get().Move(*Path, *TempPath, true))
+	{
+		UE_LOG(LogGAM312Save, Error, TEXT("Could not write %s"), *Path);
+		return Result;
+	}
+
+	if (!Result.bDelta)
+	{
+		// Old deltas name the previous base and would be skipped anyway, this just tidies them up
+		for (int32 DeltaIndex = 1; DeltaIndex <= Slot.NumDeltas; ++DeltaIndex)
+		{
+			IFileManager::Get().Delete(*GetDeltaPath(Slot, DeltaIndex), false, false, true);
+		}
+		Slot.BaseId = Header.BaseId;
+		Slot.NumDeltas = 0;
+	}
+	else
+	{
+		Slot.NumDeltas = Header.DeltaIndex;
+	}
+
+	for (const FGAM312SaveRecord& Record : Records)
+	{
+		Slot.Baseline.Add(Record.Id, Record);
+	}
+
+	Result.bSucceeded = true;
+	Result.NumRecords = Records.Num();
+	Result.RawBytes = Raw.Num();
+	Result.FileBytes = File.Num();
+	Result.WriteMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	return Result;
+}
+
+// Reads one save file through a memory mapping and merges its records into Records
+static bool ReadCheckpoint(const FString& Path, FGAM312SaveHeader& OutHeader, TMap<uint64, FGAM312SaveRecord>& Records, int64& OutFileBytes)
+{
+	// The mapping is released before the handle
+	TUniquePtr<IMappedFileHandle> Handle(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*Path));
+	TUniquePtr<IMappedFileRegion> Region(Handle ? Handle->MapRegion(0, Handle->GetFileSize(), true) : nullptr);
+
+	// Platforms without mapped files read the file instead
+	TArray<uint8> FileData;
+	TArrayView<const uint8> Data;
+	if (Region)
+	{
+		Data = TArrayView<const uint8>(Region->GetMappedPtr(), Region->GetMappedSize());
+	}
+	else if (FFileHelper::LoadFileToArray(FileData, *Path, FILEREAD_Silent))
+	{
+		Data = FileData;
+	}
+	else
+	{
+		return false;
+	}
+
+	FMemoryReaderView Reader(Data);
+	Reader << OutHeader;
+	const int64 HeaderSize = Reader.Tell();
+	if (Reader.IsError() || OutHeader.Magic != SaveMagic || OutHeader.Version > SaveVersion || HeaderSize + OutHeader.CompressedSize > Data.Num())
+	{
+		UE_LOG(LogGAM312Save, Error, TEXT("%s is not a save file this build can read"), *Path);
+		return false;
+	}
+
+	// The sizes and count are checked before anything is allocated from them
+	if (OutHeader.CompressedSize <= 0 || OutHeader.RawSize < 0 || OutHeader.RawSize > SaveMaxRawSize
+		|| OutHeader.NumRecords < 0 || OutHeader.NumRecords > OutHeader.RawSize / SaveMinRecordSize)
+	{
+		UE_LOG(LogGAM312Save, Error, TEXT("%s is corrupt: %d records in %d bytes, %d bytes compressed"), *Path, OutHeader.NumRecords, OutHeader.RawSize, OutHeader.CompressedSize);
+		return false;
+	}
+
+	TArray<uint8> Raw;
+	Raw.SetNumUninitialized(OutHeader.RawSize);
+	if (Raw.Num() > 0 && !FCompression::UncompressMemory(NAME_Zlib, Raw.GetData(), Raw.Num(), Data.GetData() + HeaderSize, OutHeader.CompressedSize))
+	{
+		UE_LOG(LogGAM312Save, Error, TEXT("%s is corrupt"), *Path);
+		return false;
+	}
+
+	FMemoryReader RawReader(Raw);
+	Records.Reserve(Records.Num() + OutHeader.NumRecords);
+	for (int32 Index = 0; Index < OutHeader.NumRecords && !RawReader.IsError(); ++Index)
+	{
+		FGAM312SaveRecord Record;
+		RawReader << Record;
+		Records.Add(Record.Id, Record);
+	}
+
+	// The records have to use up the data exactly, anything left over or missing means a bad count
+	if (RawReader.IsError() || RawReader.Tell() != OutHeader.RawSize)
+	{
+		UE_LOG(LogGAM312Save, Error, TEXT("%s is corrupt: %d records do not fill %d bytes"), *Path, OutHeader.NumRecords, OutHeader.RawSize);
+		return false;
+	}
+
+	OutFileBytes += Data.Num();
+	return true;
+}
+
+// Runs on the thread pool: reads the base and every delta written against it, in order
+static FGAM312LoadResult ReadSlot(FGAM312SaveSlot& Slot)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	FGAM312LoadResult Result;
+	FGAM312SaveHeader BaseHeader;
+	if (!ReadCheckpoint(Slot.Directory / TEXT("Base.sav"), BaseHeader, Result.Records, Result.FileBytes) || BaseHeader.bDelta)
+	{
+		return Result;
+	}
+	Result.NumFiles = 1;
+
+	int32 DeltaIndex = 1;
+	for (; IFileManager::Get().FileExists(*GetDeltaPath(Slot, DeltaIndex)); ++DeltaIndex)
+	{
+		// A delta from an older base ends the chain
+		FGAM312SaveHeader DeltaHeader;
+		TMap<uint64, FGAM312SaveRecord> DeltaRecords;
+		if (!ReadCheckpoint(GetDeltaPath(Slot, DeltaIndex), DeltaHeader, DeltaRecords, Result.FileBytes) || DeltaHeader.BaseId != BaseHeader.BaseId || DeltaHeader.DeltaIndex != DeltaIndex)
+		{
+			break;
+		}
+
+		Result.Records.Append(MoveTemp(DeltaRecords));
+		++Result.NumFiles;
+	}
+
+	// Later saves to this slot are deltas against what was just read
+	Slot.Baseline = Result.Records;
+	Slot.BaseId = BaseHeader.BaseId;
+	Slot.NumDeltas = DeltaIndex - 1;
+
+	Result.bSucceeded = true;
+	Result.ReadMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	return Result;
+}
+
+bool UGAM312SaveSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UGAM312SaveSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312SaveSubsystem, STATGROUP_Tickables);
+}
+
+void UGAM312SaveSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	for (TActorIterator<AEnemy> It(&InWorld); It; ++It)
+	{
+		RegisterEnemy(*It);
+	}
+	ActorSpawnedHandle = InWorld.AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &UGAM312SaveSubsystem::OnActorSpawned));
+	ActorDestroyedHandle = InWorld.AddOnActorDestroyedHandler(FOnActorDestroyed::FDelegate::CreateUObject(this, &UGAM312SaveSubsystem::OnActorDestroyed));
+
+	NextAutoSaveTime = InWorld.GetTimeSeconds() + CVarSaveAutoInterval.GetValueOnGameThread();
+}
+
+void UGAM312SaveSubsystem::Deinitialize()
+{
+	GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	GetWorld()->RemoveOnActorDestroyededHandler(ActorDestroyedHandle);
+
+	// Let a save in flight reach the disk, the slot it writes stays alive through the shared pointer
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+	}
+
+	Super::Deinitialize();
+}
+
+void UGAM312SaveSubsystem::OnActorSpawned(AActor* Actor)
+{
+	if (AEnemy* Enemy = Cast<AEnemy>(Actor))
+	{
+		RegisterEnemy(Enemy);
+	}
+}
+
+void UGAM312SaveSubsystem::OnActorDestroyed(AActor* Actor)
+{
+	if (!Actor->IsA<AEnemy>() && !Actor->IsA<ACube>())
+	{
+		return;
+	}
+
+	const uint64 Id = GetSaveId(Actor);
+	Enemies.Remove(Id);
+
+	// Only placed actors come back when the map loads, so only they need to be removed again
+	if (Actor->HasAnyFlags(RF_WasLoaded))
+	{
+		DestroyedIds.Add(Id);
+	}
+}
+
+void UGAM312SaveSubsystem::RegisterEnemy(AEnemy* Enemy)
+{
+	Enemies.Add(GetSaveId(Enemy), Enemy);
+}
+
+uint64 UGAM312SaveSubsystem::GetSaveId(const FString& Name)
+{
+	return CityHash64((const char*)*Name, Name.Len() * sizeof(TCHAR));
+}
+
+uint64 UGAM312SaveSubsystem::GetSaveId(const AActor* Actor)
+{
+	// The same in PIE and in a packaged game
+	return GetSaveId(UWorld::RemovePIEPrefix(Actor->GetPathName()));
+}
+
+TSharedRef<FGAM312SaveSlot> UGAM312SaveSubsystem::GetSlot(const FString& SlotName)
+{
+	if (!Slot.IsValid() || Slot->Name != SlotName)
+	{
+		Slot = MakeShared<FGAM312SaveSlot>();
+		Slot->Name = SlotName;
+		Slot->Directory = GetSlotDirectory(SlotName);
+	}
+	return Slot.ToSharedRef();
+}
+
+FString UGAM312SaveSubsystem::GetSlotDirectory(const FString& SlotName)
+{
+	return FPaths::ProjectSavedDir() / TEXT("SaveGames") / TEXT("GAM312") / SlotName;
+}
+
+bool UGAM312SaveSubsystem::IsBusy() const
+{
+	return (PendingSave.IsValid() && !PendingSave.IsReady()) || (PendingLoad.IsValid() && !PendingLoad.IsReady());
+}
+
+void UGAM312SaveSubsystem::Snapshot(TArray<FGAM312SaveRecord>& Records) const
+{
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_SaveSnapshot);
+
+	Records.Reserve(FMath::Max(LastNumRecords, Enemies.Num() + DestroyedIds.Num()));
+
+	// Players are spawned fresh each session, so they are keyed by their place in the controller list
+	int32 PlayerIndex = 0;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It, ++PlayerIndex)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (AGAM312Character* Character = PlayerController ? Cast<AGAM312Character>(PlayerController->GetPawn()) : nullptr)
+		{
+			FGAM312SaveRecord& Record = Records.AddDefaulted_GetRef();
+			Record.Id = GetSaveId(FString::Printf(TEXT("Player%d"), PlayerIndex));
+			Record.Kind = EGAM312SaveKind::Player;
+			Record.Health = Character->Health;
+			Record.Location = FVector3f(Character->GetActorLocation());
+			Record.Anchor = FVector3f(Character->GetRespawnLocation());
+		}
+	}
+
+	for (const TPair<uint64, TWeakObjectPtr<AEnemy>>& Pair : Enemies)
+	{
+		if (const AEnemy* Enemy = Pair.Value.Get())
+		{
+			FGAM312SaveRecord& Record = Records.AddDefaulted_GetRef();
+			Record.Id = Pair.Key;
+			Record.Kind = EGAM312SaveKind::Enemy;
+			Record.Health = Enemy->Health;
+			Record.Location = FVector3f(Enemy->GetActorLocation());
+			Record.Anchor = FVector3f(Enemy->BaseLocation);
+		}
+	}
+
+	for (uint64 Id : DestroyedIds)
+	{
+		FGAM312SaveRecord& Record = Records.AddDefaulted_GetRef();
+		Record.Id = Id;
+		Record.Kind = EGAM312SaveKind::Destroyed;
+	}
+}
+
+bool UGAM312SaveSubsystem::Save(const FString& SlotName, bool bForceFull)
+{
+	// Clients get their state from the server
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return false;
+	}
+
+	if (IsBusy())
+	{
+		UE_LOG(LogGAM312Save, Warning, TEXT("Not saving to %s, the previous save or load is still running"), *SlotName);
+		return false;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	TArray<FGAM312SaveRecord> Records;
+	Snapshot(Records);
+	LastNumRecords = Records.Num();
+
+	const double SnapshotMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+	const int32 MaxDeltas = CVarSaveMaxDeltas.GetValueOnGameThread();
+
+	PendingSave = Async(EAsyncExecution::ThreadPool, [SaveSlot = GetSlot(SlotName), Records = MoveTemp(Records), bForceFull, MaxDeltas, SnapshotMs]() mutable
+	{
+		FGAM312SaveResult Result = WriteCheckpoint(*SaveSlot, Records, bForceFull, MaxDeltas);
+		Result.SnapshotMs = SnapshotMs;
+		return Result;
+	});
+	return true;
+}
+
+bool UGAM312SaveSubsystem::Load(const FString& SlotName)
+{
+	if (GetWorld()->GetNetMode() == NM_Client)
+	{
+		return false;
+	}
+
+	if (IsBusy())
+	{
+		UE_LOG(LogGAM312Save, Warning, TEXT("Not loading %s, the previous save or load is still running"), *SlotName);
+		return false;
+	}
+
+	PendingLoad = Async(EAsyncExecution::ThreadPool, [LoadSlot = GetSlot(SlotName)]()
+	{
+		return ReadSlot(*LoadSlot);
+	});
+	return true;
+}
+
+void UGAM312SaveSubsystem::Tick(float DeltaTime)
+{
+	if (PendingSave.IsValid() && PendingSave.IsReady())
+	{
+		FinishSave(PendingSave.Consume());
+	}
+
+	if (PendingLoad.IsValid() && PendingLoad.IsReady())
+	{
+		FinishLoad(PendingLoad.Consume());
+	}
+
+	const float AutoInterval = CVarSaveAutoInterval.GetValueOnGameThread();
+	if (AutoInterval > 0.0f && GetWorld()->GetTimeSeconds() >= NextAutoSaveTime)
+	{
+		NextAutoSaveTime = GetWorld()->GetTimeSeconds() + AutoInterval;
+		Save(TEXT("Default"));
+	}
+}
+
+void UGAM312SaveSubsystem::FinishSave(const FGAM312SaveResult& Result)
+{
+	LastSaveResult = Result;
+	if (!Result.bSucceeded)
+	{
+		return;
+	}
+
+	UE_LOG(LogGAM312Save, Display, TEXT("Saved %s checkpoint: %d records, %lld bytes raw, %lld bytes on disk, snapshot %.3f ms, write %.2f ms"),
+		Result.bDelta ? TEXT("delta") : TEXT("base"), Result.NumRecords, Result.RawBytes, Result.FileBytes, Result.SnapshotMs, Result.WriteMs);
+}
+
+void UGAM312SaveSubsystem::FinishLoad(const FGAM312LoadResult& Result)
+{
+	// The records are only needed to apply them, the summary keeps the rest
+	LastLoadResult = FGAM312LoadResult();
+	LastLoadResult.bSucceeded = Result.bSucceeded;
+	LastLoadResult.NumFiles = Result.NumFiles;
+	LastLoadResult.FileBytes = Result.FileBytes;
+	LastLoadResult.ReadMs = Result.ReadMs;
+
+	if (!Result.bSucceeded)
+	{
+		UE_LOG(LogGAM312Save, Warning, TEXT("Nothing to load"));
+		return;
+	}
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	ApplyRecords(Result.Records);
+	LastLoadResult.ApplyMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	UE_LOG(LogGAM312Save, Display, TEXT("Loaded %d records from %d files (%lld bytes), read %.2f ms, apply %.2f ms"),
+		Result.Records.Num(), Result.NumFiles, Result.FileBytes, Result.ReadMs, LastLoadResult.ApplyMs);
+}
+
+void UGAM312SaveSubsystem::ApplyRecords(const TMap<uint64, FGAM312SaveRecord>& Records)
+{
+	int32 PlayerIndex = 0;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It, ++PlayerIndex)
+	{
+		APlayerController* PlayerController = It->Get();
+		AGAM312Character* Character = PlayerController ? Cast<AGAM312Character>(PlayerController->GetPawn()) : nullptr;
+		const FGAM312SaveRecord* Record = Records.Find(GetSaveId(FString::Printf(TEXT("Player%d"), PlayerIndex)));
+		if (Character && Record)
+		{
+			Character->Health = Record->Health;
+			Character->SetRespawnLocation(FVector(Record->Anchor));
+			Character->TeleportTo(FVector(Record->Location), Character->GetActorRotation(), false, true);
+		}
+	}
+
+	// Copied first, destroying an enemy removes it from Enemies
+	TArray<TPair<uint64, TWeakObjectPtr<AEnemy>>> EnemyList = Enemies.Array();
+	for (const TPair<uint64, TWeakObjectPtr<AEnemy>>& Pair : EnemyList)
+	{
+		AEnemy* Enemy = Pair.Value.Get();
+		const FGAM312SaveRecord* Record = Records.Find(Pair.Key);
+		if (Enemy == nullptr || Record == nullptr)
+		{
+			continue;
+		}
+
+		if (Record->Kind == EGAM312SaveKind::Destroyed)
+		{
+			Enemy->Destroy();
+			continue;
+		}
+
+		Enemy->Health = Record->Health;
+		Enemy->BaseLocation = FVector(Record->Anchor);
+		Enemy->TeleportTo(FVector(Record->Location), Enemy->GetActorRotation(), false, true);
+	}
+
+	// Cubes are not tracked while alive, look them up only if the save destroyed any
+	bool bHasDestroyed = false;
+	for (const TPair<uint64, FGAM312SaveRecord>& Pair : Records)
+	{
+		if (Pair.Value.Kind == EGAM312SaveKind::Destroyed)
+		{
+			DestroyedIds.Add(Pair.Key);
+			bHasDestroyed = true;
+		}
+	}
+
+	if (bHasDestroyed)
+	{
+		for (TActorIterator<ACube> It(GetWorld()); It; ++It)
+		{
+			if (DestroyedIds.Contains(GetSaveId(*It)))
+			{
+				It->Destroy();
+			}
+		}
+	}
+}
+
+void UGAM312SaveSubsystem::FlushPendingWork()
+{
+	if (PendingSave.IsValid())
+	{
+		PendingSave.Wait();
+		FinishSave(PendingSave.Consume());
+	}
+	if (PendingLoad.IsValid())
+	{
+		PendingLoad.Wait();
+		FinishLoad(PendingLoad.Consume());
+	}
+}
+
+void UGAM312SaveSubsystem::RunBenchmark()
+{
+	FlushPendingWork();
+
+	UE_LOG(LogGAM312Save, Display, TEXT("Save benchmark with %d entities"), GetNumEntities());
+
+	// Each step waits for its background work so the timings do not overlap
+	if (Save(TEXT("Benchmark"), true))
+	{
+		FlushPendingWork();
+	}
+
+	if (Save(TEXT("Benchmark")))
+	{
+		FlushPendingWork();
+	}
+
+	if (Load(TEXT("Benchmark")))
+	{
+		FlushPendingWork();
+	}
+}
@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Async/Future.h"
+#include "GAM312SaveSubsystem.generated.h"
+
+class AEnemy;
+
+// What a save record describes
+enum class EGAM312SaveKind : uint8
+{
+	Player,
+	Enemy,
+
+	// A placed enemy or cube that was destroyed, only the id is stored
+	Destroyed
+};
+
+// Saved state of one entity, identified by a hash of its path with the PIE prefix removed
+struct FGAM312SaveRecord
+{
+	uint64 Id = 0;
+	EGAM312SaveKind Kind = EGAM312SaveKind::Destroyed;
+	float Health = 0.0f;
+	FVector3f Location = FVector3f::ZeroVector;
+
+	// Respawn location for players, base location for enemies
+	FVector3f Anchor = FVector3f::ZeroVector;
+
+	bool operator==(const FGAM312SaveRecord& Other) const
+	{
+		return Id == Other.Id && Kind == Other.Kind && Health == Other.Health && Location == Other.Location && Anchor == Other.Anchor;
+	}
+
+	bool operator!=(const FGAM312SaveRecord& Other) const
+	{
+		return !(*this == Other);
+	}
+
+	friend FArchive& operator<<(FArchive& Ar, FGAM312SaveRecord& Record);
+};
+
+// Checkpoint state shared with the thread writing or reading it, only one of them runs at a time
+struct FGAM312SaveSlot
+{
+	FString Name;
+	FString Directory;
+
+	// Every record as of the last checkpoint written or loaded, deltas only hold what differs from it
+	TMap<uint64, FGAM312SaveRecord> Baseline;
+
+	// Identifies the base file, deltas written against another base are ignored on load
+	uint32 BaseId = 0;
+	int32 NumDeltas = 0;
+};
+
+// Outcome of a background save, reported on the game thread
+struct FGAM312SaveResult
+{
+	bool bSucceeded = false;
+	bool bDelta = false;
+	int32 NumRecords = 0;
+	int64 RawBytes = 0;
+	int64 FileBytes = 0;
+	double SnapshotMs = 0.0;
+	double WriteMs = 0.0;
+};
+
+// Outcome of a background load, applied on the game thread
+struct FGAM312LoadResult
+{
+	bool bSucceeded = false;
+	TMap<uint64, FGAM312SaveRecord> Records;
+	int32 NumFiles = 0;
+	int64 FileBytes = 0;
+	double ReadMs = 0.0;
+
+	// Filled in on the game thread once the records are applied
+	double ApplyMs = 0.0;
+};
+
+/**
+ * Saves player health and respawn location, enemy health and base location, and which placed enemies
+ * and cubes were destroyed. A save copies that state into flat records on the game thread and hands
+ * them to the thread pool, which compares them with the last checkpoint, compresses them and writes
+ * them to Saved/SaveGames/GAM312/<Slot>. The first save and every gam.Save.MaxDeltas saves after it
+ * write a full Base.sav; the saves in between write a Delta_N.sav with only the records that changed.
+ * Loading memory maps the base and its deltas, merges them in the background and applies the result
+ * on the game thread. Enemies spawned at runtime get new names each session, so only placed enemies
+ * come back from another session.
+ *
+ * Files start with a small uncompressed header holding a magic number and a format version, so
+ * older builds refuse files they cannot read.
+ *
+ * Console:
+ *   gam.Save [Slot]        write a checkpoint
+ *   gam.Load [Slot]        load the base and deltas of a slot
+ *   gam.Save.Benchmark     time a full save, a delta save and a load of the current world, for
+ *                          example after gam.Stress.SpawnWolves 10000 in a -nullrhi run
+ */
+UCLASS()
+class GAM312_API UGAM312SaveSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Snapshots the world and writes it in the background, returns false if a save or load is still running
+	bool Save(const FString& SlotName, bool bForceFull = false);
+
+	// Reads a slot in the background and applies it once read, returns false if a save or load is still running
+	bool Load(const FString& SlotName);
+
+	// Runs a full save, a delta save and a load back to back and logs their timings
+	void RunBenchmark();
+
+	// Waits for a save or load in flight and reports it, so the next step does not overlap it
+	void FlushPendingWork();
+
+	int32 GetNumEntities() const { return Enemies.Num() + DestroyedIds.Num(); }
+
+	// Outcome of the last finished save, and of the last finished load without its records
+	const FGAM312SaveResult& GetLastSaveResult() const { return LastSaveResult; }
+	const FGAM312LoadResult& GetLastLoadResult() const { return LastLoadResult; }
+
+	// Directory a slot's base and deltas are written to
+	static FString GetSlotDirectory(const FString& SlotName);
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	void OnActorSpawned(AActor* Actor);
+	void OnActorDestroyed(AActor* Actor);
+	void RegisterEnemy(AEnemy* Enemy);
+
+	// Copies the saved state of every entity into Records
+	void Snapshot(TArray<FGAM312SaveRecord>& Records) const;
+
+	// Puts the loaded state back on the entities in the world
+	void ApplyRecords(const TMap<uint64, FGAM312SaveRecord>& Records);
+
+	// Report finished background work, called from Tick or straight after waiting on it
+	void FinishSave(const FGAM312SaveResult& Result);
+	void FinishLoad(const FGAM312LoadResult& Result);
+
+	// Keeps the slot state when the same slot is saved again, so its deltas chain
+	TSharedRef<FGAM312SaveSlot> GetSlot(const FString& SlotName);
+
+	bool IsBusy() const;
+
+	static uint64 GetSaveId(const FString& Name);
+	static uint64 GetSaveId(const AActor* Actor);
+
+	// Enemies in the world by save id
+	TMap<uint64, TWeakObjectPtr<AEnemy>> Enemies;
+
+	// Placed enemies and cubes destroyed this session or in the loaded save
+	TSet<uint64> DestroyedIds;
+
+	TSharedPtr<FGAM312SaveSlot> Slot;
+
+	TFuture<FGAM312SaveResult> PendingSave;
+	TFuture<FGAM312LoadResult> PendingLoad;
+
+	// Size of the last snapshot, so the next one allocates once
+	int32 LastNumRecords = 0;
+
+	FGAM312SaveResult LastSaveResult;
+	FGAM312LoadResult LastLoadResult;
+
+	double NextAutoSaveTime = 0.0;
+
+	FDelegateHandle ActorSpawnedHandle;
+	FDelegateHandle ActorDestroyedHandle;
+};
@@ -0,0 +1,316 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312ScatterComponent.h"
+#include "GAM312Stats.h"
+#include "Async/Async.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Scatter, Log, All);
+
+// Rule values the worker threads need, copied so they never touch the component
+struct FGAM312ScatterRuleParams
+{
+	float Density;
+	FVector2D ScaleRange;
+};
+
+// Sets default values for this component's properties
+UGAM312ScatterComponent::UGAM312ScatterComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+}
+
+// Called when the game starts
+void UGAM312ScatterComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Scatter is only for looking at
+	if (GetNetMode() == NM_DedicatedServer)
+	{
+		SetComponentTickEnabled(false);
+		return;
+	}
+
+	FreeMeshes.SetNum(Rules.Num());
+
+	// Scattered meshes have no collision, so the traces only ever see the ground
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(ScatterTrace), false, GetOwner());
+	ObjectQueryParams = FCollisionObjectQueryParams(TraceObjectType);
+}
+
+void UGAM312ScatterComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (TPair<FIntPoint, TUniquePtr<FScatterTile>>& Pair : Tiles)
+	{
+		ReleaseTile(*Pair.Value);
+	}
+	Tiles.Reset();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UGAM312ScatterComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (Rules.Num() == 0 || TileSize <= 0.0f)
+	{
+		return;
+	}
+
+	// Tiles within range of any player
+	TSet<FIntPoint> Wanted;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		const FVector Location = Pawn->GetActorLocation();
+		const FIntPoint Center(FMath::FloorToInt(Location.X / TileSize), FMath::FloorToInt(Location.Y / TileSize));
+		for (int32 Y = -TileRadius; Y <= TileRadius; ++Y)
+		{
+			for (int32 X = -TileRadius; X <= TileRadius; ++X)
+			{
+				Wanted.Add(Center + FIntPoint(X, Y));
+			}
+		}
+	}
+
+	// Tiles are kept one ring past the range so walking along a tile edge does not rebuild it
+	for (auto It = Tiles.CreateIterator(); It; ++It)
+	{
+		bool bNearWanted = false;
+		for (int32 Y = -1; Y <= 1 && !bNearWanted; ++Y)
+		{
+			for (int32 X = -1; X <= 1 && !bNearWanted; ++X)
+			{
+				bNearWanted = Wanted.Contains(It.Key() + FIntPoint(X, Y));
+			}
+		}
+
+		if (!bNearWanted)
+		{
+			ReleaseTile(*It.Value());
+			It.RemoveCurrent();
+		}
+	}
+
+	for (const FIntPoint& Coord : Wanted)
+	{
+		if (!Tiles.Contains(Coord))
+		{
+			StartTile(Coord);
+		}
+	}
+
+	// Advance every tile within this frame's trace and upload budgets
+	int32 TraceBudget = MaxTracesPerFrame;
+	int32 InstanceBudget = MaxInstancesPerFrame;
+	for (TPair<FIntPoint, TUniquePtr<FScatterTile>>& Pair : Tiles)
+	{
+		FScatterTile& Tile = *Pair.Value;
+
+		if (Tile.State == ETileState::Generating && Tile.Generation.IsReady())
+		{
+			Tile.Candidates = Tile.Generation.Consume();
+			Tile.State = ETileState::Tracing;
+		}
+
+		if (Tile.State == ETileState::Tracing)
+		{
+			TraceBudget -= TraceTile(Tile, TraceBudget);
+		}
+
+		if ((Tile.State == ETileState::Tracing || Tile.State == ETileState::Uploading) && InstanceBudget > 0)
+		{
+			InstanceBudget -= UploadTile(Pair.Key, Tile, InstanceBudget);
+		}
+	}
+
+	GAM312Stats::SetGauge(TEXT("Scatter.Tiles"), Tiles.Num());
+	GAM312Stats::SetGauge(TEXT("Scatter.Instances"), NumInstances);
+}
+
+void UGAM312ScatterComponent::StartTile(const FIntPoint& Coord)
+{
+	TUniquePtr<FScatterTile>& Tile = Tiles.Add(Coord, MakeUnique<FScatterTile>());
+	Tile->Transforms.SetNum(Rules.Num());
+	Tile->Uploaded.SetNumZeroed(Rules.Num());
+	Tile->Meshes.SetNumZeroed(Rules.Num());
+
+	TArray<FGAM312ScatterRuleParams> RuleParams;
+	for (const FGAM312ScatterRule& Rule : Rules)
+	{
+		RuleParams.Add({ Rule.Mesh ? Rule.Density : 0.0f, Rule.ScaleRange });
+	}
+
+	// Seeded per tile, so a tile comes back the same every time it is generated
+	const int32 TileSeed = (int32)HashCombine(GetTypeHash(Seed), GetTypeHash(Coord));
+	const FVector2D Origin(Coord.X * TileSize, Coord.Y * TileSize);
+	const float Size = TileSize;
+
+	Tile->Generation = Async(EAsyncExecution::ThreadPool, [RuleParams = MoveTemp(RuleParams), TileSeed, Origin, Size]()
+	{
+		FRandomStream Random(TileSeed);
+		const float AreaSquareMeters = FMath::Square(Size / 100.0f);
+
+		TArray<FGAM312ScatterCandidate> Candidates;
+		for (int32 RuleIndex = 0; RuleIndex < RuleParams.Num(); ++RuleIndex)
+		{
+			const FGAM312ScatterRuleParams& Rule = RuleParams[RuleIndex];
+			const int32 Count = FMath::FloorToInt(Rule.Density * AreaSquareMeters);
+			Candidates.Reserve(Candidates.Num() + Count);
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				FGAM312ScatterCandidate& Candidate = Candidates.AddDefaulted_GetRef();
+				Candidate.Location = Origin + FVector2D(Random.FRand() * Size, Random.FRand() * Size);
+				Candidate.Scale = Random.FRandRange(Rule.ScaleRange.X, Rule.ScaleRange.Y);
+				Candidate.Yaw = Random.FRand() * 360.0f;
+				Candidate.Rule = RuleIndex;
+			}
+		}
+		return Candidates;
+	});
+}
+
+int32 UGAM312ScatterComponent::TraceTile(FScatterTile& Tile, int32 TraceBudget)
+{
+	UWorld* World = GetWorld();
+
+	// Results of the traces started last frame
+	FTraceDatum Datum;
+	for (int32 Index = Tile.PendingTraces.Num() - 1; Index >= 0; --Index)
+	{
+		const FPendingTrace& Pending = Tile.PendingTraces[Index];
+		if (!World->QueryTraceData(Pending.Handle, Datum))
+		{
+			// Not read in time, the result is gone and the candidate is traced again
+			if (GFrameCounter > Pending.IssueFrame + 1)
+			{
+				Tile.RetryCandidates.Add(Pending.Candidate);
+				Tile.PendingTraces.RemoveAtSwap(Index, 1, false);
+			}
+			continue;
+		}
+
+		const FGAM312ScatterCandidate& Candidate = Tile.Candidates[Pending.Candidate];
+		const FGAM312ScatterRule& Rule = Rules[Candidate.Rule];
+		if (Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit && Datum.OutHits[0].ImpactNormal.Z >= FMath::Cos(FMath::DegreesToRadians(Rule.MaxSlope)))
+		{
+			const FHitResult& Hit = Datum.OutHits[0];
+			const FQuat Yaw(FVector::UpVector, FMath::DegreesToRadians(Candidate.Yaw));
+			const FQuat Rotation = Rule.bAlignToGround ? FQuat::FindBetweenNormals(FVector::UpVector, Hit.ImpactNormal) * Yaw : Yaw;
+			Tile.Transforms[Candidate.Rule].Emplace(Rotation, Hit.ImpactPoint, FVector(Candidate.Scale));
+		}
+		Tile.PendingTraces.RemoveAtSwap(Index, 1, false);
+	}
+
+	// Start the next batch, expired candidates first
+	const float TopZ = GetOwner()->GetActorLocation().Z + TraceHalfHeight;
+	const float BottomZ = GetOwner()->GetActorLocation().Z - TraceHalfHeight;
+	int32 Started = 0;
+	while (Started < TraceBudget && (Tile.RetryCandidates.Num() > 0 || Tile.NextCandidate < Tile.Candidates.Num()))
+	{
+		const int32 CandidateIndex = Tile.RetryCandidates.Num() > 0 ? Tile.RetryCandidates.Pop(false) : Tile.NextCandidate++;
+		const FVector2D Location = Tile.Candidates[CandidateIndex].Location;
+		const FTraceHandle Handle = World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, FVector(Location, TopZ), FVector(Location, BottomZ), ObjectQueryParams, QueryParams);
+		Tile.PendingTraces.Add({ CandidateIndex, Handle, GFrameCounter });
+		++Started;
+	}
+
+	if (Tile.NextCandidate >= Tile.Candidates.Num() && Tile.PendingTraces.Num() == 0 && Tile.RetryCandidates.Num() == 0)
+	{
+		Tile.State = ETileState::Uploading;
+		Tile.Candidates.Empty();
+	}
+
+	return Started;
+}
+
+int32 UGAM312ScatterComponent::UploadTile(const FIntPoint& Coord, FScatterTile& Tile, int32 InstanceBudget)
+{
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_ScatterUpload);
+
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	int32 Added = 0;
+	bool bAllUploaded = true;
+	for (int32 RuleIndex = 0; RuleIndex < Rules.Num(); ++RuleIndex)
+	{
+		const TArray<FTransform>& Placed = Tile.Transforms[RuleIndex];
+		const int32 Count = FMath::Min(Placed.Num() - Tile.Uploaded[RuleIndex], InstanceBudget - Added);
+		if (Count > 0)
+		{
+			if (Tile.Meshes[RuleIndex] == nullptr)
+			{
+				Tile.Meshes[RuleIndex] = AcquireMesh(RuleIndex);
+			}
+
+			TArray<FTransform> Batch(Placed.GetData() + Tile.Uploaded[RuleIndex], Count);
+			Tile.Meshes[RuleIndex]->AddInstances(Batch, false, true);
+			Tile.Uploaded[RuleIndex] += Count;
+			Added += Count;
+		}
+		bAllUploaded &= Tile.Uploaded[RuleIndex] == Placed.Num();
+	}
+
+	Tile.NumInstances += Added;
+	NumInstances += Added;
+	Tile.UploadCycles += FPlatformTime::Cycles64() - StartCycles;
+
+	if (Tile.State == ETileState::Uploading && bAllUploaded)
+	{
+		Tile.State = ETileState::Done;
+		Tile.Transforms.Empty();
+
+		UE_LOG(LogGAM312Scatter, Verbose, TEXT("Tile %s placed %d instances, %.3f ms upload"), *Coord.ToString(), Tile.NumInstances, FPlatformTime::ToMilliseconds64(Tile.UploadCycles));
+		CSV_CUSTOM_STAT(GAM312, ScatterTileUploadMs, (float)FPlatformTime::ToMilliseconds64(Tile.UploadCycles), ECsvCustomStatOp::Max);
+	}
+
+	return Added;
+}
+
+UHierarchicalInstancedStaticMeshComponent* UGAM312ScatterComponent::AcquireMesh(int32 RuleIndex)
+{
+	if (FreeMeshes[RuleIndex].Num() > 0)
+	{
+		return FreeMeshes[RuleIndex].Pop(false);
+	}
+
+	const FGAM312ScatterRule& Rule = Rules[RuleIndex];
+	UHierarchicalInstancedStaticMeshComponent* Mesh = NewObject<UHierarchicalInstancedStaticMeshComponent>(GetOwner());
+	Mesh->SetStaticMesh(Rule.Mesh);
+	Mesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Mesh->SetCanEverAffectNavigation(false);
+	Mesh->SetCastShadow(false);
+	Mesh->SetCullDistances(0, FMath::RoundToInt(Rule.CullDistance));
+	Mesh->RegisterComponent();
+
+	AllMeshes.Add(Mesh);
+	return Mesh;
+}
+
+void UGAM312ScatterComponent::ReleaseTile(FScatterTile& Tile)
+{
+	for (int32 RuleIndex = 0; RuleIndex < Tile.Meshes.Num(); ++RuleIndex)
+	{
+		if (UHierarchicalInstancedStaticMeshComponent* Mesh = Tile.Meshes[RuleIndex])
+		{
+			Mesh->ClearInstances();
+			FreeMeshes[RuleIndex].Add(Mesh);
+		}
+	}
+
+	NumInstances -= Tile.NumInstances;
+}
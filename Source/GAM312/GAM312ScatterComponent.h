@@ -0,0 +1,183 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Async/Future.h"
+#include "WorldCollision.h"
+#include "GAM312ScatterComponent.generated.h"
+
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMesh;
+
+// One kind of grass or small foliage to scatter
+USTRUCT(BlueprintType)
+struct FGAM312ScatterRule
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	UStaticMesh* Mesh = nullptr;
+
+	// Instances per square meter
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Density = 0.5f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector2D ScaleRange = FVector2D(0.8f, 1.2f);
+
+	// Steepest ground in degrees an instance is placed on
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxSlope = 30.0f;
+
+	// Tilt instances to follow the ground instead of standing upright
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bAlignToGround = true;
+
+	// Distance at which instances stop drawing, 0 never culls
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CullDistance = 6000.0f;
+};
+
+// A candidate instance generated on a worker thread, placed on the ground by a trace
+struct FGAM312ScatterCandidate
+{
+	FVector2D Location;
+	float Scale;
+	float Yaw;
+	int32 Rule;
+};
+
+/**
+ * Scatters grass and small foliage around the players at runtime instead of painting it into the
+ * maps. The world is split into square tiles; each tile in range gets its candidates from the rules
+ * and a seed on a worker thread, is placed on the ground with async traces, and is uploaded into
+ * pooled hierarchical instanced meshes at most MaxInstancesPerFrame instances a frame. Tiles that
+ * leave range give their meshes back to the pool.
+ *
+ * The same seed gives the same scatter every run. Instance and tile counts are published as
+ * Scatter.* gauges, and each finished tile logs its instance count and game thread upload time.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GAM312_API UGAM312ScatterComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UGAM312ScatterComponent();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	TArray<FGAM312ScatterRule> Rules;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	int32 Seed = 312;
+
+	// Width of a tile
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	float TileSize = 2000.0f;
+
+	// Tiles kept around a player in each direction
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	int32 TileRadius = 3;
+
+	// Ground traces start this far above and end this far below the owner
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	float TraceHalfHeight = 20000.0f;
+
+	// Object type the ground traces hit, so pawns and simulating bodies standing on the ground never get foliage
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	TEnumAsByte<ECollisionChannel> TraceObjectType = ECC_WorldStatic;
+
+	// Ground traces started per frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	int32 MaxTracesPerFrame = 2000;
+
+	// Instances added to the meshes per frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Scatter")
+	int32 MaxInstancesPerFrame = 2000;
+
+	// Instances currently placed
+	int32 GetNumInstances() const { return NumInstances; }
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+	// Gives every tile's meshes back when play ends
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+public:
+	// Starts, advances and releases tiles around the players
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	enum class ETileState : uint8
+	{
+		Generating,
+		Tracing,
+		Uploading,
+		Done
+	};
+
+	struct FPendingTrace
+	{
+		int32 Candidate;
+		FTraceHandle Handle;
+
+		// Async trace results are only kept for the frame after the one they were started in
+		uint64 IssueFrame;
+	};
+
+	struct FScatterTile
+	{
+		ETileState State = ETileState::Generating;
+		TFuture<TArray<FGAM312ScatterCandidate>> Generation;
+		TArray<FGAM312ScatterCandidate> Candidates;
+
+		// Next candidate to trace, the traces waiting for results and candidates whose results expired
+		int32 NextCandidate = 0;
+		TArray<FPendingTrace> PendingTraces;
+		TArray<int32> RetryCandidates;
+
+		// Placed transforms per rule and how many of them are uploaded
+		TArray<TArray<FTransform>> Transforms;
+		TArray<int32> Uploaded;
+
+		// Mesh per rule, taken from the pool when the first instance is uploaded
+		TArray<UHierarchicalInstancedStaticMeshComponent*> Meshes;
+
+		int32 NumInstances = 0;
+		uint64 UploadCycles = 0;
+	};
+
+	// Starts generating a tile's candidates on a worker thread
+	void StartTile(const FIntPoint& Coord);
+
+	// Gives a tile's meshes back to the pool
+	void ReleaseTile(FScatterTile& Tile);
+
+	// Reads last frame's trace results and starts the next batch, returns the traces started
+	int32 TraceTile(FScatterTile& Tile, int32 TraceBudget);
+
+	// Adds placed instances to the tile's meshes, returns the instances added
+	int32 UploadTile(const FIntPoint& Coord, FScatterTile& Tile, int32 InstanceBudget);
+
+	UHierarchicalInstancedStaticMeshComponent* AcquireMesh(int32 RuleIndex);
+
+	TMap<FIntPoint, TUniquePtr<FScatterTile>> Tiles;
+
+	// Free meshes per rule
+	TArray<TArray<UHierarchicalInstancedStaticMeshComponent*>> FreeMeshes;
+
+	// Keeps every pooled mesh alive
+	UPROPERTY(Transient)
+	TArray<UHierarchicalInstancedStaticMeshComponent*> AllMeshes;
+
+	// Built once and reused for every ground trace
+	FCollisionQueryParams QueryParams;
+	FCollisionObjectQueryParams ObjectQueryParams;
+
+	int32 NumInstances = 0;
+};
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312Stats.h"
+
+DEFINE_STAT(STAT_GAM312_EnemyTick);
+DEFINE_STAT(STAT_GAM312_EnemyOnSensed);
+DEFINE_STAT(STAT_GAM312_EnemyAttackPlayer);
+DEFINE_STAT(STAT_GAM312_WeaponFire);
+DEFINE_STAT(STAT_GAM312_CubeHit);
+DEFINE_STAT(STAT_GAM312_ProjectileHit);
+DEFINE_STAT(STAT_GAM312_CharacterDamage);
+DEFINE_STAT(STAT_GAM312_CharacterRespawn);
+DEFINE_STAT(STAT_GAM312_AudioPlay);
+DEFINE_STAT(STAT_GAM312_ScatterUpload);
+DEFINE_STAT(STAT_GAM312_SaveSnapshot);
+
+DEFINE_STAT(STAT_GAM312_LiveEnemies);
+DEFINE_STAT(STAT_GAM312_InFlightProjectiles);
+DEFINE_STAT(STAT_GAM312_LivePickups);
+DEFINE_STAT(STAT_GAM312_Hits);
+DEFINE_STAT(STAT_GAM312_DamageEvents);
+DEFINE_STAT(STAT_GAM312_DamageFlashes);
+DEFINE_STAT(STAT_GAM312_SoundsDropped);
+DEFINE_STAT(STAT_GAM312_UnloadedCellEntries);
+
+LLM_DEFINE_TAG(GAM312);
+LLM_DEFINE_TAG(GAM312_Enemies);
+LLM_DEFINE_TAG(GAM312_Projectiles);
+LLM_DEFINE_TAG(GAM312_Cubes);
+LLM_DEFINE_TAG(GAM312_Player);
+LLM_DEFINE_TAG(GAM312_Subsystems);
+
+UE_TRACE_CHANNEL_DEFINE(GAM312Channel);
+
+CSV_DEFINE_CATEGORY_MODULE(GAM312_API, GAM312, true);
+
+namespace GAM312Stats
+{
+	// Gameplay code only changes these on the game thread
+	static int32 LiveEnemies = 0;
+	static int32 InFlightProjectiles = 0;
+	static int32 LivePickups = 0;
+	static TMap<FName, FGauge> Gauges;
+
+	void AddLiveEnemies(int32 Delta)
+	{
+		LiveEnemies += Delta;
+		SET_DWORD_STAT(STAT_GAM312_LiveEnemies, LiveEnemies);
+	}
+
+	void AddInFlightProjectiles(int32 Delta)
+	{
+		InFlightProjectiles += Delta;
+		SET_DWORD_STAT(STAT_GAM312_InFlightProjectiles, InFlightProjectiles);
+	}
+
+	void AddLivePickups(int32 Delta)
+	{
+		LivePickups += Delta;
+		SET_DWORD_STAT(STAT_GAM312_LivePickups, LivePickups);
+	}
+
+	void AddHit()
+	{
+		INC_DWORD_STAT(STAT_GAM312_Hits);
+		CSV_CUSTOM_STAT(GAM312, Hits, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void AddDamageEvent()
+	{
+		INC_DWORD_STAT(STAT_GAM312_DamageEvents);
+		CSV_CUSTOM_STAT(GAM312, DamageEvents, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void AddDamageFlash()
+	{
+		INC_DWORD_STAT(STAT_GAM312_DamageFlashes);
+		CSV_CUSTOM_STAT(GAM312, DamageFlashes, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void AddDroppedSound()
+	{
+		INC_DWORD_STAT(STAT_GAM312_SoundsDropped);
+		CSV_CUSTOM_STAT(GAM312, SoundsDropped, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void AddUnloadedCellEntry()
+	{
+		INC_DWORD_STAT(STAT_GAM312_UnloadedCellEntries);
+		CSV_CUSTOM_STAT(GAM312, UnloadedCellEntries, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	int32 GetLiveEnemies()
+	{
+		return LiveEnemies;
+	}
+
+	int32 GetInFlightProjectiles()
+	{
+		return InFlightProjectiles;
+	}
+
+	int32 GetLivePickups()
+	{
+		return LivePickups;
+	}
+
+	void SetGauge(FName Name, int32 Value, int32 Capacity)
+	{
+		FGauge& Gauge = Gauges.FindOrAdd(Name);
+		Gauge.Value = Value;
+		Gauge.Capacity = Capacity;
+	}
+
+	const TMap<FName, FGauge>& GetGauges()
+	{
+		return Gauges;
+	}
+
+	void RecordFrameCounts()
+	{
+		CSV_CUSTOM_STAT(GAM312, LiveEnemies, LiveEnemies, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(GAM312, InFlightProjectiles, InFlightProjectiles, ECsvCustomStatOp::Set);
+		CSV_CUSTOM_STAT(GAM312, LivePickups, LivePickups, ECsvCustomStatOp::Set);
+	}
+}
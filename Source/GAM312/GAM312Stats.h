@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Trace/Trace.h"
+
+// Shown in game with "stat GAM312"
+DECLARE_STATS_GROUP(TEXT("GAM312"), STATGROUP_GAM312, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy Tick"), STAT_GAM312_EnemyTick, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy OnSensed"), STAT_GAM312_EnemyOnSensed, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Enemy AttackPlayer"), STAT_GAM312_EnemyAttackPlayer, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Weapon Fire"), STAT_GAM312_WeaponFire, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cube OnComponentHit"), STAT_GAM312_CubeHit, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Projectile OnHit"), STAT_GAM312_ProjectileHit, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character DealDamage"), STAT_GAM312_CharacterDamage, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Respawn"), STAT_GAM312_CharacterRespawn, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Audio PlaySound"), STAT_GAM312_AudioPlay, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Scatter Upload"), STAT_GAM312_ScatterUpload, STATGROUP_GAM312, GAM312_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Save Snapshot"), STAT_GAM312_SaveSnapshot, STATGROUP_GAM312, GAM312_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Enemies"), STAT_GAM312_LiveEnemies, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("In Flight Projectiles"), STAT_GAM312_InFlightProjectiles, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Live Pickups"), STAT_GAM312_LivePickups, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Hits"), STAT_GAM312_Hits, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Unloaded Cell Entries"), STAT_GAM312_UnloadedCellEntries, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Events"), STAT_GAM312_DamageEvents, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Damage Flashes"), STAT_GAM312_DamageFlashes, STATGROUP_GAM312, GAM312_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Sounds Dropped"), STAT_GAM312_SoundsDropped, STATGROUP_GAM312, GAM312_API);
+
+// Insights channel for the gameplay scopes, enabled with -trace=cpu,GAM312
+UE_TRACE_CHANNEL_EXTERN(GAM312Channel, GAM312_API);
+
+// CSV category for the gameplay timings and counts, included in every csvprofile capture
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(GAM312_API, GAM312);
+
+// Low level memory tags, shown under GAM312 in "stat LLMFULL" and -llmcsv captures
+LLM_DECLARE_TAG_API(GAM312, GAM312_API);
+LLM_DECLARE_TAG_API(GAM312_Enemies, GAM312_API);
+LLM_DECLARE_TAG_API(GAM312_Projectiles, GAM312_API);
+LLM_DECLARE_TAG_API(GAM312_Cubes, GAM312_API);
+LLM_DECLARE_TAG_API(GAM312_Player, GAM312_API);
+LLM_DECLARE_TAG_API(GAM312_Subsystems, GAM312_API);
+
+// Times the enclosing block in the GAM312 stat group, the GAM312 trace channel and the GAM312 CSV category
+#define GAM312_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, GAM312Channel); \
+	CSV_SCOPED_TIMING_STAT(GAM312, Stat)
+
+namespace GAM312Stats
+{
+	// Current value of a named gauge, such as the population of a tick bucket or the occupancy of a pool
+	struct FGauge
+	{
+		int32 Value = 0;
+
+		// 0 when the gauge has no upper limit
+		int32 Capacity = 0;
+	};
+
+	// Gameplay counts, kept outside the stats system so CSV captures get them in any build
+	GAM312_API void AddLiveEnemies(int32 Delta);
+	GAM312_API void AddInFlightProjectiles(int32 Delta);
+	GAM312_API void AddLivePickups(int32 Delta);
+	GAM312_API void AddHit();
+	GAM312_API void AddDamageEvent();
+
+	// A damage flash was written to custom data, each one is a single render data update
+	GAM312_API void AddDamageFlash();
+
+	// A gameplay sound was culled by distance or by its category's voice budget
+	GAM312_API void AddDroppedSound();
+
+	// A player stood in a World Partition cell that had not finished loading
+	GAM312_API void AddUnloadedCellEntry();
+
+	GAM312_API int32 GetLiveEnemies();
+	GAM312_API int32 GetInFlightProjectiles();
+	GAM312_API int32 GetLivePickups();
+
+	// Sets a gauge, systems update their own gauges when their population changes
+	GAM312_API void SetGauge(FName Name, int32 Value, int32 Capacity = 0);
+	GAM312_API const TMap<FName, FGauge>& GetGauges();
+
+	// Writes the live counts to the CSV profiler, called once per frame
+	GAM312_API void RecordFrameCounts();
+}
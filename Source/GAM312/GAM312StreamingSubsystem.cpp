@@ -0,0 +1,343 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312StreamingSubsystem.h"
+#include "GAM312Stats.h"
+#include "Algo/StableSort.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "WorldPartition/WorldPartitionSubsystem.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Streaming, Log, All);
+
+static TAutoConsoleVariable<float> CVarStreamingLookAheadSeconds(
+	TEXT("gam.Streaming.LookAheadSeconds"),
+	1.5f,
+	TEXT("How far ahead of a moving player, in seconds of travel, the velocity source is placed."));
+
+static TAutoConsoleVariable<float> CVarStreamingMinSpeed(
+	TEXT("gam.Streaming.MinSpeed"),
+	300.0f,
+	TEXT("Speed in cm/s below which a player gets no velocity source."));
+
+static TAutoConsoleVariable<float> CVarStreamingMoveThreshold(
+	TEXT("gam.Streaming.MoveThreshold"),
+	800.0f,
+	TEXT("Distance a wanted source must drift from its current position before the source is moved."));
+
+static TAutoConsoleVariable<int32> CVarStreamingMaxChangesPerFrame(
+	TEXT("gam.Streaming.MaxChangesPerFrame"),
+	2,
+	TEXT("Look-ahead sources that may be added, moved or removed each frame."));
+
+static TAutoConsoleVariable<int32> CVarStreamingMaxCellActivationsPerSecond(
+	TEXT("gam.Streaming.MaxCellActivationsPerSecond"),
+	8,
+	TEXT("Cells activated over the last second above which look-ahead sources are not added or moved, 0 for no limit."));
+
+static TAutoConsoleVariable<float> CVarStreamingCellCheckInterval(
+	TEXT("gam.Streaming.CellCheckInterval"),
+	0.1f,
+	TEXT("Seconds between checks for players standing in cells that have not finished loading."));
+
+// Enough for a prefetch location, a velocity source and a camera source for a few players
+static constexpr int32 MaxLookAheadSources = 8;
+
+bool FGAM312LookAheadSource::GetStreamingSource(FWorldPartitionStreamingSource& OutStreamingSource)
+{
+	if (!bActive)
+	{
+		return false;
+	}
+
+	OutStreamingSource = Source;
+	return true;
+}
+
+bool UGAM312StreamingSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+TStatId UGAM312StreamingSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312StreamingSubsystem, STATGROUP_Tickables);
+}
+
+void UGAM312StreamingSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	Super::OnWorldBeginPlay(InWorld);
+
+	UWorldPartitionSubsystem* WorldPartition = InWorld.GetSubsystem<UWorldPartitionSubsystem>();
+	bHasWorldPartition = WorldPartition != nullptr && InWorld.GetWorldPartition() != nullptr;
+	if (!bHasWorldPartition)
+	{
+		return;
+	}
+
+	FWorldDelegates::LevelAddedToWorld.AddUObject(this, &UGAM312StreamingSubsystem::OnLevelAddedToWorld);
+	FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &UGAM312StreamingSubsystem::OnLevelRemovedFromWorld);
+
+	// Register the whole pool once, unused sources just report nothing
+	for (int32 Index = 0; Index < MaxLookAheadSources; ++Index)
+	{
+		TUniquePtr<FGAM312LookAheadSource>& LookAhead = Sources.Add_GetRef(MakeUnique<FGAM312LookAheadSource>());
+		LookAhead->Source.Name = FName(TEXT("GAM312LookAhead"), Index);
+		LookAhead->Source.TargetState = EStreamingSourceTargetState::Activated;
+		LookAhead->Source.bBlockOnSlowLoading = false;
+		WorldPartition->RegisterStreamingSourceProvider(LookAhead.Get());
+	}
+}
+
+void UGAM312StreamingSubsystem::Deinitialize()
+{
+	FWorldDelegates::LevelAddedToWorld.RemoveAll(this);
+	FWorldDelegates::LevelRemovedFromWorld.RemoveAll(this);
+
+	if (UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>())
+	{
+		for (const TUniquePtr<FGAM312LookAheadSource>& LookAhead : Sources)
+		{
+			WorldPartition->UnregisterStreamingSourceProvider(LookAhead.Get());
+		}
+	}
+	Sources.Reset();
+
+	Super::Deinitialize();
+}
+
+void UGAM312StreamingSubsystem::AddPrefetchLocation(const FVector& Location, float Duration, EStreamingSourcePriority Priority)
+{
+	const double ExpireTime = GetWorld()->GetTimeSeconds() + Duration;
+
+	// Refresh a location that is already being prefetched instead of adding a second source for it
+	for (FPrefetchLocation& Prefetch : PrefetchLocations)
+	{
+		if (FVector::DistSquared(Prefetch.Location, Location) < FMath::Square(CVarStreamingMoveThreshold.GetValueOnGameThread()))
+		{
+			Prefetch.ExpireTime = FMath::Max(Prefetch.ExpireTime, ExpireTime);
+			return;
+		}
+	}
+
+	PrefetchLocations.Add({ Location, ExpireTime, Priority, NextPrefetchId++ });
+}
+
+void UGAM312StreamingSubsystem::OnLevelAddedToWorld(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld() && Level && Level->IsWorldPartitionRuntimeCell())
+	{
+		RecentActivationTimes.Add(World->GetTimeSeconds());
+		++CellActivations;
+		++CellActivationsThisFrame;
+	}
+}
+
+void UGAM312StreamingSubsystem::OnLevelRemovedFromWorld(ULevel* Level, UWorld* World)
+{
+	if (World == GetWorld() && Level && Level->IsWorldPartitionRuntimeCell())
+	{
+		++CellDeactivationsThisFrame;
+	}
+}
+
+void UGAM312StreamingSubsystem::Tick(float DeltaTime)
+{
+	const double Now = GetWorld()->GetTimeSeconds();
+	PrefetchLocations.RemoveAllSwap([Now](const FPrefetchLocation& Prefetch) { return Prefetch.ExpireTime < Now; });
+
+	if (!bHasWorldPartition)
+	{
+		return;
+	}
+
+	// Cell work caused by the streaming sources, ours and the players' own
+	int32 NumExpired = 0;
+	while (NumExpired < RecentActivationTimes.Num() && RecentActivationTimes[NumExpired] < Now - 1.0)
+	{
+		++NumExpired;
+	}
+	RecentActivationTimes.RemoveAt(0, NumExpired, false);
+
+	CSV_CUSTOM_STAT(GAM312, StreamingCellsActivated, CellActivationsThisFrame, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(GAM312, StreamingCellsDeactivated, CellDeactivationsThisFrame, ECsvCustomStatOp::Set);
+	GAM312Stats::SetGauge(TEXT("Streaming.CellActivationsPerSecond"), RecentActivationTimes.Num(), CVarStreamingMaxCellActivationsPerSecond.GetValueOnGameThread());
+	CellActivationsThisFrame = 0;
+	CellDeactivationsThisFrame = 0;
+
+	TArray<FWantedSource, TInlineAllocator<MaxLookAheadSources * 2>> Wanted;
+	for (const FPrefetchLocation& Prefetch : PrefetchLocations)
+	{
+		Wanted.Add({ MakeSourceKey(ESourceKind::Prefetch, Prefetch.Id), Prefetch.Location, FRotator::ZeroRotator, Prefetch.Priority });
+	}
+
+	const float LookAheadSeconds = CVarStreamingLookAheadSeconds.GetValueOnGameThread();
+	const float MinSpeedSquared = FMath::Square(CVarStreamingMinSpeed.GetValueOnGameThread());
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		// Where the player will be if they keep moving the same way
+		const FVector Velocity = Pawn->GetVelocity();
+		if (Velocity.SizeSquared() > MinSpeedSquared)
+		{
+			Wanted.Add({ MakeSourceKey(ESourceKind::Velocity, PlayerController->GetUniqueID()), Pawn->GetActorLocation() + Velocity * LookAheadSeconds, Velocity.Rotation(), EStreamingSourcePriority::Normal });
+		}
+
+		// Cameras placed by a camera director can be far from the pawn
+		AActor* ViewTarget = PlayerController->GetViewTarget();
+		if (ViewTarget && ViewTarget != Pawn)
+		{
+			Wanted.Add({ MakeSourceKey(ESourceKind::ViewTarget, PlayerController->GetUniqueID()), ViewTarget->GetActorLocation(), ViewTarget->GetActorRotation(), EStreamingSourcePriority::Normal });
+		}
+	}
+
+	// Higher priority sources get the pool first
+	Algo::StableSortBy(Wanted, [](const FWantedSource& Source) { return (uint8)Source.Priority; });
+	if (Wanted.Num() > Sources.Num())
+	{
+		Wanted.SetNum(Sources.Num());
+	}
+
+	ApplyWantedSources(Wanted);
+
+	if (Now >= NextCellCheckTime)
+	{
+		NextCellCheckTime = Now + CVarStreamingCellCheckInterval.GetValueOnGameThread();
+		CheckPlayerCells();
+	}
+}
+
+void UGAM312StreamingSubsystem::ApplyWantedSources(TArrayView<const FWantedSource> Wanted)
+{
+	int32 ChangesLeft = CVarStreamingMaxChangesPerFrame.GetValueOnGameThread();
+	const float MoveThresholdSquared = FMath::Square(CVarStreamingMoveThreshold.GetValueOnGameThread());
+
+	// Adding or moving a source activates cells, so that waits while the last second was already busy
+	const int32 MaxActivations = CVarStreamingMaxCellActivationsPerSecond.GetValueOnGameThread();
+	const bool bCanActivate = MaxActivations <= 0 || RecentActivationTimes.Num() < MaxActivations;
+
+	// Release the sources nothing wants any more first, that frees their slot and their cells
+	for (const TUniquePtr<FGAM312LookAheadSource>& LookAhead : Sources)
+	{
+		if (ChangesLeft <= 0)
+		{
+			return;
+		}
+
+		const uint64 Key = LookAhead->Key;
+		if (LookAhead->bActive && !Wanted.ContainsByPredicate([Key](const FWantedSource& Target) { return Target.Key == Key; }))
+		{
+			LookAhead->bActive = false;
+			--ChangesLeft;
+		}
+	}
+
+	if (!bCanActivate)
+	{
+		return;
+	}
+
+	// Wanted is sorted by priority, so the most important sources get the budget first
+	for (const FWantedSource& Target : Wanted)
+	{
+		if (ChangesLeft <= 0)
+		{
+			return;
+		}
+
+		FGAM312LookAheadSource* LookAhead = nullptr;
+		for (const TUniquePtr<FGAM312LookAheadSource>& Candidate : Sources)
+		{
+			if (Candidate->bActive && Candidate->Key == Target.Key)
+			{
+				LookAhead = Candidate.Get();
+				break;
+			}
+		}
+
+		if (LookAhead)
+		{
+			// Small drifts are ignored so a moving player does not change sources every frame
+			if (LookAhead->Source.Priority == Target.Priority && FVector::DistSquared(LookAhead->Source.Location, Target.Location) <= MoveThresholdSquared)
+			{
+				continue;
+			}
+		}
+		else
+		{
+			// New sources take a free slot, there is none while a released one is still waiting on the budget
+			for (const TUniquePtr<FGAM312LookAheadSource>& Candidate : Sources)
+			{
+				if (!Candidate->bActive)
+				{
+					LookAhead = Candidate.Get();
+					break;
+				}
+			}
+
+			if (LookAhead == nullptr)
+			{
+				continue;
+			}
+		}
+
+		LookAhead->Key = Target.Key;
+		LookAhead->Source.Location = Target.Location;
+		LookAhead->Source.Rotation = Target.Rotation;
+		LookAhead->Source.Priority = Target.Priority;
+		LookAhead->bActive = true;
+		--ChangesLeft;
+	}
+}
+
+bool UGAM312StreamingSubsystem::IsLocationStreamed(const FVector& Location) const
+{
+	UWorldPartitionSubsystem* WorldPartition = GetWorld()->GetSubsystem<UWorldPartitionSubsystem>();
+	if (!bHasWorldPartition || WorldPartition == nullptr)
+	{
+		return true;
+	}
+
+	// Only the cells at the location, not a whole loading range
+	FWorldPartitionStreamingQuerySource Query(Location);
+	Query.bUseGridLoadingRange = false;
+	Query.Radius = 1.0f;
+
+	return WorldPartition->IsStreamingCompleted(EWorldPartitionRuntimeCellState::Activated, { Query }, false);
+}
+
+void UGAM312StreamingSubsystem::CheckPlayerCells()
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		if (IsLocationStreamed(Pawn->GetActorLocation()))
+		{
+			PawnsInUnloadedCells.Remove(Pawn);
+		}
+		else if (!PawnsInUnloadedCells.Contains(Pawn))
+		{
+			PawnsInUnloadedCells.Add(Pawn);
+			++UnloadedCellEntries;
+			GAM312Stats::AddUnloadedCellEntry();
+
+			UE_LOG(LogGAM312Streaming, Warning, TEXT("%s entered a cell that is still loading at %s (%d times so far)"), *Pawn->GetName(), *Pawn->GetActorLocation().ToCompactString(), UnloadedCellEntries);
+		}
+	}
+}
@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldPartition/WorldPartitionStreamingSource.h"
+#include "GAM312StreamingSubsystem.generated.h"
+
+// One look-ahead streaming source handed to World Partition
+class FGAM312LookAheadSource : public IWorldPartitionStreamingSourceProvider
+{
+public:
+	virtual bool GetStreamingSource(FWorldPartitionStreamingSource& OutStreamingSource) override;
+
+	FWorldPartitionStreamingSource Source;
+	bool bActive = false;
+
+	// Identity of the wanted source this one follows
+	uint64 Key = 0;
+};
+
+/**
+ * Adds look-ahead streaming sources on top of the player's own source, so cells ahead of the
+ * player are requested before the player reaches them. Sources come from the pawn's velocity,
+ * the camera the player is viewing through, and locations other code knows it is about to need,
+ * such as the respawn point while the player is low on health.
+ *
+ * Sources keep their identity across frames (a prefetch location, a player's velocity or a player's
+ * view target), so one source appearing or going away does not shift the others. Only a few sources
+ * may change each frame, and none are added or moved while the cells activated over the last second
+ * are above budget, so sprinting does not churn the streaming state. Every time a player stands in a
+ * cell that has not finished loading it is counted and logged.
+ */
+UCLASS()
+class GAM312_API UGAM312StreamingSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Keeps cells around Location loaded for Duration seconds, higher priority locations win the budget first
+	void AddPrefetchLocation(const FVector& Location, float Duration, EStreamingSourcePriority Priority = EStreamingSourcePriority::High);
+
+	// True if the cells at Location have finished loading, always true without World Partition
+	bool IsLocationStreamed(const FVector& Location) const;
+
+	// Number of times a player was inside a cell that had not finished loading
+	int32 GetUnloadedCellEntries() const { return UnloadedCellEntries; }
+
+	// Number of World Partition cells activated in this world so far
+	int32 GetCellActivations() const { return CellActivations; }
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	// What a wanted source follows, combined with an id into its key
+	enum class ESourceKind : uint8
+	{
+		Prefetch,
+		Velocity,
+		ViewTarget,
+	};
+
+	struct FPrefetchLocation
+	{
+		FVector Location;
+		double ExpireTime;
+		EStreamingSourcePriority Priority;
+		uint32 Id;
+	};
+
+	// A source wanted this frame, applied to the pool within the change budget
+	struct FWantedSource
+	{
+		uint64 Key;
+		FVector Location;
+		FRotator Rotation;
+		EStreamingSourcePriority Priority;
+	};
+
+	static uint64 MakeSourceKey(ESourceKind Kind, uint32 Id) { return (static_cast<uint64>(Id) << 8) | static_cast<uint8>(Kind); }
+
+	// Moves the pooled sources towards the wanted ones, at most the budgeted number per frame
+	void ApplyWantedSources(TArrayView<const FWantedSource> Wanted);
+
+	// Checks if the players are standing in cells that are still loading
+	void CheckPlayerCells();
+
+	// Counts the World Partition cells made visible and hidden in this world
+	void OnLevelAddedToWorld(ULevel* Level, UWorld* World);
+	void OnLevelRemovedFromWorld(ULevel* Level, UWorld* World);
+
+	// Fixed pool of sources registered once with World Partition
+	TArray<TUniquePtr<FGAM312LookAheadSource>> Sources;
+
+	TArray<FPrefetchLocation> PrefetchLocations;
+
+	// Players that were inside an unloaded cell at the last check
+	TSet<TWeakObjectPtr<APawn>> PawnsInUnloadedCells;
+
+	// Times of the cell activations within the last second, oldest first
+	TArray<double> RecentActivationTimes;
+
+	int32 CellActivations = 0;
+	int32 CellActivationsThisFrame = 0;
+	int32 CellDeactivationsThisFrame = 0;
+	uint32 NextPrefetchId = 0;
+
+	int32 UnloadedCellEntries = 0;
+	double NextCellCheckTime = 0.0;
+	bool bHasWorldPartition = false;
+};
@@ -0,0 +1,634 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312StressSubsystem.h"
+#include "Cube.h"
+#include "CubeField.h"
+#include "Enemy.h"
+#include "GAM312PickupSubsystem.h"
+#include "LightSwitchTrigger.h"
+#include "Projectile.h"
+#include "TP_WeaponComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Stress, Log, All);
+
+static TAutoConsoleVariable<FString> CVarStressWolfClass(
+	TEXT("gam.Stress.WolfClass"),
+	TEXT(""),
+	TEXT("Enemy class spawned by gam.Stress.SpawnWolves, empty uses AEnemy."));
+
+static TAutoConsoleVariable<FString> CVarStressCubeClass(
+	TEXT("gam.Stress.CubeClass"),
+	TEXT(""),
+	TEXT("Cube class spawned by gam.Stress.SpawnCubes, empty uses ACube with the engine cube mesh."));
+
+static TAutoConsoleVariable<FString> CVarStressPickupClass(
+	TEXT("gam.Stress.PickupClass"),
+	TEXT("/Game/FirstPerson/Blueprints/BP_PickUp_Rifle.BP_PickUp_Rifle_C"),
+	TEXT("Pickup class added by gam.Stress.SpawnPickups."));
+
+static TAutoConsoleVariable<float> CVarStressTolerance(
+	TEXT("gam.Stress.Tolerance"),
+	0.1f,
+	TEXT("Fraction a metric may grow over its baseline before the capture fails."));
+
+static TAutoConsoleVariable<float> CVarStressMinRegressionMs(
+	TEXT("gam.Stress.MinRegressionMs"),
+	0.25f,
+	TEXT("Smallest absolute growth in milliseconds that counts as a regression."));
+
+// Runs a stress command on the stress subsystem of the world it was typed in
+static void RunStressCommand(UWorld* World, TFunctionRef<void(UGAM312StressSubsystem&)> Command)
+{
+	if (UGAM312StressSubsystem* Stress = World ? World->GetSubsystem<UGAM312StressSubsystem>() : nullptr)
+	{
+		Command(*Stress);
+	}
+}
+
+static int32 GetIntArg(const TArray<FString>& Args, int32 Index, int32 Default)
+{
+	return Args.IsValidIndex(Index) ? FCString::Atoi(*Args[Index]) : Default;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSpawnWolvesCommand(
+	TEXT("gam.Stress.SpawnWolves"),
+	TEXT("Spawns N enemies around the player. Usage: gam.Stress.SpawnWolves N"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SpawnWolves(GetIntArg(Args, 0, 50)); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressFireProjectilesCommand(
+	TEXT("gam.Stress.FireProjectiles"),
+	TEXT("Fires M projectiles per second from the player's weapon, 0 stops. Usage: gam.Stress.FireProjectiles M"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SetProjectileRate(GetIntArg(Args, 0, 20)); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressAutoFireCommand(
+	TEXT("gam.Stress.AutoFire"),
+	TEXT("Holds or releases the trigger of the player's weapon, the burst's fire rate and cost per shot are logged on release. Usage: gam.Stress.AutoFire 0/1"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SetAutoFire(GetIntArg(Args, 0, 1) != 0); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSpawnCubesCommand(
+	TEXT("gam.Stress.SpawnCubes"),
+	TEXT("Spawns a wall of K physics cubes in front of the player. Usage: gam.Stress.SpawnCubes K"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SpawnCubes(GetIntArg(Args, 0, 100)); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSpawnCubeFieldCommand(
+	TEXT("gam.Stress.SpawnCubeField"),
+	TEXT("Spawns the same wall as gam.Stress.SpawnCubes as one instanced cube field. Usage: gam.Stress.SpawnCubeField K"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SpawnCubeField(GetIntArg(Args, 0, 100)); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSpawnLightsCommand(
+	TEXT("gam.Stress.SpawnLights"),
+	TEXT("Spawns a grid of N light switch triggers around the player. Usage: gam.Stress.SpawnLights N"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SpawnLights(GetIntArg(Args, 0, 100)); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSpawnPickupsCommand(
+	TEXT("gam.Stress.SpawnPickups"),
+	TEXT("Adds N pickup records in a grid around the player, only the ones near the player become actors. Usage: gam.Stress.SpawnPickups N"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SpawnPickups(GetIntArg(Args, 0, 1000)); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressBotCommand(
+	TEXT("gam.Stress.Bot"),
+	TEXT("Drives the player pawn in a circle. Usage: gam.Stress.Bot 0/1"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SetBotEnabled(GetIntArg(Args, 0, 1) != 0); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressClearCommand(
+	TEXT("gam.Stress.Clear"),
+	TEXT("Destroys everything the stress scenarios spawned and stops firing."),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [](UGAM312StressSubsystem& Stress) { Stress.Clear(); });
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressCaptureCommand(
+	TEXT("gam.Stress.Capture"),
+	TEXT("Records frame timings and checks them against the PerfBudgets and PerfBaselines files of that name. Usage: gam.Stress.Capture Seconds Name"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress)
+		{
+			Stress.StartCapture(Args.IsValidIndex(0) ? FCString::Atof(*Args[0]) : 10.0f, Args.IsValidIndex(1) ? Args[1] : TEXT("Default"));
+		});
+	}));
+
+static FAutoConsoleCommandWithWorldAndArgs GStressSaveBaselineCommand(
+	TEXT("gam.Stress.SaveBaseline"),
+	TEXT("Stores the last capture as a baseline. Usage: gam.Stress.SaveBaseline Name"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		RunStressCommand(World, [&Args](UGAM312StressSubsystem& Stress) { Stress.SaveBaseline(Args.IsValidIndex(0) ? Args[0] : TEXT("Default")); });
+	}));
+
+bool UGAM312StressSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312StressSubsystem::Deinitialize()
+{
+	Clear();
+
+	Super::Deinitialize();
+}
+
+TStatId UGAM312StressSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UGAM312StressSubsystem, STATGROUP_Tickables);
+}
+
+FString UGAM312StressSubsystem::GetBaselineDir()
+{
+	return FPaths::ProjectDir() / TEXT("PerfBaselines");
+}
+
+FString UGAM312StressSubsystem::GetBudgetDir()
+{
+	return FPaths::ProjectDir() / TEXT("PerfBudgets");
+}
+
+FVector UGAM312StressSubsystem::GetRingLocation(int32 Index, int32 Count, float Radius) const
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const FVector Center = (PlayerController && PlayerController->GetPawn()) ? PlayerController->GetPawn()->GetActorLocation() : FVector::ZeroVector;
+
+	const float Angle = 2.0f * PI * Index / FMath::Max(Count, 1);
+	return Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * Radius;
+}
+
+void UGAM312StressSubsystem::SpawnWolves(int32 Count)
+{
+	UClass* WolfClass = AEnemy::StaticClass();
+	const FString ClassPath = CVarStressWolfClass.GetValueOnGameThread();
+	if (!ClassPath.IsEmpty())
+	{
+		if (UClass* LoadedClass = LoadClass<AEnemy>(nullptr, *ClassPath))
+		{
+			WolfClass = LoadedClass;
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+	// Spread the wolves over rings from 800 out to the 1250 sight radius, so every wolf sees the player and starts chasing right away
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const float Radius = 800.0f + 150.0f * (Index % 4);
+		if (AEnemy* Enemy = GetWorld()->SpawnActor<AEnemy>(WolfClass, GetRingLocation(Index, Count, Radius), FRotator::ZeroRotator, SpawnParams))
+		{
+			Enemy->SpawnDefaultController();
+			SpawnedActors.Add(Enemy);
+		}
+	}
+
+	UE_LOG(LogGAM312Stress, Display, TEXT("Spawned %d wolves of class %s"), Count, *WolfClass->GetName());
+}
+
+void UGAM312StressSubsystem::SetProjectileRate(int32 PerSecond)
+{
+	ProjectileRate = FMath::Max(PerSecond, 0);
+	ProjectileAccumulator = 0.0f;
+}
+
+void UGAM312StressSubsystem::FireStressProjectile()
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (Pawn == nullptr)
+	{
+		return;
+	}
+
+	// Fire through the real weapon so sound and animation are part of the cost
+	if (UTP_WeaponComponent* Weapon = FindPlayerWeapon())
+	{
+		Weapon->Fire();
+		return;
+	}
+
+	// No weapon picked up, spawn the projectile directly
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	const FRotator Rotation = PlayerController->GetControlRotation();
+	GetWorld()->SpawnActor<AProjectile>(AProjectile::StaticClass(), Pawn->GetActorLocation() + Rotation.RotateVector(FVector(100.0f, 0.0f, 10.0f)), Rotation, SpawnParams);
+}
+
+UTP_WeaponComponent* UGAM312StressSubsystem::FindPlayerWeapon() const
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (Pawn == nullptr)
+	{
+		return nullptr;
+	}
+
+	TArray<AActor*> AttachedActors;
+	Pawn->GetAttachedActors(AttachedActors);
+	for (AActor* Attached : AttachedActors)
+	{
+		if (UTP_WeaponComponent* Weapon = Attached->FindComponentByClass<UTP_WeaponComponent>())
+		{
+			return Weapon;
+		}
+	}
+	return nullptr;
+}
+
+void UGAM312StressSubsystem::SetAutoFire(bool bEnabled)
+{
+	UTP_WeaponComponent* Weapon = FindPlayerWeapon();
+	if (Weapon == nullptr || Weapon->RoundsPerMinute <= 0.0f)
+	{
+		UE_LOG(LogGAM312Stress, Warning, TEXT("gam.Stress.AutoFire needs the player to hold a weapon with RoundsPerMinute set"));
+		return;
+	}
+
+	if (bEnabled)
+	{
+		Weapon->StartFiring();
+	}
+	else
+	{
+		Weapon->StopFiring();
+	}
+}
+
+void UGAM312StressSubsystem::SpawnCubes(int32 Count)
+{
+	UClass* CubeClass = ACube::StaticClass();
+	const FString ClassPath = CVarStressCubeClass.GetValueOnGameThread();
+	if (!ClassPath.IsEmpty())
+	{
+		if (UClass* LoadedClass = LoadClass<ACube>(nullptr, *ClassPath))
+		{
+			CubeClass = LoadedClass;
+		}
+	}
+
+	UStaticMesh* DefaultCubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	const FVector Origin = Pawn ? Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * 1500.0f : FVector::ZeroVector;
+	const FVector Right = Pawn ? Pawn->GetActorRightVector() : FVector::RightVector;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Stack the cubes in a wall, the same layout as the target walls in the maps
+	const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))));
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Origin + Right * ((Index % Columns) - Columns / 2) * 110.0f + FVector::UpVector * (Index / Columns) * 110.0f;
+		if (ACube* Cube = GetWorld()->SpawnActor<ACube>(CubeClass, Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			if (Cube->CubeMesh->GetStaticMesh() == nullptr && DefaultCubeMesh)
+			{
+				Cube->CubeMesh->SetStaticMesh(DefaultCubeMesh);
+				Cube->CubeMesh->SetSimulatePhysics(true);
+			}
+			SpawnedActors.Add(Cube);
+		}
+	}
+
+	UE_LOG(LogGAM312Stress, Display, TEXT("Spawned %d cubes of class %s"), Count, *CubeClass->GetName());
+}
+
+void UGAM312StressSubsystem::SpawnCubeField(int32 Count)
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+	const FVector Origin = Pawn ? Pawn->GetActorLocation() + Pawn->GetActorForwardVector() * 1500.0f : FVector::ZeroVector;
+	const FRotator Rotation = Pawn ? FRotator(0.0f, Pawn->GetActorRotation().Yaw, 0.0f) : FRotator::ZeroRotator;
+
+	// Same wall as SpawnCubes, the grid has to be set before construction builds the instances
+	const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))));
+	ACubeField* Field = GetWorld()->SpawnActorDeferred<ACubeField>(ACubeField::StaticClass(), FTransform(Rotation, Origin), nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Field == nullptr)
+	{
+		return;
+	}
+
+	Field->CubeMesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	Field->GridCount = FIntVector(1, Columns, FMath::DivideAndRoundUp(FMath::Max(Count, 1), Columns));
+	Field->Spacing = 110.0f;
+	Field->FinishSpawning(FTransform(Rotation, Origin));
+	SpawnedActors.Add(Field);
+
+	UE_LOG(LogGAM312Stress, Display, TEXT("Spawned a cube field of %d cubes"), Field->GridCount.Y * Field->GridCount.Z);
+}
+
+void UGAM312StressSubsystem::SpawnLights(int32 Count)
+{
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const FVector Center = (PlayerController && PlayerController->GetPawn()) ? PlayerController->GetPawn()->GetActorLocation() : FVector::ZeroVector;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	// Square grid centered on the player so the bot walks through the trigger spheres
+	const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))));
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Center + FVector(((Index % Columns) - Columns / 2) * 700.0f, ((Index / Columns) - Columns / 2) * 700.0f, 200.0f);
+		if (ALightSwitchTrigger* Light = GetWorld()->SpawnActor<ALightSwitchTrigger>(ALightSwitchTrigger::StaticClass(), Location, FRotator::ZeroRotator, SpawnParams))
+		{
+			SpawnedActors.Add(Light);
+		}
+	}
+
+	UE_LOG(LogGAM312Stress, Display, TEXT("Spawned %d light switch triggers"), Count);
+}
+
+void UGAM312StressSubsystem::SpawnPickups(int32 Count)
+{
+	UGAM312PickupSubsystem* Registry = GetWorld()->GetSubsystem<UGAM312PickupSubsystem>();
+	UClass* PickupClass = LoadClass<AActor>(nullptr, *CVarStressPickupClass.GetValueOnGameThread());
+	if (Registry == nullptr || PickupClass == nullptr)
+	{
+		UE_LOG(LogGAM312Stress, Warning, TEXT("gam.Stress.SpawnPickups needs the pickup registry and a valid gam.Stress.PickupClass"));
+		return;
+	}
+
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const FVector Center = (PlayerController && PlayerController->GetPawn()) ? PlayerController->GetPawn()->GetActorLocation() : FVector::ZeroVector;
+
+	// Wide grid so most of the pickups are out of range and stay records
+	const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))));
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		const FVector Location = Center + FVector(((Index % Columns) - Columns / 2) * 400.0f, ((Index / Columns) - Columns / 2) * 400.0f, 50.0f);
+		PickupHandles.Add(Registry->AddPickup(PickupClass, FTransform(Location), 0));
+	}
+
+	UE_LOG(LogGAM312Stress, Display, TEXT("Added %d pickup records of class %s"), Count, *PickupClass->GetName());
+}
+
+void UGAM312StressSubsystem::SetBotEnabled(bool bEnabled)
+{
+	bBotEnabled = bEnabled;
+	BotTime = 0.0f;
+}
+
+void UGAM312StressSubsystem::Clear()
+{
+	for (const TWeakObjectPtr<AActor>& Actor : SpawnedActors)
+	{
+		if (Actor.IsValid())
+		{
+			Actor->Destroy();
+		}
+	}
+
+	SpawnedActors.Reset();
+
+	if (UGAM312PickupSubsystem* Registry = GetWorld()->GetSubsystem<UGAM312PickupSubsystem>())
+	{
+		for (const FGAM312PickupHandle& Handle : PickupHandles)
+		{
+			Registry->RemovePickup(Handle);
+		}
+	}
+	PickupHandles.Reset();
+
+	ProjectileRate = 0.0f;
+	bBotEnabled = false;
+}
+
+void UGAM312StressSubsystem::StartCapture(float Seconds, const FString& Name)
+{
+	bCapturing = true;
+	CaptureEndTime = GetWorld()->GetTimeSeconds() + Seconds;
+	CaptureName = Name;
+	CaptureFrames.Reset();
+
+	UE_LOG(LogGAM312Stress, Display, TEXT("Capturing %s for %.1f seconds"), *Name, Seconds);
+}
+
+void UGAM312StressSubsystem::Tick(float DeltaTime)
+{
+	// Fire at a steady rate no matter the frame rate
+	if (ProjectileRate > 0.0f)
+	{
+		ProjectileAccumulator += DeltaTime * ProjectileRate;
+		while (ProjectileAccumulator >= 1.0f)
+		{
+			FireStressProjectile();
+			ProjectileAccumulator -= 1.0f;
+		}
+	}
+
+	// Walk the player in a circle so the enemies have a moving target
+	if (bBotEnabled)
+	{
+		APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+		if (APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr)
+		{
+			BotTime += DeltaTime;
+			Pawn->AddMovementInput(FVector(FMath::Cos(BotTime * 0.5f), FMath::Sin(BotTime * 0.5f), 0.0f), 1.0f);
+		}
+	}
+
+	if (bCapturing)
+	{
+		if (const UGAM312FrameTimingSubsystem* Timing = GetWorld()->GetSubsystem<UGAM312FrameTimingSubsystem>())
+		{
+			CaptureFrames.Add(Timing->GetLastFrame());
+		}
+
+		if (GetWorld()->GetTimeSeconds() >= CaptureEndTime)
+		{
+			FinishCapture();
+		}
+	}
+}
+
+TArray<UGAM312StressSubsystem::FMetricSummary> UGAM312StressSubsystem::Summarize() const
+{
+	TArray<FMetricSummary> Summaries;
+
+	auto AddSummary = [this, &Summaries](const TCHAR* Name, float FGAM312FrameTiming::* Member)
+	{
+		TArray<float> Values;
+		Values.Reserve(CaptureFrames.Num());
+		for (const FGAM312FrameTiming& Frame : CaptureFrames)
+		{
+			Values.Add(Frame.*Member);
+		}
+
+		FMetricSummary& Summary = Summaries.AddDefaulted_GetRef();
+		Summary.Name = Name;
+		if (Values.Num() > 0)
+		{
+			float Total = 0.0f;
+			for (float Value : Values)
+			{
+				Total += Value;
+			}
+			Values.Sort();
+
+			Summary.Average = Total / Values.Num();
+			Summary.P95 = Values[FMath::Min(Values.Num() - 1, FMath::FloorToInt(Values.Num() * 0.95f))];
+		}
+	};
+
+	AddSummary(TEXT("FrameMs"), &FGAM312FrameTiming::FrameMs);
+	AddSummary(TEXT("GameThreadMs"), &FGAM312FrameTiming::GameThreadMs);
+	AddSummary(TEXT("PhysicsMs"), &FGAM312FrameTiming::PhysicsMs);
+	AddSummary(TEXT("GCMs"), &FGAM312FrameTiming::GCMs);
+
+	return Summaries;
+}
+
+void UGAM312StressSubsystem::FinishCapture()
+{
+	bCapturing = false;
+
+	// Per frame CSV for digging into a run
+	FString Csv = TEXT("Frame,FrameMs,GameThreadMs,PhysicsMs,GCMs\n");
+	for (int32 Index = 0; Index < CaptureFrames.Num(); ++Index)
+	{
+		const FGAM312FrameTiming& Frame = CaptureFrames[Index];
+		Csv += FString::Printf(TEXT("%d,%.3f,%.3f,%.3f,%.3f\n"), Index, Frame.FrameMs, Frame.GameThreadMs, Frame.PhysicsMs, Frame.GCMs);
+	}
+
+	const FString CsvPath = FPaths::ProjectSavedDir() / TEXT("Stress") / (CaptureName + TEXT(".csv"));
+	FFileHelper::SaveStringToFile(Csv, *CsvPath);
+
+	LastSummaries = Summarize();
+
+	// Budgets are hard ceilings, any metric over one fails the capture
+	bool bOverBudget = false;
+	TArray<FMetricSummary> Budget;
+	bLastCaptureFoundBudget = LoadSummaries(GetBudgetDir() / (CaptureName + TEXT(".csv")), Budget);
+	for (const FMetricSummary& Summary : LastSummaries)
+	{
+		const FMetricSummary* Limit = Budget.FindByPredicate([&Summary](const FMetricSummary& Other) { return Other.Name == Summary.Name; });
+		if (Limit != nullptr && (Summary.Average > Limit->Average || Summary.P95 > Limit->P95))
+		{
+			bOverBudget = true;
+			UE_LOG(LogGAM312Stress, Error, TEXT("%s over budget in %s: avg %.3f (budget %.3f), p95 %.3f (budget %.3f)"),
+				*Summary.Name, *CaptureName, Summary.Average, Limit->Average, Summary.P95, Limit->P95);
+		}
+	}
+
+	// Compare against the measured baseline if there is one
+	bool bRegressed = false;
+	TArray<FMetricSummary> Baseline;
+	bLastCaptureFoundBaseline = LoadSummaries(GetBaselineDir() / (CaptureName + TEXT(".csv")), Baseline);
+	if (bLastCaptureFoundBaseline)
+	{
+		const float Tolerance = CVarStressTolerance.GetValueOnGameThread();
+		const float MinRegressionMs = CVarStressMinRegressionMs.GetValueOnGameThread();
+
+		for (const FMetricSummary& Summary : LastSummaries)
+		{
+			const FMetricSummary* Base = Baseline.FindByPredicate([&Summary](const FMetricSummary& Other) { return Other.Name == Summary.Name; });
+			if (Base == nullptr)
+			{
+				continue;
+			}
+
+			const bool bAverageRegressed = Summary.Average > Base->Average * (1.0f + Tolerance) && Summary.Average - Base->Average > MinRegressionMs;
+			const bool bP95Regressed = Summary.P95 > Base->P95 * (1.0f + Tolerance) && Summary.P95 - Base->P95 > MinRegressionMs;
+			if (bAverageRegressed || bP95Regressed)
+			{
+				bRegressed = true;
+				UE_LOG(LogGAM312Stress, Error, TEXT("%s regressed in %s: avg %.3f (baseline %.3f), p95 %.3f (baseline %.3f)"),
+					*Summary.Name, *CaptureName, Summary.Average, Base->Average, Summary.P95, Base->P95);
+			}
+		}
+	}
+	else
+	{
+		UE_LOG(LogGAM312Stress, Display, TEXT("No baseline for %s, run gam.Stress.SaveBaseline %s to store one"), *CaptureName, *CaptureName);
+	}
+
+	for (const FMetricSummary& Summary : LastSummaries)
+	{
+		UE_LOG(LogGAM312Stress, Display, TEXT("%s %s: avg %.3f ms, p95 %.3f ms"), *CaptureName, *Summary.Name, Summary.Average, Summary.P95);
+	}
+	bLastCaptureOverBudget = bOverBudget;
+	bLastCaptureRegressed = bRegressed;
+	const bool bFailed = bOverBudget || bRegressed;
+	UE_LOG(LogGAM312Stress, Display, TEXT("Capture %s %s over %d frames, written to %s"), *CaptureName, bFailed ? TEXT("FAILED") : TEXT("passed"), CaptureFrames.Num(), *CsvPath);
+
+	// Headless runs report the result through the exit code
+	if (FParse::Param(FCommandLine::Get(), TEXT("gamstressexit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bFailed ? 1 : 0);
+	}
+}
+
+bool UGAM312StressSubsystem::SaveBaseline(const FString& Name) const
+{
+	if (LastSummaries.Num() == 0)
+	{
+		UE_LOG(LogGAM312Stress, Warning, TEXT("No capture to save as baseline %s"), *Name);
+		return false;
+	}
+
+	FString Csv = TEXT("Metric,Average,P95\n");
+	for (const FMetricSummary& Summary : LastSummaries)
+	{
+		Csv += FString::Printf(TEXT("%s,%.3f,%.3f\n"), *Summary.Name, Summary.Average, Summary.P95);
+	}
+
+	const FString Path = GetBaselineDir() / (Name + TEXT(".csv"));
+	UE_LOG(LogGAM312Stress, Display, TEXT("Saving baseline %s"), *Path);
+	return FFileHelper::SaveStringToFile(Csv, *Path);
+}
+
+bool UGAM312StressSubsystem::LoadSummaries(const FString& Path, TArray<FMetricSummary>& OutSummaries) const
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *Path))
+	{
+		return false;
+	}
+
+	// Skip the header line
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		TArray<FString> Columns;
+		if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) == 3)
+		{
+			FMetricSummary& Summary = OutSummaries.AddDefaulted_GetRef();
+			Summary.Name = Columns[0];
+			Summary.Average = FCString::Atof(*Columns[1]);
+			Summary.P95 = FCString::Atof(*Columns[2]);
+		}
+	}
+
+	return OutSummaries.Num() > 0;
+}
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312FrameTimingSubsystem.h"
+#include "GAM312PickupSubsystem.h"
+#include "GAM312StressSubsystem.generated.h"
+
+class UTP_WeaponComponent;
+
+/**
+ * Spawns stress scenarios around the player and captures frame timings to CSV, failing the run when
+ * a metric is over its budget or worse than a measured baseline. The same commands work by hand in
+ * game and headless with -nullrhi -ExecCmds="..." -gamstressexit.
+ *
+ * Console:
+ *   gam.Stress.SpawnWolves N       spawn N enemies around the player
+ *   gam.Stress.FireProjectiles M   fire M projectiles per second from the player's weapon
+ *   gam.Stress.AutoFire 0/1        hold the trigger of the player's weapon at its RoundsPerMinute
+ *   gam.Stress.SpawnCubes K        spawn K physics cubes in a wall in front of the player
+ *   gam.Stress.SpawnCubeField K    spawn the same wall as one ACubeField to compare against
+ *   gam.Stress.SpawnLights N       spawn a grid of N light switch triggers
+ *   gam.Stress.SpawnPickups N      add N pickup records in a grid around the player
+ *   gam.Stress.Bot 0/1             drive the player pawn in a circle for the enemies to chase
+ *   gam.Stress.Clear               destroy everything the stress scenarios spawned
+ *   gam.Stress.Capture Seconds Name   record timings and check them against the Name budget and baseline
+ *   gam.Stress.SaveBaseline Name   store the last capture as the Name baseline
+ *
+ * Automation: GAM312.Stress.<Scenario> runs each scenario on a map and fails when the capture goes over
+ * PerfBudgets/Stress_<Scenario>.csv, or regresses against PerfBaselines/Stress_<Scenario>.csv once one
+ * has been measured, e.g. -nullrhi -ExecCmds="Automation RunTests GAM312.Stress; Quit"
+ */
+UCLASS()
+class GAM312_API UGAM312StressSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	void SpawnWolves(int32 Count);
+	void SetProjectileRate(int32 PerSecond);
+	void SetAutoFire(bool bEnabled);
+	void SpawnCubes(int32 Count);
+	void SpawnCubeField(int32 Count);
+	void SpawnLights(int32 Count);
+	void SpawnPickups(int32 Count);
+	void SetBotEnabled(bool bEnabled);
+	void Clear();
+
+	void StartCapture(float Seconds, const FString& Name);
+	bool SaveBaseline(const FString& Name) const;
+
+	// Results of the capture, read by the stress automation tests
+	bool IsCapturing() const { return bCapturing; }
+	bool DidLastCaptureFindBudget() const { return bLastCaptureFoundBudget; }
+	bool DidLastCaptureExceedBudget() const { return bLastCaptureOverBudget; }
+	bool DidLastCaptureFindBaseline() const { return bLastCaptureFoundBaseline; }
+	bool DidLastCaptureRegress() const { return bLastCaptureRegressed; }
+
+	// Directory the measured baselines are read from and written to
+	static FString GetBaselineDir();
+
+	// Directory of the hand set budgets, read only
+	static FString GetBudgetDir();
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	// Average and 95th percentile of one metric over a capture
+	struct FMetricSummary
+	{
+		FString Name;
+		float Average = 0.0f;
+		float P95 = 0.0f;
+	};
+
+	// Pickup registry records added by SpawnPickups
+	TArray<FGAM312PickupHandle> PickupHandles;
+
+	// Returns a spawn point on a ring around the player
+	FVector GetRingLocation(int32 Index, int32 Count, float Radius) const;
+
+	// Fires one projectile from the player's weapon, or spawns one if the player has no weapon
+	void FireStressProjectile();
+
+	// Weapon held by the player, null before one is picked up
+	UTP_WeaponComponent* FindPlayerWeapon() const;
+
+	// Writes the capture to CSV and checks it against the budget and baseline
+	void FinishCapture();
+
+	TArray<FMetricSummary> Summarize() const;
+
+	// Reads a Metric,Average,P95 file written by SaveBaseline or by hand
+	bool LoadSummaries(const FString& Path, TArray<FMetricSummary>& OutSummaries) const;
+
+	// Actors spawned by the scenarios, destroyed by Clear
+	TArray<TWeakObjectPtr<AActor>> SpawnedActors;
+
+	float ProjectileRate = 0.0f;
+	float ProjectileAccumulator = 0.0f;
+
+	bool bBotEnabled = false;
+	float BotTime = 0.0f;
+
+	bool bCapturing = false;
+	double CaptureEndTime = 0.0;
+	FString CaptureName;
+	TArray<FGAM312FrameTiming> CaptureFrames;
+	TArray<FMetricSummary> LastSummaries;
+	bool bLastCaptureFoundBudget = false;
+	bool bLastCaptureOverBudget = false;
+	bool bLastCaptureFoundBaseline = false;
+	bool bLastCaptureRegressed = false;
+};
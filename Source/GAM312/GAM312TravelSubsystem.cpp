@@ -0,0 +1,281 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312TravelSubsystem.h"
+#include "GAM312Character.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/PackageName.h"
+#include "TimerManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Travel, Log, All);
+
+static TAutoConsoleVariable<float> CVarTravelStallFrameMs(
+	TEXT("gam.Travel.StallFrameMs"),
+	50.0f,
+	TEXT("Frames longer than this during travel count towards the travel stall."));
+
+static TAutoConsoleVariable<float> CVarTravelStallBudgetMs(
+	TEXT("gam.Travel.StallBudgetMs"),
+	250.0f,
+	TEXT("Total stall in milliseconds a travel may have before it counts as failed."));
+
+static TAutoConsoleVariable<int32> CVarTravelSettleFrames(
+	TEXT("gam.Travel.SettleFrames"),
+	60,
+	TEXT("Frames of the new map still measured after arriving, which covers the purge of the old map."));
+
+static TAutoConsoleVariable<float> CVarTravelCommandLineDelay(
+	TEXT("gam.Travel.CommandLineDelay"),
+	3.0f,
+	TEXT("Seconds after the first map loads before a -gamtravel= travel starts."));
+
+static TAutoConsoleVariable<float> CVarTravelTimeout(
+	TEXT("gam.Travel.Timeout"),
+	60.0f,
+	TEXT("Seconds a travel may take to preload and arrive before it is abandoned, 0 waits forever."));
+
+static FAutoConsoleCommandWithWorldAndArgs GTravelCommand(
+	TEXT("gam.Travel"),
+	TEXT("Preloads a map in the background and travels to it seamlessly. Usage: gam.Travel <Map>"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		UGameInstance* GameInstance = World ? World->GetGameInstance() : nullptr;
+		if (UGAM312TravelSubsystem* Travel = GameInstance ? GameInstance->GetSubsystem<UGAM312TravelSubsystem>() : nullptr)
+		{
+			if (Args.Num() > 0)
+			{
+				Travel->TravelTo(Args[0]);
+			}
+		}
+	}));
+
+void UGAM312TravelSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	PostLoadMapHandle = FCoreUObjectDelegates::PostLoadMapWithWorld.AddUObject(this, &UGAM312TravelSubsystem::OnPostLoadMap);
+	TravelFailureHandle = GEngine->OnTravelFailure().AddUObject(this, &UGAM312TravelSubsystem::OnTravelFailure);
+
+	FParse::Value(FCommandLine::Get(), TEXT("gamtravel="), CommandLineTravel);
+}
+
+void UGAM312TravelSubsystem::Deinitialize()
+{
+	FCoreUObjectDelegates::PostLoadMapWithWorld.Remove(PostLoadMapHandle);
+	if (GEngine)
+	{
+		GEngine->OnTravelFailure().Remove(TravelFailureHandle);
+	}
+	ResetTravel();
+	CarriedHealth.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UGAM312TravelSubsystem::TravelTo(const FString& MapName)
+{
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (bTraveling || World == nullptr)
+	{
+		return false;
+	}
+
+	// Only the server decides where everyone goes
+	if (World->GetNetMode() == NM_Client)
+	{
+		UE_LOG(LogGAM312Travel, Warning, TEXT("Clients cannot start a travel"));
+		return false;
+	}
+
+	FString PackageName = MapName;
+	if (!FPackageName::IsValidLongPackageName(PackageName) && !FPackageName::SearchForPackageOnDisk(MapName, &PackageName))
+	{
+		UE_LOG(LogGAM312Travel, Error, TEXT("No map called %s"), *MapName);
+		return false;
+	}
+
+	AGameModeBase* GameMode = World->GetAuthGameMode();
+	if (GameMode && !GameMode->bUseSeamlessTravel)
+	{
+		UE_LOG(LogGAM312Travel, Warning, TEXT("%s does not use seamless travel, players will be reloaded"), *GameMode->GetName());
+	}
+
+	// Remember what each player's character should keep on the other side
+	CarriedHealth.Reset();
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = It->Get();
+		if (AGAM312Character* Character = PlayerController ? Cast<AGAM312Character>(PlayerController->GetPawn()) : nullptr)
+		{
+			CarriedHealth.Add(PlayerController, Character->Health);
+		}
+	}
+
+	bTraveling = true;
+	bLastTravelArrived = false;
+	bLastTravelOverBudget = false;
+	DestinationPackage = PackageName;
+
+	TravelStartTime = FPlatformTime::Seconds();
+	LastFrameTime = TravelStartTime;
+	StallMs = 0.0;
+	LongestFrameMs = 0.0;
+	FramesAfterArrival = -1;
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddUObject(this, &UGAM312TravelSubsystem::OnEndFrame);
+
+	UE_LOG(LogGAM312Travel, Display, TEXT("Preloading %s"), *PackageName);
+
+	// The map and everything it references load in the background while play continues
+	LoadPackageAsync(PackageName, FLoadPackageAsyncDelegate::CreateUObject(this, &UGAM312TravelSubsystem::OnDestinationLoaded), 100);
+	return true;
+}
+
+void UGAM312TravelSubsystem::OnDestinationLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result)
+{
+	// The travel was abandoned while this was loading
+	if (!bTraveling || PackageName.ToString() != DestinationPackage)
+	{
+		return;
+	}
+
+	UWorld* World = GetGameInstance()->GetWorld();
+	if (Result != EAsyncLoadingResult::Succeeded || LoadedPackage == nullptr || World == nullptr)
+	{
+		FailTravel(FString::Printf(TEXT("could not preload %s"), *PackageName.ToString()));
+		return;
+	}
+
+	UE_LOG(LogGAM312Travel, Display, TEXT("Preloaded %s in %.2f s, traveling"), *PackageName.ToString(), FPlatformTime::Seconds() - TravelStartTime);
+
+	// Seamless travel finds the package already in memory and only has to set up the world
+	PreloadedPackage.Reset(LoadedPackage);
+	World->ServerTravel(DestinationPackage, false);
+}
+
+void UGAM312TravelSubsystem::OnPostLoadMap(UWorld* LoadedWorld)
+{
+	if (LoadedWorld == nullptr || LoadedWorld->GetGameInstance() != GetGameInstance())
+	{
+		return;
+	}
+
+	// Arrived, keep measuring while the old map is purged
+	if (bTraveling && LoadedWorld->GetOutermost()->GetName().EndsWith(FPackageName::GetShortName(DestinationPackage)))
+	{
+		PreloadedPackage.Reset();
+		FramesAfterArrival = CVarTravelSettleFrames.GetValueOnGameThread();
+		return;
+	}
+
+	// Headless travel benchmark, started once the first map is up
+	if (!bTraveling && !CommandLineTravel.IsEmpty())
+	{
+		FTimerHandle TravelTimer;
+		LoadedWorld->GetTimerManager().SetTimer(TravelTimer, FTimerDelegate::CreateWeakLambda(this, [this, MapName = CommandLineTravel]()
+		{
+			TravelTo(MapName);
+		}), CVarTravelCommandLineDelay.GetValueOnGameThread(), false);
+
+		CommandLineTravel.Reset();
+	}
+}
+
+void UGAM312TravelSubsystem::OnEndFrame()
+{
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - LastFrameTime) * 1000.0;
+	LastFrameTime = Now;
+
+	LongestFrameMs = FMath::Max(LongestFrameMs, FrameMs);
+	if (FrameMs > CVarTravelStallFrameMs.GetValueOnGameThread())
+	{
+		StallMs += FrameMs;
+	}
+
+	if (FramesAfterArrival > 0 && --FramesAfterArrival == 0)
+	{
+		FinishMeasurement();
+		return;
+	}
+
+	// Still on the old map, give up if the preload or the travel hangs
+	const float Timeout = CVarTravelTimeout.GetValueOnGameThread();
+	if (FramesAfterArrival < 0 && Timeout > 0.0f && Now - TravelStartTime > Timeout)
+	{
+		FailTravel(FString::Printf(TEXT("did not arrive within %.0f s"), Timeout));
+	}
+}
+
+void UGAM312TravelSubsystem::OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString)
+{
+	if (bTraveling && (World == nullptr || World->GetGameInstance() == GetGameInstance()))
+	{
+		FailTravel(FString::Printf(TEXT("%s %s"), ETravelFailure::ToString(FailureType), *ErrorString));
+	}
+}
+
+void UGAM312TravelSubsystem::ResetTravel()
+{
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+	EndFrameHandle.Reset();
+	PreloadedPackage.Reset();
+	bTraveling = false;
+	FramesAfterArrival = -1;
+}
+
+void UGAM312TravelSubsystem::FailTravel(const FString& Reason)
+{
+	ResetTravel();
+
+	// Nobody arrives anywhere, so nothing is carried
+	CarriedHealth.Reset();
+
+	UE_LOG(LogGAM312Travel, Error, TEXT("Travel to %s failed after %.2f s: %s"), *DestinationPackage, FPlatformTime::Seconds() - TravelStartTime, *Reason);
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("gamtravelexit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, 1);
+	}
+}
+
+void UGAM312TravelSubsystem::FinishMeasurement()
+{
+	ResetTravel();
+
+	const float StallBudgetMs = CVarTravelStallBudgetMs.GetValueOnGameThread();
+	bLastTravelArrived = true;
+	bLastTravelOverBudget = StallMs > StallBudgetMs;
+
+	UE_LOG(LogGAM312Travel, Display, TEXT("Travel to %s: total stall %.1f ms, longest frame %.1f ms, %.2f s overall"),
+		*DestinationPackage, StallMs, LongestFrameMs, FPlatformTime::Seconds() - TravelStartTime);
+	if (bLastTravelOverBudget)
+	{
+		UE_LOG(LogGAM312Travel, Error, TEXT("Travel to %s stalled %.1f ms, over the %.1f ms budget"), *DestinationPackage, StallMs, StallBudgetMs);
+	}
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("gamtravelexit")))
+	{
+		FPlatformMisc::RequestExitWithStatus(false, bLastTravelOverBudget ? 1 : 0);
+	}
+}
+
+void UGAM312TravelSubsystem::RestoreCarriedState(AController* Controller, AGAM312Character* Character)
+{
+	// Pawns possessed on the old map while the destination is still loading keep their own state
+	if (bTraveling && FramesAfterArrival < 0)
+	{
+		return;
+	}
+
+	float Health = 0.0f;
+	if (Character && CarriedHealth.RemoveAndCopyValue(Controller, Health))
+	{
+		Character->Health = Health;
+	}
+}
@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/GameInstanceSubsystem.h"
+#include "UObject/StrongObjectPtr.h"
+#include "UObject/UObjectGlobals.h"
+#include "Engine/EngineBaseTypes.h"
+#include "GAM312TravelSubsystem.generated.h"
+
+class AGAM312Character;
+
+/**
+ * Moves the game between maps without a blocking OpenLevel. The destination package is loaded in
+ * the background while play continues, then the server travels seamlessly through the transition
+ * map so controllers and player states survive. The old map is released by the engine's
+ * incremental purge in time-limited steps instead of one full purge.
+ *
+ * Each travel logs its total stall (time spent in frames over gam.Travel.StallFrameMs) and longest
+ * frame, and fails when the stall is over gam.Travel.StallBudgetMs. A travel that fails to load, is
+ * rejected by the engine or does not arrive within gam.Travel.Timeout is abandoned and logged as a
+ * failure. Headless runs use -gamtravel=<Map> -gamtravelexit to measure one travel and quit, with
+ * exit code 1 when it failed or went over budget, see Scripts/TravelBenchmark.sh.
+ *
+ * Console:
+ *   gam.Travel <Map>   preload and travel to a map, by short name or long package name
+ */
+UCLASS()
+class GAM312_API UGAM312TravelSubsystem : public UGameInstanceSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Starts preloading MapName and travels once it is loaded, returns false if the map does not exist
+	bool TravelTo(const FString& MapName);
+
+	// Gives a character the state its controller carried from the previous map
+	void RestoreCarriedState(AController* Controller, AGAM312Character* Character);
+
+	bool IsTraveling() const { return bTraveling; }
+
+	// Results of the last finished travel, read by the travel automation test
+	bool DidLastTravelArrive() const { return bLastTravelArrived; }
+	bool DidLastTravelExceedBudget() const { return bLastTravelOverBudget; }
+	double GetStallMs() const { return StallMs; }
+	double GetLongestFrameMs() const { return LongestFrameMs; }
+
+private:
+	void OnDestinationLoaded(const FName& PackageName, UPackage* LoadedPackage, EAsyncLoadingResult::Type Result);
+	void OnPostLoadMap(UWorld* LoadedWorld);
+	void OnEndFrame();
+	void OnTravelFailure(UWorld* World, ETravelFailure::Type FailureType, const FString& ErrorString);
+
+	// Logs the stall measured for the travel that just finished
+	void FinishMeasurement();
+
+	// Abandons the current travel and clears everything it was carrying
+	void FailTravel(const FString& Reason);
+
+	// Stops measuring and forgets the travel, shared by success and failure
+	void ResetTravel();
+
+	// Keeps the preloaded map package alive until the travel has used it
+	TStrongObjectPtr<UPackage> PreloadedPackage;
+
+	FString DestinationPackage;
+
+	// Map given with -gamtravel=, traveled to once after the first map has loaded
+	FString CommandLineTravel;
+
+	// Character state keyed by controller, controllers are kept through seamless travel. Entries stay
+	// after the measurement ends until the controller possesses a pawn, which may load asynchronously
+	TMap<TWeakObjectPtr<AController>, float> CarriedHealth;
+
+	bool bTraveling = false;
+	bool bLastTravelArrived = false;
+	bool bLastTravelOverBudget = false;
+	double TravelStartTime = 0.0;
+	double LastFrameTime = 0.0;
+	double StallMs = 0.0;
+	double LongestFrameMs = 0.0;
+
+	// Frames still measured after arriving, to include the first frames of the new map
+	int32 FramesAfterArrival = -1;
+
+	FDelegateHandle PostLoadMapHandle;
+	FDelegateHandle EndFrameHandle;
+	FDelegateHandle TravelFailureHandle;
+};
@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312WorldBoundsSubsystem.h"
+#include "GAM312Stats.h"
+#include "GameFramework/DamageType.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+
+static TAutoConsoleVariable<float> CVarWorldBoundsSweepInterval(
+	TEXT("gam.WorldBounds.SweepInterval"),
+	0.25f,
+	TEXT("Seconds between world bounds sweeps."));
+
+static TAutoConsoleVariable<int32> CVarWorldBoundsBatchSize(
+	TEXT("gam.WorldBounds.BatchSize"),
+	64,
+	TEXT("Number of registered actors checked per world bounds sweep."));
+
+static TAutoConsoleVariable<float> CVarWorldBoundsDefaultKillHeight(
+	TEXT("gam.WorldBounds.DefaultKillHeight"),
+	-1000.0f,
+	TEXT("Kill height used for actors registered without one."));
+
+bool UGAM312WorldBoundsSubsystem::DoesSupportWorldType(EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+void UGAM312WorldBoundsSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	LLM_SCOPE_BYTAG(GAM312_Subsystems);
+
+	Super::OnWorldBeginPlay(InWorld);
+
+	InWorld.GetTimerManager().SetTimer(SweepTimer, this, &UGAM312WorldBoundsSubsystem::SweepBatch, CVarWorldBoundsSweepInterval.GetValueOnGameThread(), true);
+}
+
+void UGAM312WorldBoundsSubsystem::Deinitialize()
+{
+	if (UWorld* World = GetWorld())
+	{
+		World->GetTimerManager().ClearTimer(SweepTimer);
+	}
+
+	Entries.Reset();
+	EntryIndices.Reset();
+
+	Super::Deinitialize();
+}
+
+void UGAM312WorldBoundsSubsystem::RegisterActor(AActor* Actor, float KillHeight)
+{
+	if (Actor == nullptr)
+	{
+		return;
+	}
+
+	// Registering again only updates the kill height
+	if (const int32* Index = EntryIndices.Find(Actor))
+	{
+		Entries[*Index] = { Actor, Actor, KillHeight };
+		return;
+	}
+
+	EntryIndices.Add(Actor, Entries.Add({ Actor, Actor, KillHeight }));
+}
+
+void UGAM312WorldBoundsSubsystem::RegisterActor(AActor* Actor)
+{
+	RegisterActor(Actor, CVarWorldBoundsDefaultKillHeight.GetValueOnGameThread());
+}
+
+void UGAM312WorldBoundsSubsystem::UnregisterActor(AActor* Actor)
+{
+	if (const int32* Index = EntryIndices.Find(Actor))
+	{
+		RemoveEntryAt(*Index);
+	}
+}
+
+void UGAM312WorldBoundsSubsystem::RemoveEntryAt(int32 Index)
+{
+	EntryIndices.Remove(Entries[Index].Key);
+	Entries.RemoveAtSwap(Index, 1, false);
+
+	if (Entries.IsValidIndex(Index))
+	{
+		EntryIndices.Add(Entries[Index].Key, Index);
+	}
+}
+
+void UGAM312WorldBoundsSubsystem::SweepBatch()
+{
+	int32 Remaining = FMath::Min(CVarWorldBoundsBatchSize.GetValueOnGameThread(), Entries.Num());
+
+	while (Remaining > 0 && Entries.Num() > 0)
+	{
+		// The sweep walks down from the end, so an entry swapped into a removed slot has always been checked already
+		if (SweepCursor < 0 || SweepCursor >= Entries.Num())
+		{
+			SweepCursor = Entries.Num() - 1;
+		}
+		const int32 Index = SweepCursor--;
+
+		// Destroyed actors are dropped here and do not count against the batch
+		AActor* Actor = Entries[Index].Actor.Get();
+		if (Actor == nullptr)
+		{
+			RemoveEntryAt(Index);
+			continue;
+		}
+
+		// Actors below their kill height handle it the same way as a kill volume, which may unregister them
+		if (Actor->GetActorLocation().Z < Entries[Index].KillHeight)
+		{
+			Actor->FellOutOfWorld(*GetDefault<UDamageType>());
+		}
+
+		--Remaining;
+	}
+
+	GAM312Stats::SetGauge(TEXT("WorldBounds.Registered"), Entries.Num());
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "GAM312WorldBoundsSubsystem.generated.h"
+
+/**
+ * Catches actors that leave the playable area. Kill volumes and the world KillZ already call
+ * FellOutOfWorld on actors that move through movement components; registered actors are also swept
+ * in small batches at a low cadence, so nothing needs a per-frame height check in its own Tick.
+ */
+UCLASS()
+class GAM312_API UGAM312WorldBoundsSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+	virtual void Deinitialize() override;
+
+	// Adds an actor to the sweep, FellOutOfWorld is called on it when it drops below KillHeight
+	void RegisterActor(AActor* Actor, float KillHeight);
+
+	// Adds an actor to the sweep using the default kill height
+	void RegisterActor(AActor* Actor);
+
+	// Removes an actor from the sweep, called from EndPlay
+	void UnregisterActor(AActor* Actor);
+
+	// Number of actors currently registered
+	int32 GetNumRegistered() const { return Entries.Num(); }
+
+protected:
+	virtual bool DoesSupportWorldType(EWorldType::Type WorldType) const override;
+
+private:
+	// Checks the next batch of registered actors against their kill height
+	void SweepBatch();
+
+	// Removes an entry by swapping the last one into its place
+	void RemoveEntryAt(int32 Index);
+
+	struct FBoundsEntry
+	{
+		TWeakObjectPtr<AActor> Actor;
+		const AActor* Key;
+		float KillHeight;
+	};
+
+	// Registered actors, kept packed for the sweep. Actors that skip EndPlay are dropped when the sweep reaches them
+	TArray<FBoundsEntry> Entries;
+
+	// Index into Entries for each registered actor
+	TMap<const AActor*, int32> EntryIndices;
+
+	// Index of the next entry to check, counting down
+	int32 SweepCursor = INDEX_NONE;
+
+	// Handles the low cadence sweep
+	FTimerHandle SweepTimer;
+};
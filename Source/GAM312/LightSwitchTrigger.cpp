@@ -2,15 +2,15 @@
 
 #include "LightSwitchTrigger.h"
 #include "Components/PointLightComponent.h"
-#include "Components/SphereComponent.h"
+#include "GAM312LightZoneSubsystem.h"
 // include draw debug helpers header file
 #include "DrawDebugHelpers.h"
 
 // Sets default values
 ALightSwitchTrigger::ALightSwitchTrigger()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Occupancy is counted by the light zone subsystem, the trigger itself never ticks
+	PrimaryActorTick.bCanEverTick = false;
 
 	LightIntensity = 3000.0f;
 
@@ -19,17 +19,6 @@ ALightSwitchTrigger::ALightSwitchTrigger()
 	PointLight->Intensity = LightIntensity;
 	PointLight->SetVisibility(true);
 	RootComponent = PointLight;
-
-	// Creates the sphere component
-	LightSphere = CreateDefaultSubobject<USphereComponent>(TEXT("Light Sphere Component"));
-	LightSphere->InitSphereRadius(300.0f);
-	LightSphere->SetCollisionProfileName(TEXT("Trigger"));
-	LightSphere->SetupAttachment(RootComponent);
-
-	// Functions for overlap events
-	LightSphere->OnComponentBeginOverlap.AddDynamic(this, &ALightSwitchTrigger::OnOverlapBegin);
-	LightSphere->OnComponentEndOverlap.AddDynamic(this, &ALightSwitchTrigger::OnOverlapEnd);
-
 }
 
 // Called when the game starts or when spawned
@@ -37,40 +26,36 @@ void ALightSwitchTrigger::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Sphere that helps with visualization at actor's location
-	DrawDebugSphere(GetWorld(), GetActorLocation(), 300.f, 50, FColor::Green, true, -1, 0, 2);
-
-}
-
-// Called every frame
-void ALightSwitchTrigger::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	if (UGAM312LightZoneSubsystem* LightZones = GetWorld()->GetSubsystem<UGAM312LightZoneSubsystem>())
+	{
+		ZoneHandle = LightZones->RegisterZone(this, GetActorLocation(), ZoneRadius);
+	}
 
+#if ENABLE_DRAW_DEBUG
+	// Sphere that helps with visualization at actor's location
+	DrawDebugSphere(GetWorld(), GetActorLocation(), ZoneRadius, 50, FColor::Green, true, -1, 0, 2);
+#endif
 }
 
-// Function called when the overlap begins
-void ALightSwitchTrigger::OnOverlapBegin(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+// Called when the trigger is destroyed or the level is unloaded
+void ALightSwitchTrigger::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (OtherActor && (OtherActor != this) && OtherComp)
+	if (UGAM312LightZoneSubsystem* LightZones = GetWorld()->GetSubsystem<UGAM312LightZoneSubsystem>())
 	{
-		// Toggles the light off when the overlap begins
-		ToggleLight();
+		LightZones->UnregisterZone(ZoneHandle);
 	}
+	ZoneHandle = INDEX_NONE;
+
+	Super::EndPlay(EndPlayReason);
 }
 
-// Function that is called when the overlap ends
-void ALightSwitchTrigger::OnOverlapEnd(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+void ALightSwitchTrigger::SetLightOn(bool bOn)
 {
-	if (OtherActor && (OtherActor != this) && OtherComp)
-	{
-		// Toggles light on when overlap ends
-		PointLight->ToggleVisibility(true);
-	}
+	PointLight->SetVisibility(bOn);
 }
 
 void ALightSwitchTrigger::ToggleLight()
 {
 	// This toggles light off
 	PointLight->ToggleVisibility(false);
-}
\ No newline at end of file
+}
@@ -19,33 +19,30 @@ protected:
     // Called when the game starts or when spawned
     virtual void BeginPlay() override;
 
-public:
-    // Called every frame
-    virtual void Tick(float DeltaTime) override;
+    // Called when the trigger is destroyed or the level is unloaded
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
+public:
     // Declaring point light component
     UPROPERTY(VisibleAnywhere, Category = "Light Switch")
     class UPointLightComponent* PointLight;
 
-    // Declaring sphere component
-    UPROPERTY(VisibleAnywhere, Category = "Light Switch")
-    class USphereComponent* LightSphere;
-
     // The desired intensity for the light
     UPROPERTY(VisibleAnywhere, Category = "Light Switch")
     float LightIntensity;
 
-    // Declaring overlap begin function
-    UFUNCTION()
-    void OnOverlapBegin(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-
-    // Declaring overlap end function
-    UFUNCTION()
-    void OnOverlapEnd(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+    // Radius around the trigger that switches the light off while anything is inside
+    UPROPERTY(EditAnywhere, Category = "Light Switch")
+    float ZoneRadius = 300.0f;
 
     // Declaring Toggle Light function
     UFUNCTION()
     void ToggleLight();
 
-    
+    // Called by the light zone subsystem when the zone fills or empties
+    void SetLightOn(bool bOn);
+
+private:
+    // Handle of this trigger's zone in the light zone subsystem
+    int32 ZoneHandle = INDEX_NONE;
 };
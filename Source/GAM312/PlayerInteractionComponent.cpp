@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlayerInteractionComponent.h"
+#include "Camera/CameraComponent.h"
+#include "Engine/World.h"
+
+// Sets default values for this component's properties
+UPlayerInteractionComponent::UPlayerInteractionComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = true;
+
+	Camera = nullptr;
+}
+
+// Called when the game starts
+void UPlayerInteractionComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	SetComponentTickInterval(TraceInterval);
+
+	// Trace from the owner's camera, never hitting the owner itself
+	Camera = GetOwner()->FindComponentByClass<UCameraComponent>();
+
+	QueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(PlayerInteractionTrace), false, GetOwner());
+
+	TraceDelegate.BindUObject(this, &UPlayerInteractionComponent::OnTraceCompleted);
+}
+
+// Called every frame, throttled by TraceInterval
+void UPlayerInteractionComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UWorld* World = GetWorld();
+
+	// Only keep one trace in flight
+	if (bTracePending)
+	{
+		return;
+	}
+
+	// Get the start and end of the trace from the camera, or from the owner's eyes if there is none
+	FVector Start;
+	FRotator Rotation;
+	if (Camera)
+	{
+		Start = Camera->GetComponentLocation();
+		Rotation = Camera->GetComponentRotation();
+	}
+	else
+	{
+		GetOwner()->GetActorEyesViewPoint(Start, Rotation);
+	}
+
+	const FVector End = Start + Rotation.Vector() * TraceDistance;
+
+	bTracePending = true;
+	World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, TraceChannel, QueryParams, FCollisionResponseParams::DefaultResponseParam, &TraceDelegate);
+}
+
+// Called when the async trace from the previous frame finishes
+void UPlayerInteractionComponent::OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	bTracePending = false;
+
+	AActor* PreviousActor = HoveredActor.Get();
+
+	bHasHoveredHit = Datum.OutHits.Num() > 0 && Datum.OutHits[0].bBlockingHit;
+	if (bHasHoveredHit)
+	{
+		HoveredHit = Datum.OutHits[0];
+		HoveredActor = HoveredHit.GetActor();
+	}
+	else
+	{
+		HoveredHit.Reset();
+		HoveredActor = nullptr;
+	}
+
+	HoveredFrame = GFrameCounter;
+
+	// Let listeners know only when the target actually changed
+	if (HoveredActor.Get() != PreviousActor)
+	{
+		OnHoveredActorChanged.Broadcast(HoveredActor.Get());
+	}
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/EngineTypes.h"
+#include "WorldCollision.h"
+#include "PlayerInteractionComponent.generated.h"
+
+class UCameraComponent;
+
+// Declaration of the delegate that is called when the actor under the crosshair changes
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnHoveredActorChanged, AActor*, NewHoveredActor);
+
+/**
+ * Runs one camera trace for the player at a fixed cadence and caches the result. UI, pickups and
+ * gameplay read the cached hit instead of each doing their own trace. The trace is asynchronous and
+ * reuses the same query params, so it does not allocate per request.
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class GAM312_API UPlayerInteractionComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	// Sets default values for this component's properties
+	UPlayerInteractionComponent();
+
+	// Seconds between traces, 0 traces every frame
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float TraceInterval = 0.05f;
+
+	// Length of the trace from the camera
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	float TraceDistance = 3319.0f;
+
+	// Channel used for the trace
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	TEnumAsByte<ECollisionChannel> TraceChannel = ECC_Visibility;
+
+	/** Called when the actor under the crosshair changes */
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FOnHoveredActorChanged OnHoveredActorChanged;
+
+	/** Returns the actor from the last completed trace, or null if nothing was hit */
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	AActor* GetHoveredActor() const { return HoveredActor.Get(); }
+
+	/** Returns true if the last completed trace hit something */
+	UFUNCTION(BlueprintCallable, Category = "Interaction")
+	bool HasHoveredHit() const { return bHasHoveredHit; }
+
+	// Returns the hit from the last completed trace
+	const FHitResult& GetHoveredHit() const { return HoveredHit; }
+
+	// Frame number the cached result was written on
+	uint64 GetHoveredFrame() const { return HoveredFrame; }
+
+protected:
+	// Called when the game starts
+	virtual void BeginPlay() override;
+
+public:
+	// Called every frame, throttled by TraceInterval
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+private:
+	// Called when the async trace from the previous frame finishes
+	void OnTraceCompleted(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	// Camera the trace starts from
+	UPROPERTY()
+	UCameraComponent* Camera;
+
+	// Query params built once and reused for every trace
+	FCollisionQueryParams QueryParams;
+
+	// Delegate bound once and reused for every trace
+	FTraceDelegate TraceDelegate;
+
+	// True while a trace is in flight
+	bool bTracePending = false;
+
+	// Cached result of the last completed trace
+	TWeakObjectPtr<AActor> HoveredActor;
+	FHitResult HoveredHit;
+	bool bHasHoveredHit = false;
+	uint64 HoveredFrame = 0;
+};
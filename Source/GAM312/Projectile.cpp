@@ -4,12 +4,17 @@
 #include "Enemy.h"
 #include "Components/SphereComponent.h"
 #include "GameFramework/ProjectileMovementComponent.h"
+#include "GAM312FixedStepSubsystem.h"
+#include "GAM312WorldBoundsSubsystem.h"
+#include "GAM312Stats.h"
 
 // Sets default values
 AProjectile::AProjectile()
 {
-	// Set this actor to call Tick() every frame. You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	LLM_SCOPE_BYTAG(GAM312_Projectiles);
+
+	// Movement is done by the projectile movement component, the actor itself does not tick
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Create a collision sphere for the projectile
 	CollisionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("Sphere Collision"));
@@ -28,27 +33,57 @@ AProjectile::AProjectile()
 
 	// Set the initial lifespan of the projectile
 	InitialLifeSpan = 3.0f;
+
+	// Replicate only the spawn, clients simulate the flight themselves
+	bReplicates = true;
+	bNetTemporary = true;
+	SetReplicateMovement(false);
 }
 
 // Called when the game starts or when spawned
 void AProjectile::BeginPlay()
 {
+	LLM_SCOPE_BYTAG(GAM312_Projectiles);
+
 	Super::BeginPlay();
 
+	GAM312Stats::AddInFlightProjectiles(1);
+
 	// Bind the OnHit function to the CollisionSphere's overlap event
 	CollisionSphere->OnComponentBeginOverlap.AddDynamic(this, &AProjectile::OnHit);
+
+	// Projectiles that leave the world are destroyed by the world bounds sweep
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->RegisterActor(this);
+	}
+
+	// Flight is stepped at a fixed rate when gam.Projectile.FixedStepHz is set
+	if (UGAM312FixedStepSubsystem* FixedStep = GetWorld()->GetSubsystem<UGAM312FixedStepSubsystem>())
+	{
+		FixedStep->RegisterProjectile(ProjectileMovement);
+	}
 }
 
-// Called every frame
-void AProjectile::Tick(float DeltaTime)
+// Called when the projectile is destroyed or the level is unloaded
+void AProjectile::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	GAM312Stats::AddInFlightProjectiles(-1);
 
+	if (UGAM312WorldBoundsSubsystem* WorldBounds = GetWorld()->GetSubsystem<UGAM312WorldBoundsSubsystem>())
+	{
+		WorldBounds->UnregisterActor(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Function called when the projectile hits another actor
 void AProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& Hit)
 {
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_ProjectileHit);
+	GAM312Stats::AddHit();
+
 	// Attempt to cast the other actor to an AEnemy
 	//AEnemy* Enemy = Cast<AEnemy>(OtherActor);
 
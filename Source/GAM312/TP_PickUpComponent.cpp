@@ -1,6 +1,8 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "TP_PickUpComponent.h"
+#include "GAM312PickupSubsystem.h"
+#include "GAM312Stats.h"
 
 UTP_PickUpComponent::UTP_PickUpComponent()
 {
@@ -12,8 +14,32 @@ void UTP_PickUpComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	GAM312Stats::AddLivePickups(1);
+
 	// Register our Overlap Event
 	OnComponentBeginOverlap.AddDynamic(this, &UTP_PickUpComponent::OnSphereBeginOverlap);
+
+	// Link to the record this actor was spawned for, or let the registry release it while no player is near
+	UGAM312PickupSubsystem* Registry = GetWorld()->GetSubsystem<UGAM312PickupSubsystem>();
+	if (Registry)
+	{
+		RegistryHandle = Registry->AdoptPickup(this);
+	}
+}
+
+void UTP_PickUpComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	GAM312Stats::AddLivePickups(-1);
+
+	// Destroyed pickups leave the registry, streamed out ones leave their record behind
+	UGAM312PickupSubsystem* Registry = GetWorld()->GetSubsystem<UGAM312PickupSubsystem>();
+	if (RegistryHandle.IsValid() && Registry)
+	{
+		Registry->OnPickupEndPlay(RegistryHandle, this, EndPlayReason);
+		RegistryHandle = FGAM312PickupHandle();
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 void UTP_PickUpComponent::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -25,6 +51,14 @@ void UTP_PickUpComponent::OnSphereBeginOverlap(UPrimitiveComponent* OverlappedCo
 		// Notify that the actor is being picked up
 		OnPickUp.Broadcast(Character);
 
+		// Picked up pickups are never released or spawned again
+		UGAM312PickupSubsystem* Registry = GetWorld()->GetSubsystem<UGAM312PickupSubsystem>();
+		if (RegistryHandle.IsValid() && Registry)
+		{
+			Registry->ConsumePickup(RegistryHandle);
+			RegistryHandle = FGAM312PickupHandle();
+		}
+
 		// Unregister from the Overlap Event so it is no longer triggered
 		OnComponentBeginOverlap.RemoveAll(this);
 	}
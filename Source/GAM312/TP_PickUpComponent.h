@@ -5,6 +5,7 @@
 #include "CoreMinimal.h"
 #include "Components/SphereComponent.h"
 #include "GAM312Character.h"
+#include "GAM312PickupSubsystem.h"
 #include "TP_PickUpComponent.generated.h"
 
 // Declaration of the delegate that will be called when someone picks this up
@@ -22,13 +23,33 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Interaction")
 	FOnPickUp OnPickUp;
 
+	/** Amount the pickup carries, such as ammo, kept in the pickup registry while the actor is released */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interaction")
+	int32 Payload = 0;
+
+	/**
+	 * Lets the pickup registry release this placed actor while no player is near and spawn it again when one
+	 * comes back. The respawned actor is built from its class defaults with only the transform and Payload
+	 * restored, so leave this off for pickups with other per instance changes. Pickups added to the registry
+	 * in code are always managed by it.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Interaction")
+	bool bUsePickupRegistry = false;
+
 	UTP_PickUpComponent();
 protected:
 
 	/** Called when the game starts */
 	virtual void BeginPlay() override;
 
+	/** Called when the component is destroyed or the level is unloaded */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	/** Code for when something overlaps this component */
 	UFUNCTION()
 	void OnSphereBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+private:
+	/** Handle of this pickup's record in the pickup registry */
+	FGAM312PickupHandle RegistryHandle;
 };
\ No newline at end of file
@@ -3,62 +3,287 @@
 
 #include "TP_WeaponComponent.h"
 #include "GAM312Character.h"
+#include "Cube.h"
+#include "CubeField.h"
+#include "Enemy.h"
 #include "Projectile.h"
 #include "GameFramework/PlayerController.h"
 #include "Camera/PlayerCameraManager.h"
 #include "Kismet/GameplayStatics.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
+#include "GAM312Assets.h"
+#include "GAM312AudioSubsystem.h"
+#include "GAM312HitchSubsystem.h"
+#include "GAM312Stats.h"
+#include "Components/AudioComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogGAM312Weapon, Log, All);
 
 // Sets default values for this component's properties
 UTP_WeaponComponent::UTP_WeaponComponent()
 {
 	// Default offset from the character location for projectiles to spawn
 	MuzzleOffset = FVector(100.0f, 0.0f, 10.0f);
+
+	Character = nullptr;
+	FireLoopAudio = nullptr;
 }
 
 
 void UTP_WeaponComponent::Fire()
 {
-	if (Character == nullptr || Character->GetController() == nullptr)
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_WeaponFire);
+	GAM312_HITCH_SCOPE(Weapon, GetWorld());
+
+	FVector AimLocation;
+	FRotator AimRotation;
+	if (!GetAim(AimLocation, AimRotation))
+	{
+		return;
+	}
+
+	const FGAM312Shot Shot = { AimLocation, AimRotation, 0.0f };
+	FireShots(MakeArrayView(&Shot, 1));
+	PlayFireFeedback(!bTriggerHeld);
+}
+
+void UTP_WeaponComponent::StartFiring()
+{
+	if (RoundsPerMinute <= 0.0f || bTriggerHeld || !GetAim(PreviousAimLocation, PreviousAimRotation))
+	{
+		return;
+	}
+
+	bTriggerHeld = true;
+	ShotAccumulator = 0.0f;
+	BurstShots = 0;
+	BurstCycles = 0;
+	BurstStartTime = GetWorld()->GetTimeSeconds();
+
+	// The loop covers the whole burst, so shots do not each start a sound
+	if (USoundBase* LoopSound = FireLoopSound.Get())
+	{
+		if (FireLoopAudio == nullptr)
+		{
+			FireLoopAudio = UGameplayStatics::SpawnSoundAttached(LoopSound, this, NAME_None, FVector::ZeroVector, EAttachLocation::KeepRelativeOffset, false, 1.0f, 1.0f, 0.0f, nullptr, nullptr, false);
+		}
+		else
+		{
+			FireLoopAudio->Play();
+		}
+	}
+
+	// The first shot goes out on the press, the rest follow from TickComponent
+	Fire();
+}
+
+void UTP_WeaponComponent::StopFiring()
+{
+	if (!bTriggerHeld)
+	{
+		return;
+	}
+
+	bTriggerHeld = false;
+
+	if (FireLoopAudio)
+	{
+		FireLoopAudio->Stop();
+	}
+
+	// Compare the shots fired with the shots the fire rate asks for, and what each one cost
+	const double BurstSeconds = GetWorld()->GetTimeSeconds() - BurstStartTime;
+	const int32 ExpectedShots = 1 + FMath::FloorToInt(BurstSeconds * RoundsPerMinute / 60.0);
+	UE_LOG(LogGAM312Weapon, Log, TEXT("Burst of %d shots in %.2fs at %.0f rpm, expected %d, %.1f us per shot"),
+		BurstShots, BurstSeconds, RoundsPerMinute, ExpectedShots, GetBurstMicrosecondsPerShot());
+}
+
+double UTP_WeaponComponent::GetBurstMicrosecondsPerShot() const
+{
+	return BurstShots > 0 ? FPlatformTime::ToMilliseconds64(BurstCycles) * 1000.0 / BurstShots : 0.0;
+}
+
+void UTP_WeaponComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!bTriggerHeld)
+	{
+		return;
+	}
+
+	FVector AimLocation;
+	FRotator AimRotation;
+	if (RoundsPerMinute <= 0.0f || !GetAim(AimLocation, AimRotation))
 	{
+		StopFiring();
 		return;
 	}
 
-	// Try and fire a projectile
-	if (Projectile != nullptr)
+	GAM312_SCOPE_CYCLE_COUNTER(STAT_GAM312_WeaponFire);
+	GAM312_HITCH_SCOPE(Weapon, GetWorld());
+
+	// Every shot due this frame, aimed where the camera was at the moment it was due
+	const float ShotInterval = 60.0f / RoundsPerMinute;
+	ShotAccumulator += DeltaTime;
+	TArray<FGAM312Shot, TInlineAllocator<16>> Shots;
+	while (ShotAccumulator >= ShotInterval)
+	{
+		ShotAccumulator -= ShotInterval;
+
+		const float Alpha = DeltaTime > 0.0f ? FMath::Clamp(1.0f - ShotAccumulator / DeltaTime, 0.0f, 1.0f) : 1.0f;
+		Shots.Add({ FMath::Lerp(PreviousAimLocation, AimLocation, Alpha), FQuat::Slerp(PreviousAimRotation.Quaternion(), AimRotation.Quaternion(), Alpha).Rotator(), ShotAccumulator });
+	}
+
+	PreviousAimLocation = AimLocation;
+	PreviousAimRotation = AimRotation;
+
+	if (Shots.Num() > 0)
+	{
+		FireShots(Shots);
+		PlayFireFeedback(false);
+	}
+}
+
+bool UTP_WeaponComponent::GetAim(FVector& OutLocation, FRotator& OutRotation) const
+{
+	APlayerController* PlayerController = Character ? Cast<APlayerController>(Character->GetController()) : nullptr;
+	if (PlayerController == nullptr || PlayerController->PlayerCameraManager == nullptr)
+	{
+		return false;
+	}
+
+	OutRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
+
+	// Hitscan shots come from the camera so they land under the crosshair
+	if (FireMode == EGAM312FireMode::Hitscan)
+	{
+		OutLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+	}
+	else
+	{
+		// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
+		OutLocation = GetOwner()->GetActorLocation() + OutRotation.RotateVector(MuzzleOffset);
+	}
+	return true;
+}
+
+void UTP_WeaponComponent::FireShots(TArrayView<const FGAM312Shot> Shots)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+
+	if (FireMode == EGAM312FireMode::Hitscan)
+	{
+		FireHitscanBatch(Shots);
+	}
+	else if (Projectile != nullptr)
 	{
 		UWorld* const World = GetWorld();
-		if (World != nullptr)
+
+		//Set Spawn Collision Handling Override
+		FActorSpawnParameters ActorSpawnParams;
+		ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+		for (const FGAM312Shot& Shot : Shots)
 		{
-			APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
-			const FRotator SpawnRotation = PlayerController->PlayerCameraManager->GetCameraRotation();
-			// MuzzleOffset is in camera space, so transform it to world space before offsetting from the character location to find the final muzzle position
-			const FVector SpawnLocation = GetOwner()->GetActorLocation() + SpawnRotation.RotateVector(MuzzleOffset);
-	
-			//Set Spawn Collision Handling Override
-			FActorSpawnParameters ActorSpawnParams;
-			ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-	
 			// Spawn the projectile at the muzzle
-			World->SpawnActor<AProjectile>(Projectile, SpawnLocation, SpawnRotation, ActorSpawnParams);
+			AProjectile* Spawned = World->SpawnActor<AProjectile>(Projectile, Shot.Start, Shot.Rotation, ActorSpawnParams);
+
+			// A shot that was due earlier in the frame has already been flying for its age
+			if (Spawned && Shot.Age > KINDA_SMALL_NUMBER)
+			{
+				Spawned->ProjectileMovement->TickComponent(Shot.Age, LEVELTICK_All, nullptr);
+			}
 		}
 	}
-	
-	// Try and play the sound if specified
-	if (FireSound != nullptr)
+
+	BurstShots += Shots.Num();
+	BurstCycles += FPlatformTime::Cycles64() - StartCycles;
+}
+
+void UTP_WeaponComponent::FireHitscanBatch(TArrayView<const FGAM312Shot> Shots)
+{
+	UWorld* const World = GetWorld();
+	AController* Instigator = Character ? Character->GetController() : nullptr;
+
+	// Traced right away rather than async, a frame has one or two shots even at 1,200 rpm and 30 fps,
+	// and an async result would land every hit and its flash a frame after the shot
+	FHitResult Hit;
+	for (const FGAM312Shot& Shot : Shots)
 	{
-		UGameplayStatics::PlaySoundAtLocation(this, FireSound, Character->GetActorLocation());
+		const FVector Direction = Shot.Rotation.Vector();
+		if (!World->LineTraceSingleByChannel(Hit, Shot.Start, Shot.Start + Direction * HitscanRange, HitscanChannel, HitscanQueryParams))
+		{
+			continue;
+		}
+
+		GAM312Stats::AddHit();
+		ApplyHitscanHit(Hit, Direction, Instigator);
 	}
-	
-	// Try and play a firing animation if specified
-	if (FireAnimation != nullptr)
+}
+
+void UTP_WeaponComponent::ApplyHitscanHit(const FHitResult& Hit, const FVector& Direction, AController* Instigator)
+{
+	AActor* HitActor = Hit.GetActor();
+	const FVector Impulse = Direction * HitscanImpulse;
+
+	// The same damage paths projectile hits take, none of these actors override TakeDamage
+	if (ACube* Cube = Cast<ACube>(HitActor))
+	{
+		UGameplayStatics::ApplyDamage(Cube, HitscanDamage, Instigator, GetOwner(), UDamageType::StaticClass());
+		Cube->OnTakeDamage();
+
+		// Cubes take the push on their physics step
+		Cube->AddHitImpulse(Impulse, Hit.ImpactPoint);
+		return;
+	}
+
+	if (ACubeField* CubeField = Cast<ACubeField>(HitActor))
+	{
+		CubeField->TakeTraceHit(Hit, Impulse, GetOwner());
+		return;
+	}
+
+	if (AEnemy* Enemy = Cast<AEnemy>(HitActor))
+	{
+		Enemy->DealDamage(HitscanDamage);
+	}
+	else if (HitActor)
+	{
+		UGameplayStatics::ApplyPointDamage(HitActor, HitscanDamage, Direction, Hit, Instigator, GetOwner(), UDamageType::StaticClass());
+	}
+
+	// Same push a projectile gives a simulating body
+	UPrimitiveComponent* HitComponent = Hit.GetComponent();
+	if (HitComponent && HitComponent->IsSimulatingPhysics())
+	{
+		HitComponent->AddImpulseAtLocation(Impulse, Hit.ImpactPoint);
+	}
+}
+
+void UTP_WeaponComponent::PlayFireFeedback(bool bRetrigger)
+{
+	// Try and play the sound if specified and streamed in, an automatic weapon with a loop sound already has it playing
+	USoundBase* Sound = FireSound.Get();
+	if (Sound && (bRetrigger || FireLoopAudio == nullptr || !FireLoopAudio->IsPlaying()))
+	{
+		// Pooled and budgeted with every other weapon in the world, the local player's shots win over others
+		if (UGAM312AudioSubsystem* Audio = GetWorld()->GetSubsystem<UGAM312AudioSubsystem>())
+		{
+			Audio->PlaySoundAtLocation(Sound, Character->GetActorLocation(), EGAM312SoundCategory::Weapon, Character->IsLocallyControlled() ? 2.0f : 1.0f);
+		}
+	}
+
+	// Try and play a firing animation if specified and streamed in
+	if (UAnimMontage* Montage = FireAnimation.Get())
 	{
 		// Get the animation object for the arms mesh
 		UAnimInstance* AnimInstance = Character->GetMesh1P()->GetAnimInstance();
-		if (AnimInstance != nullptr)
+		if (AnimInstance != nullptr && (bRetrigger || !AnimInstance->Montage_IsPlaying(Montage)))
 		{
-			AnimInstance->Montage_Play(FireAnimation, 1.f);
+			AnimInstance->Montage_Play(Montage, 1.f);
 		}
 	}
 }
@@ -78,6 +303,32 @@ void UTP_WeaponComponent::AttachWeapon(AGAM312Character* TargetCharacter)
 	// switch bHasRifle so the animation blueprint can switch to another animation set
 	Character->SetHasRifle(true);
 
+	// Hitscan traces never hit the weapon or the character holding it
+	HitscanQueryParams = FCollisionQueryParams(SCENE_QUERY_STAT(WeaponHitscan), false, GetOwner());
+	HitscanQueryParams.AddIgnoredActor(Character);
+
+	// Stream in the firing sound and animation, firing works without them until they arrive. The
+	// asset manager does not scan the component templates of pickups, so the bundle is registered
+	// under the pickup class the first time one is picked up
+	TArray<FSoftObjectPath> FireAssets;
+	if (!FireSound.IsNull())
+	{
+		FireAssets.Add(FireSound.ToSoftObjectPath());
+	}
+	if (!FireLoopSound.IsNull())
+	{
+		FireAssets.Add(FireLoopSound.ToSoftObjectPath());
+	}
+	if (!FireAnimation.IsNull())
+	{
+		FireAssets.Add(FireAnimation.ToSoftObjectPath());
+	}
+	if (FireAssets.Num() > 0)
+	{
+		UClass* PickupClass = GetOwner()->GetClass();
+		FireAssetsHandle = GAM312Assets::LoadGameplayBundle(GAM312Assets::GetClassAssetId(GAM312Assets::WeaponType, PickupClass), PickupClass, FireAssets);
+	}
+
 	// Set up action bindings
 	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
 	{
@@ -89,14 +340,25 @@ void UTP_WeaponComponent::AttachWeapon(AGAM312Character* TargetCharacter)
 
 		if (UEnhancedInputComponent* EnhancedInputComponent = Cast<UEnhancedInputComponent>(PlayerController->InputComponent))
 		{
-			// Fire
-			EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &UTP_WeaponComponent::Fire);
+			// Fire, an automatic weapon holds the trigger between press and release and times its own shots
+			if (RoundsPerMinute > 0.0f)
+			{
+				EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Started, this, &UTP_WeaponComponent::StartFiring);
+				EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Completed, this, &UTP_WeaponComponent::StopFiring);
+				EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Canceled, this, &UTP_WeaponComponent::StopFiring);
+			}
+			else
+			{
+				EnhancedInputComponent->BindAction(FireAction, ETriggerEvent::Triggered, this, &UTP_WeaponComponent::Fire);
+			}
 		}
 	}
 }
 
 void UTP_WeaponComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
+	StopFiring();
+
 	if (Character == nullptr)
 	{
 		return;
@@ -4,9 +4,33 @@
 
 #include "CoreMinimal.h"
 #include "Components/SkeletalMeshComponent.h"
+#include "WorldCollision.h"
 #include "TP_WeaponComponent.generated.h"
 
 class AGAM312Character;
+class AController;
+class UAudioComponent;
+
+/** How the weapon turns a shot into a hit */
+UENUM(BlueprintType)
+enum class EGAM312FireMode : uint8
+{
+	// Spawns a projectile actor per shot
+	Projectile,
+
+	// Traces the shot instantly, no actor is spawned
+	Hitscan
+};
+
+// One shot fired during a frame
+struct FGAM312Shot
+{
+	FVector Start;
+	FRotator Rotation;
+
+	// Seconds between the shot being due and the end of the frame it was fired in
+	float Age;
+};
 
 UCLASS(Blueprintable, BlueprintType, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class GAM312_API UTP_WeaponComponent : public USkeletalMeshComponent
@@ -18,13 +42,41 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category= Projectile)
 	TSubclassOf<class AProjectile> Projectile;
 
-	/** Sound to play each time we fire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
-	USoundBase* FireSound;
+	/** Sound to play each time we fire, streamed in when the weapon is picked up */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay, meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<USoundBase> FireSound;
 	
-	/** AnimMontage to play each time we fire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
-	UAnimMontage* FireAnimation;
+	/** AnimMontage to play each time we fire, streamed in when the weapon is picked up */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<UAnimMontage> FireAnimation;
+
+	/** Looping sound played while the trigger is held on an automatic weapon, instead of FireSound per shot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay, meta = (AssetBundles = "Gameplay"))
+	TSoftObjectPtr<USoundBase> FireLoopSound;
+
+	/** Whether shots spawn projectiles or are traced instantly */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Weapon)
+	EGAM312FireMode FireMode = EGAM312FireMode::Projectile;
+
+	/** Shots per minute while the trigger is held, 0 fires once per trigger input as before */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Weapon)
+	float RoundsPerMinute = 0.0f;
+
+	/** Length of a hitscan trace */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Weapon)
+	float HitscanRange = 10000.0f;
+
+	/** Damage of one hitscan shot */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Weapon)
+	float HitscanDamage = 20.0f;
+
+	/** Impulse a hitscan shot gives a simulating body */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Weapon)
+	float HitscanImpulse = 30000.0f;
+
+	/** Channel hitscan shots trace on */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Weapon)
+	TEnumAsByte<ECollisionChannel> HitscanChannel = ECC_Visibility;
 
 	/** Gun muzzle's offset from the characters location */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
@@ -49,12 +101,63 @@ public:
 	UFUNCTION(BlueprintCallable, Category="Weapon")
 	void Fire();
 
+	/** Holds the trigger of an automatic weapon, shots follow at RoundsPerMinute until StopFiring */
+	UFUNCTION(BlueprintCallable, Category="Weapon")
+	void StartFiring();
+
+	/** Releases the trigger of an automatic weapon */
+	UFUNCTION(BlueprintCallable, Category="Weapon")
+	void StopFiring();
+
+	/** Shots fired since the trigger was last held, and their average cost in microseconds */
+	int32 GetBurstShots() const { return BurstShots; }
+	double GetBurstMicrosecondsPerShot() const;
+
+	/** Fires the shots due this frame while the trigger is held */
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
 protected:
 	/** Ends gameplay for this component. */
 	UFUNCTION()
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
+	// Where shots start and where they point right now, false without a player to aim
+	bool GetAim(FVector& OutLocation, FRotator& OutRotation) const;
+
+	// Fires a frame's shots in one pass, oldest first
+	void FireShots(TArrayView<const FGAM312Shot> Shots);
+
+	// Traces every hitscan shot of the frame with the same query params
+	void FireHitscanBatch(TArrayView<const FGAM312Shot> Shots);
+
+	// Damages and pushes what a hitscan shot hit
+	void ApplyHitscanHit(const FHitResult& Hit, const FVector& Direction, AController* Instigator);
+
+	// Plays the fire sound and animation, an automatic weapon keeps them running instead of restarting them
+	void PlayFireFeedback(bool bRetrigger);
+
 	/** The Character holding this weapon*/
 	AGAM312Character* Character;
+
+	// Looping fire sound while the trigger is held
+	UPROPERTY(Transient)
+	UAudioComponent* FireLoopAudio;
+
+	// Built once when the weapon is attached and reused for every hitscan trace
+	FCollisionQueryParams HitscanQueryParams;
+
+	// Trigger state of an automatic weapon
+	bool bTriggerHeld = false;
+	float ShotAccumulator = 0.0f;
+	FVector PreviousAimLocation = FVector::ZeroVector;
+	FRotator PreviousAimRotation = FRotator::ZeroRotator;
+
+	// Fire rate and cost of the current burst, logged when the trigger is released
+	int32 BurstShots = 0;
+	double BurstStartTime = 0.0;
+	uint64 BurstCycles = 0;
+
+	/** Keeps FireSound and FireAnimation loaded while the weapon is held */
+	TSharedPtr<struct FStreamableHandle> FireAssetsHandle;
 };
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312AudioSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Sound/SoundWave.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312AudioBudgetTest, "GAM312.Audio.Budget", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGAM312AudioBudgetTest::RunTest(const FString& Parameters)
+{
+	// Voices are tracked without their components, so this holds under -nosound where none are made
+	FGAM312TestWorld TestWorld;
+
+	// The listener, standalone controllers count as local
+	TestWorld.Spawn<APlayerController>();
+
+	UGAM312AudioSubsystem* Audio = TestWorld.GetWorld()->GetSubsystem<UGAM312AudioSubsystem>();
+	if (!TestNotNull(TEXT("Audio subsystem"), Audio))
+	{
+		return false;
+	}
+
+	const int32 WeaponBudget = IConsoleManager::Get().FindConsoleVariable(TEXT("gam.Audio.WeaponVoices"))->GetInt();
+	const int32 EnemyBudget = IConsoleManager::Get().FindConsoleVariable(TEXT("gam.Audio.EnemyVoices"))->GetInt();
+
+	// Distinct two second sounds so nothing merges unless a test means it to
+	TArray<USoundWave*> Sounds;
+	for (int32 Index = 0; Index < WeaponBudget + EnemyBudget + 8; ++Index)
+	{
+		USoundWave* Sound = NewObject<USoundWave>(GetTransientPackage());
+		Sound->Duration = 2.0f;
+		Sounds.Add(Sound);
+	}
+	int32 NextSound = 0;
+
+	// Each category fills to its own budget, the weapon sounds past the budget steal at equal priority
+	for (int32 Index = 0; Index < WeaponBudget + 4; ++Index)
+	{
+		TestTrue(TEXT("Weapon sound at equal priority plays"), Audio->PlaySoundAtLocation(Sounds[NextSound++], FVector::ZeroVector, EGAM312SoundCategory::Weapon, 1.0f));
+	}
+	for (int32 Index = 0; Index < EnemyBudget; ++Index)
+	{
+		Audio->PlaySoundAtLocation(Sounds[NextSound++], FVector::ZeroVector, EGAM312SoundCategory::Enemy, 1.0f);
+	}
+	TestEqual(TEXT("Weapon voices held at budget"), Audio->GetActiveVoices(EGAM312SoundCategory::Weapon), WeaponBudget);
+	TestEqual(TEXT("Enemy voices fill their own budget"), Audio->GetActiveVoices(EGAM312SoundCategory::Enemy), EnemyBudget);
+
+	// A full category drops quieter sounds and lets louder ones steal
+	TestFalse(TEXT("Lower priority sound dropped"), Audio->PlaySoundAtLocation(Sounds[NextSound++], FVector::ZeroVector, EGAM312SoundCategory::Enemy, 0.5f));
+	TestTrue(TEXT("Higher priority sound steals"), Audio->PlaySoundAtLocation(Sounds[NextSound++], FVector::ZeroVector, EGAM312SoundCategory::Enemy, 2.0f));
+	TestEqual(TEXT("Stealing keeps the enemy budget"), Audio->GetActiveVoices(EGAM312SoundCategory::Enemy), EnemyBudget);
+
+	// The stolen voice was a priority 1 sound, so another priority 2 sound still finds one to take
+	TestTrue(TEXT("Second higher priority sound steals"), Audio->PlaySoundAtLocation(Sounds[NextSound++], FVector::ZeroVector, EGAM312SoundCategory::Enemy, 2.0f));
+
+	// A repeat of a running sound nearby merges into it, further away it needs its own voice
+	USoundWave* Repeated = Sounds[NextSound - 1];
+	TestFalse(TEXT("Repeat nearby merges"), Audio->PlaySoundAtLocation(Repeated, FVector(50.0f, 0.0f, 0.0f), EGAM312SoundCategory::Enemy, 2.0f));
+	TestTrue(TEXT("Repeat far away plays"), Audio->PlaySoundAtLocation(Repeated, FVector(2000.0f, 0.0f, 0.0f), EGAM312SoundCategory::Enemy, 2.0f));
+
+	// Out of the listener's range nothing plays
+	TestFalse(TEXT("Distant sound culled"), Audio->PlaySoundAtLocation(Sounds[NextSound++], FVector(100000.0f, 0.0f, 0.0f), EGAM312SoundCategory::Weapon, 2.0f));
+
+	// Once the sounds have ended the voices are free again
+	TestWorld.Tick(0.25f, 12);
+	TestEqual(TEXT("Weapon voices end"), Audio->GetActiveVoices(EGAM312SoundCategory::Weapon), 0);
+	TestEqual(TEXT("Enemy voices end"), Audio->GetActiveVoices(EGAM312SoundCategory::Enemy), 0);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CameraDirector.h"
+#include "Camera/CameraActor.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312CameraTimelineTest, "GAM312.Camera.Timeline", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGAM312CameraTimelineTest::RunTest(const FString& Parameters)
+{
+	constexpr float FrameSeconds = 1.0f / 60.0f;
+
+	FGAM312TestWorld TestWorld;
+
+	// The director views through the first player's controller
+	APlayerController* Controller = TestWorld.Spawn<APlayerController>();
+	if (!TestNotNull(TEXT("Controller spawned"), Controller))
+	{
+		return false;
+	}
+
+	// Cameras far apart, so each shot's prefetch asks for somewhere new
+	TArray<ACameraActor*> Cameras;
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		Cameras.Add(TestWorld.Spawn<ACameraActor>(FVector(Index * 20000.0f, 0.0f, 500.0f)));
+	}
+
+	// Shots hold for less than the prefetch lead time, so every prefetch starts as soon as the shot before it
+	const float HoldTimes[] = { 1.0f, 0.5f, 1.0f };
+
+	// The director builds its transitions at BeginPlay, so the shots go on before spawning finishes
+	ACameraDirector* Director = TestWorld.GetWorld()->SpawnActorDeferred<ACameraDirector>(ACameraDirector::StaticClass(), FTransform::Identity);
+	for (int32 Index = 0; Index < Cameras.Num(); ++Index)
+	{
+		FGAM312CameraShot& Shot = Director->Shots.AddDefaulted_GetRef();
+		Shot.Camera = Cameras[Index];
+		Shot.HoldTime = HoldTimes[Index];
+	}
+	Director->bLoop = false;
+	Director->FinishSpawning(FTransform::Identity);
+
+	Director->Play();
+	TestTrue(TEXT("First shot cuts in on play"), Controller->GetViewTarget() == Cameras[0]);
+
+	// Checked a little after each shot starts, the timers run on the ticked world time
+	TestWorld.Tick(FrameSeconds, 66);
+	TestTrue(TEXT("Second shot after the first hold"), Controller->GetViewTarget() == Cameras[1]);
+
+	TestWorld.Tick(FrameSeconds, 30);
+	TestTrue(TEXT("Third shot after the second hold"), Controller->GetViewTarget() == Cameras[2]);
+
+	// Without looping the timeline stays on its last shot
+	TestWorld.Tick(FrameSeconds, 120);
+	TestTrue(TEXT("Last shot held at the end"), Controller->GetViewTarget() == Cameras[2]);
+
+	AddInfo(FString::Printf(TEXT("%d shots, %d started before their cells loaded"), Director->Shots.Num(), Director->GetUnloadedShots()));
+	TestEqual(TEXT("Every shot's cells were loaded when it started"), Director->GetUnloadedShots(), 0);
+
+	Director->Stop();
+	return true;
+}
+
+#endif
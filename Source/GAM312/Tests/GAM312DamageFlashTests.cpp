@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Cube.h"
+#include "GAM312DamageFlashComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Materials/Material.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GAM312DamageFlashTests
+{
+	constexpr int32 NumHits = 10;
+
+	// Hits the cube NumHits times inside one flash and counts the hits that left the mesh's render state to rebuild
+	int32 CountRenderStateUpdates(FGAM312TestWorld& TestWorld, ACube* Cube)
+	{
+		int32 Updates = 0;
+		for (int32 Hit = 0; Hit < NumHits; ++Hit)
+		{
+			Cube->OnTakeDamage();
+			if (Cube->CubeMesh->IsRenderStateDirty())
+			{
+				++Updates;
+			}
+
+			// Flush like the end of a frame so every hit is counted on its own
+			TestWorld.GetWorld()->SendAllEndOfFrameUpdates();
+		}
+		return Updates;
+	}
+
+	ACube* SpawnCube(FGAM312TestWorld& TestWorld)
+	{
+		ACube* Cube = TestWorld.Spawn<ACube>(FVector(0.0f, 0.0f, 100.0f));
+		Cube->CubeMesh->SetSimulatePhysics(false);
+		Cube->CubeMesh->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+		TestWorld.GetWorld()->SendAllEndOfFrameUpdates();
+		return Cube;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312DamageFlashCustomDataTest, "GAM312.DamageFlash.CustomData", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGAM312DamageFlashCustomDataTest::RunTest(const FString& Parameters)
+{
+	using namespace GAM312DamageFlashTests;
+
+	FGAM312TestWorld TestWorld;
+
+	// Move off time 0 so a written hit time can be told from an unwritten one
+	TestWorld.Tick(1.0f / 60.0f, 10);
+
+	// The cube flashes through custom data with no setup
+	ACube* Cube = SpawnCube(TestWorld);
+	UMaterialInterface* Material = Cube->CubeMesh->GetMaterial(0);
+
+	const int32 Updates = CountRenderStateUpdates(TestWorld, Cube);
+	AddInfo(FString::Printf(TEXT("%d render state updates for %d hits"), Updates, NumHits));
+
+	TestEqual(TEXT("Custom data hits never rebuild the render state"), Updates, 0);
+	TestEqual(TEXT("Hit time written"), Cube->DamageFlash->GetHitTime(Cube->CubeMesh), static_cast<float>(TestWorld.GetWorld()->GetTimeSeconds()));
+	TestTrue(TEXT("Material left alone"), Cube->CubeMesh->GetMaterial(0) == Material);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312DamageFlashSwapTest, "GAM312.DamageFlash.MaterialSwap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGAM312DamageFlashSwapTest::RunTest(const FString& Parameters)
+{
+	using namespace GAM312DamageFlashTests;
+
+	FGAM312TestWorld TestWorld;
+
+	// The cube is only a convenient mesh here, meshes whose material does not read the hit time set FlashMaterial
+	ACube* Cube = SpawnCube(TestWorld);
+	UMaterialInterface* Material = Cube->CubeMesh->GetMaterial(0);
+	UMaterialInterface* FlashMaterial = UMaterial::GetDefaultMaterial(MD_Surface);
+	Cube->DamageFlash->FlashMaterial = FlashMaterial;
+
+	// The first hit swaps the material, the rest only extend the flash
+	const int32 Updates = CountRenderStateUpdates(TestWorld, Cube);
+	AddInfo(FString::Printf(TEXT("%d render state updates for %d hits"), Updates, NumHits));
+
+	TestEqual(TEXT("One render state update per flash"), Updates, 1);
+	TestTrue(TEXT("Flash material swapped in"), Cube->CubeMesh->GetMaterial(0) == FlashMaterial);
+
+	TestWorld.Tick(1.0f / 60.0f, FMath::CeilToInt(Cube->DamageFlash->FlashDuration * 60.0f) + 1);
+	TestTrue(TEXT("Original material put back after the flash"), Cube->CubeMesh->GetMaterial(0) == Material);
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312FixedStepSubsystem.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GAM312FixedStepTests
+{
+	constexpr float StepHz = 60.0f;
+	constexpr float FlightSeconds = 2.0f;
+
+	// Fires the trace projectile at a floor and returns its position after every fixed step
+	TArray<FVector> TraceAtFrameRate(float FramesPerSecond)
+	{
+		FGAM312TestWorld TestWorld;
+
+		AStaticMeshActor* Floor = TestWorld.Spawn<AStaticMeshActor>();
+		Floor->GetStaticMeshComponent()->SetMobility(EComponentMobility::Movable);
+		Floor->GetStaticMeshComponent()->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+		Floor->SetActorScale3D(FVector(200.0f, 200.0f, 1.0f));
+		Floor->SetActorLocation(FVector(0.0f, 0.0f, -50.0f));
+
+		// No player start, so the projectile leaves from 200 units up heading down along X
+		UGAM312FixedStepSubsystem* FixedStep = TestWorld.GetWorld()->GetSubsystem<UGAM312FixedStepSubsystem>();
+		FixedStep->StartTrace(TEXT("Test"));
+
+		// Stop short of the projectile's 3 second life span, its destruction clears the trace
+		TestWorld.Tick(1.0f / FramesPerSecond, FMath::FloorToInt(FlightSeconds * FramesPerSecond));
+		return FixedStep->GetTracePositions();
+	}
+
+	// Step after which the projectile first moves up again
+	int32 FindBounce(const TArray<FVector>& Positions)
+	{
+		for (int32 Index = 2; Index < Positions.Num(); ++Index)
+		{
+			if (Positions[Index - 1].Z < Positions[Index - 2].Z && Positions[Index].Z > Positions[Index - 1].Z)
+			{
+				return Index - 1;
+			}
+		}
+		return INDEX_NONE;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312FixedStepTrajectoryTest, "GAM312.FixedStep.Trajectory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGAM312FixedStepTrajectoryTest::RunTest(const FString& Parameters)
+{
+	using namespace GAM312FixedStepTests;
+
+	IConsoleVariable* StepHzVar = IConsoleManager::Get().FindConsoleVariable(TEXT("gam.Projectile.FixedStepHz"));
+	if (!TestNotNull(TEXT("gam.Projectile.FixedStepHz exists"), StepHzVar))
+	{
+		return false;
+	}
+	const float PreviousStepHz = StepHzVar->GetFloat();
+	StepHzVar->Set(StepHz, ECVF_SetByCode);
+
+	const TArray<FVector> Reference = TraceAtFrameRate(60.0f);
+	const int32 Bounce = FindBounce(Reference);
+	AddInfo(FString::Printf(TEXT("60 fps: %d steps, bounce after step %d"), Reference.Num(), Bounce));
+
+	// Accumulated frame times can land a step either side of the end, so compare the steps every run has
+	TestTrue(TEXT("Most of the flight was stepped"), Reference.Num() >= FMath::FloorToInt(FlightSeconds * StepHz * 0.9f));
+	TestTrue(TEXT("The projectile bounced"), Bounce != INDEX_NONE);
+
+	for (const float FramesPerSecond : { 30.0f, 144.0f })
+	{
+		const TArray<FVector> Positions = TraceAtFrameRate(FramesPerSecond);
+		const int32 NumCompared = FMath::Min(Positions.Num(), Reference.Num());
+		AddInfo(FString::Printf(TEXT("%.0f fps: %d steps, bounce after step %d"), FramesPerSecond, Positions.Num(), FindBounce(Positions)));
+
+		TestTrue(FString::Printf(TEXT("%.0f fps stepped past the bounce"), FramesPerSecond), NumCompared > Bounce + 1);
+		for (int32 Index = 0; Index < NumCompared; ++Index)
+		{
+			if (!Positions[Index].Equals(Reference[Index], KINDA_SMALL_NUMBER))
+			{
+				AddError(FString::Printf(TEXT("%.0f fps leaves the 60 fps trajectory at step %d: %s vs %s"),
+					FramesPerSecond, Index, *Positions[Index].ToString(), *Reference[Index].ToString()));
+				break;
+			}
+		}
+	}
+
+	StepHzVar->Set(PreviousStepHz, ECVF_SetByCode);
+	return true;
+}
+
+#endif
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlayerInteractionComponent.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312InteractionTraceMemoryTest, "GAM312.Interaction.TraceMemory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGAM312InteractionTraceMemoryTest::RunTest(const FString& Parameters)
+{
+	// 10k traces a second at 60 fps, with room for components that only get a result every other frame
+	constexpr int32 NumTracers = 340;
+	constexpr float DeltaSeconds = 1.0f / 60.0f;
+	constexpr int32 WarmupFrames = 120;
+	constexpr int32 MeasuredFrames = 600;
+
+	FGAM312TestWorld TestWorld;
+
+	TArray<UPlayerInteractionComponent*> Components;
+	for (int32 Index = 0; Index < NumTracers; ++Index)
+	{
+		AActor* Actor = TestWorld.Spawn<AActor>(FVector(0.0f, Index * 100.0f, 100.0f));
+		UPlayerInteractionComponent* Component = NewObject<UPlayerInteractionComponent>(Actor);
+		Component->TraceInterval = 0.0f;
+		Component->RegisterComponent();
+		Components.Add(Component);
+	}
+
+	// Warm up so the async trace buffers and the hit results reach their working size
+	TestWorld.Tick(DeltaSeconds, WarmupFrames);
+
+	const uint64 UsedBefore = FPlatformMemory::GetStats().UsedPhysical;
+
+	TArray<uint64> LastFrames;
+	LastFrames.SetNumZeroed(NumTracers);
+	int64 NumTraces = 0;
+	for (int32 Frame = 0; Frame < MeasuredFrames; ++Frame)
+	{
+		TestWorld.Tick(DeltaSeconds);
+
+		for (int32 Index = 0; Index < NumTracers; ++Index)
+		{
+			if (Components[Index]->GetHoveredFrame() != LastFrames[Index])
+			{
+				LastFrames[Index] = Components[Index]->GetHoveredFrame();
+				++NumTraces;
+			}
+		}
+	}
+
+	const uint64 UsedAfter = FPlatformMemory::GetStats().UsedPhysical;
+	const double GrowthKB = (static_cast<double>(UsedAfter) - static_cast<double>(UsedBefore)) / 1024.0;
+	const double TracesPerSecond = NumTraces / (MeasuredFrames * DeltaSeconds);
+
+	AddInfo(FString::Printf(TEXT("%lld traces in %.1f s (%.0f per second), memory growth %.1f KB"),
+		NumTraces, MeasuredFrames * DeltaSeconds, TracesPerSecond, GrowthKB));
+
+	TestTrue(TEXT("At least 10k traces per second"), TracesPerSecond >= 10000.0);
+
+	// A leak of a single query params object per trace would be several MB over 100k traces
+	TestTrue(TEXT("Memory flat within 1 MB"), GrowthKB < 1024.0);
+
+	return true;
+}
+
+#endif
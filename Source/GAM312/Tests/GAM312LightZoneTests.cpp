@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312LightZoneSubsystem.h"
+#include "LightSwitchTrigger.h"
+#include "Components/PointLightComponent.h"
+#include "GameFramework/DefaultPawn.h"
+#include "Math/RandomStream.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312LightZoneOccupancyTest, "GAM312.LightZone.Occupancy", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FGAM312LightZoneOccupancyTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumZones = 1000;
+	constexpr int32 NumMovers = 500;
+	constexpr int32 NumPasses = 10;
+	constexpr int32 NumReplacedZones = 100;
+
+	// Dense enough that zones overlap each other and cell borders, and plenty of movers end up inside one
+	const FBox Area(FVector(-10000.0f, -10000.0f, 0.0f), FVector(10000.0f, 10000.0f, 1000.0f));
+	FRandomStream Random(312);
+
+	FGAM312TestWorld TestWorld;
+	UGAM312LightZoneSubsystem* LightZones = TestWorld.GetWorld()->GetSubsystem<UGAM312LightZoneSubsystem>();
+	if (!TestNotNull(TEXT("Light zone subsystem"), LightZones))
+	{
+		return false;
+	}
+
+	TArray<ALightSwitchTrigger*> Triggers;
+	for (int32 Index = 0; Index < NumZones; ++Index)
+	{
+		Triggers.Add(TestWorld.Spawn<ALightSwitchTrigger>(Random.RandPointInBox(Area)));
+	}
+
+	// Pawns register themselves as movers when they spawn, a bare APawn has no root to move
+	TArray<APawn*> Movers;
+	for (int32 Index = 0; Index < NumMovers; ++Index)
+	{
+		Movers.Add(TestWorld.Spawn<ADefaultPawn>(Random.RandPointInBox(Area)));
+	}
+
+	for (int32 Pass = 0; Pass < NumPasses; ++Pass)
+	{
+		// Halfway through, swap out some zones so removed handles are reused and the grid is rebuilt
+		if (Pass == NumPasses / 2)
+		{
+			for (int32 Index = 0; Index < NumReplacedZones; ++Index)
+			{
+				const int32 TriggerIndex = Random.RandHelper(Triggers.Num());
+				Triggers[TriggerIndex]->Destroy();
+				Triggers.RemoveAtSwap(TriggerIndex);
+			}
+			for (int32 Index = 0; Index < NumReplacedZones; ++Index)
+			{
+				Triggers.Add(TestWorld.Spawn<ALightSwitchTrigger>(Random.RandPointInBox(Area)));
+			}
+		}
+
+		for (APawn* Mover : Movers)
+		{
+			Mover->SetActorLocation(Random.RandPointInBox(Area));
+		}
+
+		const int32 Mismatches = LightZones->VerifyOccupancy();
+
+		// Brute force over the triggers themselves, each light is off exactly while a mover is in its zone
+		int32 Occupied = 0;
+		int32 WrongLights = 0;
+		for (ALightSwitchTrigger* Trigger : Triggers)
+		{
+			const bool bOccupied = Movers.ContainsByPredicate([Trigger](const APawn* Mover)
+			{
+				return FVector::DistSquared(Mover->GetActorLocation(), Trigger->GetActorLocation()) <= FMath::Square(Trigger->ZoneRadius);
+			});
+			Occupied += bOccupied ? 1 : 0;
+			WrongLights += Trigger->PointLight->IsVisible() == bOccupied ? 1 : 0;
+		}
+
+		AddInfo(FString::Printf(TEXT("Pass %d: %d of %d zones occupied, %d mismatches, %d wrong lights"), Pass, Occupied, Triggers.Num(), Mismatches, WrongLights));
+
+		TestEqual(FString::Printf(TEXT("Pass %d occupancy mismatches"), Pass), Mismatches, 0);
+		TestEqual(FString::Printf(TEXT("Pass %d lights in the wrong state"), Pass), WrongLights, 0);
+		TestTrue(FString::Printf(TEXT("Pass %d has occupied zones"), Pass), Occupied > 0);
+	}
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,142 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312SaveSubsystem.h"
+#include "Enemy.h"
+#include "HAL/FileManager.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GAM312SaveTests
+{
+	static const TCHAR* SlotName = TEXT("AutomationTest");
+
+	// What a changed enemy is saved with, distinct per enemy so a mixed up record shows
+	static float GetSavedHealth(int32 Index)
+	{
+		return 10.0f + Index;
+	}
+
+	static FVector GetSavedBaseLocation(int32 Index)
+	{
+		return FVector(Index * 10.0f, -500.0f, 250.0f);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312SaveCheckpointTest, "GAM312.Save.Checkpoint", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGAM312SaveCheckpointTest::RunTest(const FString& Parameters)
+{
+	using namespace GAM312SaveTests;
+
+	constexpr int32 NumEnemies = 10000;
+	constexpr int32 NumChanged = 100;
+	constexpr int32 GridWidth = 100;
+
+	// A slot left over from an earlier run would turn the first save into a delta
+	const FString SlotDirectory = UGAM312SaveSubsystem::GetSlotDirectory(SlotName);
+	IFileManager::Get().DeleteDirectory(*SlotDirectory, false, true);
+
+	FGAM312TestWorld TestWorld;
+	UGAM312SaveSubsystem* SaveSystem = TestWorld.GetWorld()->GetSubsystem<UGAM312SaveSubsystem>();
+	if (!TestNotNull(TEXT("Save subsystem"), SaveSystem))
+	{
+		return false;
+	}
+
+	// Enemies register with the save subsystem as they spawn
+	TArray<AEnemy*> Enemies;
+	Enemies.Reserve(NumEnemies);
+	for (int32 Index = 0; Index < NumEnemies; ++Index)
+	{
+		Enemies.Add(TestWorld.Spawn<AEnemy>(FVector((Index % GridWidth) * 200.0f, (Index / GridWidth) * 200.0f, 100.0f)));
+	}
+	TestEqual(TEXT("Every enemy is tracked"), SaveSystem->GetNumEntities(), NumEnemies);
+
+	// Full save, one record per enemy
+	TestTrue(TEXT("Full save started"), SaveSystem->Save(SlotName, true));
+	SaveSystem->FlushPendingWork();
+	{
+		const FGAM312SaveResult& Result = SaveSystem->GetLastSaveResult();
+		AddInfo(FString::Printf(TEXT("Full save: %d records, %lld bytes raw, %lld on disk, snapshot %.2f ms, write %.2f ms"),
+			Result.NumRecords, Result.RawBytes, Result.FileBytes, Result.SnapshotMs, Result.WriteMs));
+		TestTrue(TEXT("Full save succeeded"), Result.bSucceeded);
+		TestFalse(TEXT("First save is a full save"), Result.bDelta);
+		TestEqual(TEXT("Full save writes every enemy"), Result.NumRecords, NumEnemies);
+	}
+
+	// A delta after changing a few enemies writes only those
+	for (int32 Index = 0; Index < NumChanged; ++Index)
+	{
+		Enemies[Index]->Health = GetSavedHealth(Index);
+		Enemies[Index]->BaseLocation = GetSavedBaseLocation(Index);
+	}
+
+	TestTrue(TEXT("Delta save started"), SaveSystem->Save(SlotName));
+	SaveSystem->FlushPendingWork();
+	{
+		const FGAM312SaveResult& Result = SaveSystem->GetLastSaveResult();
+		AddInfo(FString::Printf(TEXT("Delta save: %d records, %lld bytes raw, %lld on disk, snapshot %.2f ms, write %.2f ms"),
+			Result.NumRecords, Result.RawBytes, Result.FileBytes, Result.SnapshotMs, Result.WriteMs));
+		TestTrue(TEXT("Delta save succeeded"), Result.bSucceeded);
+		TestTrue(TEXT("Second save is a delta"), Result.bDelta);
+		TestEqual(TEXT("Delta writes only the changed enemies"), Result.NumRecords, NumChanged);
+	}
+
+	// Only placed enemies are recorded as destroyed, so one is made to look placed before it goes
+	AEnemy* PlacedEnemy = Enemies[NumChanged];
+	const FName PlacedName = PlacedEnemy->GetFName();
+	const FVector PlacedLocation = PlacedEnemy->GetActorLocation();
+	PlacedEnemy->SetFlags(RF_WasLoaded);
+	PlacedEnemy->Destroy();
+	Enemies[NumChanged] = nullptr;
+
+	TestTrue(TEXT("Second delta save started"), SaveSystem->Save(SlotName));
+	SaveSystem->FlushPendingWork();
+	TestEqual(TEXT("Destroying one enemy writes one record"), SaveSystem->GetLastSaveResult().NumRecords, 1);
+
+	// Undo everything the save holds: the changed enemies drift, and the destroyed one comes back
+	// under its old name the way a placed actor does when the map loads again
+	for (int32 Index = 0; Index < NumChanged; ++Index)
+	{
+		Enemies[Index]->Health = 1.0f;
+		Enemies[Index]->BaseLocation = FVector::ZeroVector;
+	}
+
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Name = PlacedName;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	AEnemy* ReturnedEnemy = TestWorld.GetWorld()->SpawnActor<AEnemy>(AEnemy::StaticClass(), FTransform(PlacedLocation), SpawnParams);
+	if (!TestNotNull(TEXT("Destroyed enemy spawned again"), ReturnedEnemy))
+	{
+		return false;
+	}
+
+	TestTrue(TEXT("Load started"), SaveSystem->Load(SlotName));
+	SaveSystem->FlushPendingWork();
+	{
+		const FGAM312LoadResult& Result = SaveSystem->GetLastLoadResult();
+		AddInfo(FString::Printf(TEXT("Load: %d files, %lld bytes, read %.2f ms, apply %.2f ms"), Result.NumFiles, Result.FileBytes, Result.ReadMs, Result.ApplyMs));
+		TestTrue(TEXT("Load succeeded"), Result.bSucceeded);
+		TestEqual(TEXT("Load reads the base and both deltas"), Result.NumFiles, 3);
+	}
+
+	int32 WrongHealth = 0;
+	int32 WrongBaseLocation = 0;
+	for (int32 Index = 0; Index < NumChanged; ++Index)
+	{
+		WrongHealth += Enemies[Index]->Health == GetSavedHealth(Index) ? 0 : 1;
+		WrongBaseLocation += Enemies[Index]->BaseLocation.Equals(GetSavedBaseLocation(Index), 0.01) ? 0 : 1;
+	}
+	TestEqual(TEXT("Enemies with the wrong health after loading"), WrongHealth, 0);
+	TestEqual(TEXT("Enemies with the wrong base location after loading"), WrongBaseLocation, 0);
+	TestFalse(TEXT("Enemy destroyed in the save is destroyed again"), IsValid(ReturnedEnemy));
+
+	IFileManager::Get().DeleteDirectory(*SlotDirectory, false, true);
+	return true;
+}
+
+#endif
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312StressSubsystem.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GAM312StressTests
+{
+	// Map the scenarios run on
+	static const TCHAR* MapName = TEXT("/Game/FirstPerson/Maps/Langlash");
+
+	// Seconds to let spawning and the first physics settle before capturing
+	static const double SettleSeconds = 3.0;
+
+	// Seconds captured per scenario
+	static const float CaptureSeconds = 15.0f;
+
+	// Scenario name and the console commands that set it up, separated by ;
+	static const TCHAR* Scenarios[][2] =
+	{
+		{ TEXT("Wolves"), TEXT("gam.Stress.SpawnWolves 200; gam.Stress.Bot 1") },
+		{ TEXT("Projectiles"), TEXT("gam.Stress.FireProjectiles 60") },
+		{ TEXT("Cubes"), TEXT("gam.Stress.SpawnCubes 500") },
+		{ TEXT("CubeField"), TEXT("gam.Stress.SpawnCubeField 500") },
+		{ TEXT("Lights"), TEXT("gam.Stress.SpawnLights 1000") },
+		{ TEXT("Pickups"), TEXT("gam.Stress.SpawnPickups 5000") },
+	};
+
+	// The game world the map was opened in, PIE in the editor and the game world otherwise
+	static UWorld* FindGameWorld()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+			{
+				return Context.World();
+			}
+		}
+		return nullptr;
+	}
+}
+
+// Sets up a scenario, captures it and checks the capture against its budget and any measured baseline
+class FGAM312StressCaptureCommand : public IAutomationLatentCommand
+{
+public:
+	FGAM312StressCaptureCommand(FAutomationTestBase* InTest, const FString& InName, const FString& InCommands)
+		: Test(InTest)
+		, Name(InName)
+		, Commands(InCommands)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		UWorld* World = GAM312StressTests::FindGameWorld();
+		UGAM312StressSubsystem* Stress = World ? World->GetSubsystem<UGAM312StressSubsystem>() : nullptr;
+		if (Stress == nullptr)
+		{
+			Test->AddError(FString::Printf(TEXT("No game world with a stress subsystem for %s"), *Name));
+			return true;
+		}
+
+		switch (Phase)
+		{
+		case EPhase::Setup:
+		{
+			TArray<FString> SetupCommands;
+			Commands.ParseIntoArray(SetupCommands, TEXT(";"));
+			for (const FString& Command : SetupCommands)
+			{
+				GEngine->Exec(World, *Command.TrimStartAndEnd());
+			}
+
+			PhaseStartTime = FPlatformTime::Seconds();
+			Phase = EPhase::Settle;
+			return false;
+		}
+
+		case EPhase::Settle:
+			if (FPlatformTime::Seconds() - PhaseStartTime < GAM312StressTests::SettleSeconds)
+			{
+				return false;
+			}
+
+			Stress->StartCapture(GAM312StressTests::CaptureSeconds, TEXT("Stress_") + Name);
+			Phase = EPhase::Capture;
+			return false;
+
+		case EPhase::Capture:
+			if (Stress->IsCapturing())
+			{
+				return false;
+			}
+			break;
+		}
+
+		Test->TestTrue(FString::Printf(TEXT("Budget PerfBudgets/Stress_%s.csv found"), *Name), Stress->DidLastCaptureFindBudget());
+		Test->TestFalse(FString::Printf(TEXT("%s over its budget"), *Name), Stress->DidLastCaptureExceedBudget());
+
+		// Baselines only exist once a scenario has been measured on the reference machine
+		if (Stress->DidLastCaptureFindBaseline())
+		{
+			Test->TestFalse(FString::Printf(TEXT("%s regressed against its baseline"), *Name), Stress->DidLastCaptureRegress());
+		}
+		else
+		{
+			Test->AddInfo(FString::Printf(TEXT("No measured baseline PerfBaselines/Stress_%s.csv yet"), *Name));
+		}
+
+		Stress->Clear();
+		return true;
+	}
+
+private:
+	enum class EPhase : uint8
+	{
+		Setup,
+		Settle,
+		Capture,
+	};
+
+	FAutomationTestBase* Test;
+	FString Name;
+	FString Commands;
+	EPhase Phase = EPhase::Setup;
+	double PhaseStartTime = 0.0;
+};
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FGAM312StressTest, "GAM312.Stress", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FGAM312StressTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const auto& Scenario : GAM312StressTests::Scenarios)
+	{
+		OutBeautifiedNames.Add(Scenario[0]);
+		OutTestCommands.Add(FString(Scenario[0]) + TEXT("|") + Scenario[1]);
+	}
+}
+
+bool FGAM312StressTest::RunTest(const FString& Parameters)
+{
+	FString Name;
+	FString Commands;
+	if (!Parameters.Split(TEXT("|"), &Name, &Commands))
+	{
+		AddError(FString::Printf(TEXT("Bad stress scenario %s"), *Parameters));
+		return false;
+	}
+
+	AutomationOpenMap(GAM312StressTests::MapName);
+	ADD_LATENT_AUTOMATION_COMMAND(FGAM312StressCaptureCommand(this, Name, Commands));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/WorldSettings.h"
+#include "Misc/App.h"
+
+/**
+ * Bare game world for automation tests. It is created as a Game world so the GAM312 world subsystems
+ * initialize and get OnWorldBeginPlay the same way they do in a packaged game, and it runs under
+ * -nullrhi and -nosound. Actors spawned after construction begin play right away.
+ */
+class FGAM312TestWorld
+{
+public:
+	FGAM312TestWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("GAM312TestWorld"));
+		GEngine->CreateNewWorldContext(EWorldType::Game).SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+
+		// Without a game mode nothing starts play on the actors, do what the game mode would
+		if (!World->HasBegunPlay())
+		{
+			World->GetWorldSettings()->NotifyBeginPlay();
+		}
+	}
+
+	~FGAM312TestWorld()
+	{
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			It->RouteEndPlay(EEndPlayReason::RemovedFromWorld);
+		}
+
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	UWorld* GetWorld() const { return World; }
+
+	// Ticks the world like the engine loop would, returns the game thread time of the last frame in ms
+	double Tick(float DeltaSeconds, int32 Frames = 1)
+	{
+		double FrameMs = 0.0;
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			const double StartTime = FPlatformTime::Seconds();
+			FApp::SetDeltaTime(DeltaSeconds);
+			World->Tick(LEVELTICK_All, DeltaSeconds);
+			++GFrameCounter;
+			FrameMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+		}
+		return FrameMs;
+	}
+
+	template <typename ActorType>
+	ActorType* Spawn(const FVector& Location = FVector::ZeroVector, UClass* Class = ActorType::StaticClass())
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		return World->SpawnActor<ActorType>(Class, FTransform(Location), SpawnParams);
+	}
+
+private:
+	UWorld* World = nullptr;
+};
+
+#endif
@@ -0,0 +1,149 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "GAM312TravelSubsystem.h"
+#include "GAM312Character.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace GAM312TravelTests
+{
+	// Map the test starts on and the map it travels to
+	static const TCHAR* StartMapName = TEXT("/Game/FirstPerson/Maps/Langlash");
+	static const TCHAR* DestinationMapName = TEXT("/Game/FirstPerson/Maps/FirstPersonMap");
+
+	// Health given to the character before leaving, unlikely to be anything's default
+	static constexpr float CarriedHealth = 37.0f;
+
+	// Seconds to wait for the player's pawn on the new map once the travel has finished
+	static constexpr double PawnWaitSeconds = 10.0;
+
+	// The game world the map was opened in, PIE in the editor and the game world otherwise
+	static UWorld* FindGameWorld()
+	{
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			if ((Context.WorldType == EWorldType::Game || Context.WorldType == EWorldType::PIE) && Context.World())
+			{
+				return Context.World();
+			}
+		}
+		return nullptr;
+	}
+
+	static AGAM312Character* FindPlayerCharacter(UWorld* World)
+	{
+		APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+		return PlayerController ? Cast<AGAM312Character>(PlayerController->GetPawn()) : nullptr;
+	}
+}
+
+// Travels to the destination map and checks the stall budget and the state carried over
+class FGAM312TravelCommand : public IAutomationLatentCommand
+{
+public:
+	explicit FGAM312TravelCommand(FAutomationTestBase* InTest)
+		: Test(InTest)
+	{
+	}
+
+	virtual bool Update() override
+	{
+		using namespace GAM312TravelTests;
+
+		UWorld* World = FindGameWorld();
+		UGAM312TravelSubsystem* Travel = (World && World->GetGameInstance()) ? World->GetGameInstance()->GetSubsystem<UGAM312TravelSubsystem>() : nullptr;
+		if (Travel == nullptr)
+		{
+			Test->AddError(TEXT("No game world with a travel subsystem"));
+			return true;
+		}
+
+		switch (Phase)
+		{
+		case EPhase::Start:
+		{
+			AGAM312Character* Character = FindPlayerCharacter(World);
+			if (!Test->TestNotNull(TEXT("Player character on the start map"), Character))
+			{
+				return true;
+			}
+			Character->Health = CarriedHealth;
+
+			if (!Test->TestTrue(TEXT("Travel started"), Travel->TravelTo(DestinationMapName)))
+			{
+				return true;
+			}
+			Phase = EPhase::Travel;
+			return false;
+		}
+
+		case EPhase::Travel:
+			// The subsystem gives up on its own after gam.Travel.Timeout
+			if (Travel->IsTraveling())
+			{
+				return false;
+			}
+
+			Test->AddInfo(FString::Printf(TEXT("Total stall %.1f ms, longest frame %.1f ms, budget %.1f ms"), Travel->GetStallMs(), Travel->GetLongestFrameMs(),
+				IConsoleManager::Get().FindConsoleVariable(TEXT("gam.Travel.StallBudgetMs"))->GetFloat()));
+			if (!Test->TestTrue(TEXT("Travel arrived"), Travel->DidLastTravelArrive()))
+			{
+				return true;
+			}
+			Test->TestFalse(TEXT("Travel stall within gam.Travel.StallBudgetMs"), Travel->DidLastTravelExceedBudget());
+
+			PhaseStartTime = FPlatformTime::Seconds();
+			Phase = EPhase::Pawn;
+			return false;
+
+		case EPhase::Pawn:
+			break;
+		}
+
+		// The pawn class may still be loading when the measurement ends, its health has to survive that
+		AGAM312Character* Character = FindPlayerCharacter(World);
+		if (Character == nullptr && FPlatformTime::Seconds() - PhaseStartTime < PawnWaitSeconds)
+		{
+			return false;
+		}
+
+		if (Test->TestNotNull(TEXT("Player character on the destination map"), Character))
+		{
+			Test->TestTrue(TEXT("Arrived on the destination map"), World->GetOutermost()->GetName().EndsWith(TEXT("FirstPersonMap")));
+			Test->TestEqual(TEXT("Health carried through the travel"), Character->Health, CarriedHealth);
+		}
+		return true;
+	}
+
+private:
+	enum class EPhase : uint8
+	{
+		Start,
+		Travel,
+		Pawn,
+	};
+
+	FAutomationTestBase* Test;
+	EPhase Phase = EPhase::Start;
+	double PhaseStartTime = 0.0;
+};
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312TravelSeamlessTest, "GAM312.Travel.Seamless", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGAM312TravelSeamlessTest::RunTest(const FString& Parameters)
+{
+	AutomationOpenMap(GAM312TravelTests::StartMapName);
+	ADD_LATENT_AUTOMATION_COMMAND(FGAM312TravelCommand(this));
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TP_WeaponComponent.h"
+#include "Cube.h"
+#include "GAM312Character.h"
+#include "GAM312DamageFlashComponent.h"
+#include "Camera/PlayerCameraManager.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/AutomationTest.h"
+#include "Tests/GAM312TestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FGAM312WeaponFireRateTest, "GAM312.Weapon.FireRate", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FGAM312WeaponFireRateTest::RunTest(const FString& Parameters)
+{
+	constexpr float RoundsPerMinute = 1200.0f;
+	constexpr float BurstSeconds = 5.0f;
+
+	FGAM312TestWorld TestWorld;
+
+	AGAM312Character* Character = TestWorld.Spawn<AGAM312Character>(FVector(0.0f, 0.0f, 500.0f));
+	APlayerController* Controller = TestWorld.Spawn<APlayerController>();
+	if (!TestNotNull(TEXT("Character spawned"), Character) || !TestNotNull(TEXT("Controller spawned"), Controller))
+	{
+		return false;
+	}
+	Controller->Possess(Character);
+
+	UTP_WeaponComponent* Weapon = NewObject<UTP_WeaponComponent>(Character);
+	Weapon->FireMode = EGAM312FireMode::Hitscan;
+	Weapon->RoundsPerMinute = RoundsPerMinute;
+	Weapon->RegisterComponent();
+	Weapon->AttachWeapon(Character);
+
+	// A cube in the line of fire, every shot should reach it through the cube's own damage path
+	const FVector AimLocation = Controller->PlayerCameraManager->GetCameraLocation();
+	const FVector AimDirection = Controller->PlayerCameraManager->GetCameraRotation().Vector();
+	ACube* Cube = TestWorld.Spawn<ACube>(AimLocation + AimDirection * 500.0f);
+	Cube->CubeMesh->SetSimulatePhysics(false);
+	Cube->CubeMesh->SetStaticMesh(LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube")));
+
+	for (const float FramesPerSecond : { 60.0f, 30.0f })
+	{
+		Weapon->StartFiring();
+		TestWorld.Tick(1.0f / FramesPerSecond, FMath::RoundToInt(BurstSeconds * FramesPerSecond));
+
+		const int32 Shots = Weapon->GetBurstShots();
+		const double MicrosecondsPerShot = Weapon->GetBurstMicrosecondsPerShot();
+		Weapon->StopFiring();
+
+		// The first shot goes out on the press, the rest at the fire rate
+		const int32 ExpectedShots = 1 + FMath::FloorToInt(BurstSeconds * RoundsPerMinute / 60.0f);
+		AddInfo(FString::Printf(TEXT("%.0f fps: %d shots, expected %d, %.1f us per shot"), FramesPerSecond, Shots, ExpectedShots, MicrosecondsPerShot));
+
+		// Float accumulation can move the last shot across the end of the burst. The cost per shot is
+		// only reported, wall clock time depends on the machine running the test
+		TestTrue(FString::Printf(TEXT("%.0f fps keeps the fire rate"), FramesPerSecond), FMath::Abs(Shots - ExpectedShots) <= 1);
+	}
+
+	TestTrue(TEXT("Hitscan hits flash the cube"), Cube->DamageFlash->GetHitTime(Cube->CubeMesh) > 0.0f);
+
+	return true;
+}
+
+#endif
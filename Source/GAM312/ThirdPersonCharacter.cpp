@@ -2,6 +2,7 @@
 
 
 #include "ThirdPersonCharacter.h"
+#include "ThirdPersonMovementComponent.h"
 #include "GameFramework/SpringArmComponent.h"
 #include "Camera/CameraComponent.h"
 #include "Components/InputComponent.h"
@@ -11,7 +12,8 @@
 #include "GameFramework/CharacterMovementComponent.h"
 
 // Sets default values
-AThirdPersonCharacter::AThirdPersonCharacter()
+AThirdPersonCharacter::AThirdPersonCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UThirdPersonMovementComponent>(ACharacter::CharacterMovementComponentName))
 {
  	// Set this character to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
@@ -37,10 +39,11 @@ void AThirdPersonCharacter::BeginPlay()
 	WalkingSpeed = 200.0f;
 	RunningSpeed = 600.0f;
 
-	// Set the initial walk speed
-	if (GetCharacterMovement())
+	// Set the initial walk and sprint speeds
+	if (UThirdPersonMovementComponent* MoveComp = GetThirdPersonMovement())
 	{
-		GetCharacterMovement()->MaxWalkSpeed = WalkingSpeed;
+		MoveComp->MaxWalkSpeed = WalkingSpeed;
+		MoveComp->SprintSpeed = RunningSpeed;
 	}
 
 	// Initially not sprinting
@@ -112,19 +115,25 @@ void AThirdPersonCharacter::MoveForward(float Value)
 
 void AThirdPersonCharacter::SprintStart()
 {
-	if (GetCharacterMovement())
+	// Sprint goes through the saved move so the server predicts the same speed
+	if (UThirdPersonMovementComponent* MoveComp = GetThirdPersonMovement())
 	{
-		GetCharacterMovement()->MaxWalkSpeed = RunningSpeed;
+		MoveComp->SetSprinting(true);
 		isSprinting = true;
 	}
 }
 
 void AThirdPersonCharacter::SprintStop()
 {
-	if (GetCharacterMovement())
+	if (UThirdPersonMovementComponent* MoveComp = GetThirdPersonMovement())
 	{
-		GetCharacterMovement()->MaxWalkSpeed = WalkingSpeed;
+		MoveComp->SetSprinting(false);
 		isSprinting = false;
 	}
 }
 
+UThirdPersonMovementComponent* AThirdPersonCharacter::GetThirdPersonMovement() const
+{
+	return Cast<UThirdPersonMovementComponent>(GetCharacterMovement());
+}
+
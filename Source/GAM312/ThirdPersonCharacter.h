@@ -6,6 +6,8 @@
 #include "GameFramework/Character.h"
 #include "ThirdPersonCharacter.generated.h"
 
+class UThirdPersonMovementComponent;
+
 UCLASS()
 class GAM312_API AThirdPersonCharacter : public ACharacter
 {
@@ -13,7 +15,7 @@ class GAM312_API AThirdPersonCharacter : public ACharacter
 
 public:
 	// Sets default values for this character's properties
-	AThirdPersonCharacter();
+	AThirdPersonCharacter(const FObjectInitializer& ObjectInitializer);
 
 protected:
 	// Called when the game starts or when spawned
@@ -34,6 +36,9 @@ public:
 	void SprintStart();
 	void SprintStop();
 
+	// Returns the movement component with sprint prediction
+	UThirdPersonMovementComponent* GetThirdPersonMovement() const;
+
 	// Camera Components
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
 	class USpringArmComponent* CameraBoom;
@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ThirdPersonMovementComponent.h"
+#include "GameFramework/Character.h"
+
+// Sets default values for this component's properties
+UThirdPersonMovementComponent::UThirdPersonMovementComponent()
+{
+	SprintSpeed = 600.0f;
+	bWantsToSprint = false;
+}
+
+void UThirdPersonMovementComponent::SetSprinting(bool bNewSprinting)
+{
+	bWantsToSprint = bNewSprinting;
+}
+
+float UThirdPersonMovementComponent::GetMaxSpeed() const
+{
+	// Sprint only changes ground speed, falling and swimming keep their own limits
+	if (bWantsToSprint && IsMovingOnGround())
+	{
+		return SprintSpeed;
+	}
+
+	return Super::GetMaxSpeed();
+}
+
+void UThirdPersonMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	// The server reads the sprint state out of the move flags
+	bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+}
+
+FNetworkPredictionData_Client* UThirdPersonMovementComponent::GetPredictionData_Client() const
+{
+	check(PawnOwner != nullptr);
+
+	if (ClientPredictionData == nullptr)
+	{
+		UThirdPersonMovementComponent* MutableThis = const_cast<UThirdPersonMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_ThirdPerson(*this);
+	}
+
+	return ClientPredictionData;
+}
+
+void FSavedMove_ThirdPerson::Clear()
+{
+	Super::Clear();
+
+	bSavedWantsToSprint = false;
+}
+
+uint8 FSavedMove_ThirdPerson::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+
+	if (bSavedWantsToSprint)
+	{
+		Result |= FLAG_Custom_0;
+	}
+
+	return Result;
+}
+
+bool FSavedMove_ThirdPerson::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	// Moves with a different sprint state can not be merged or the change would be lost
+	if (bSavedWantsToSprint != static_cast<FSavedMove_ThirdPerson*>(NewMove.Get())->bSavedWantsToSprint)
+	{
+		return false;
+	}
+
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_ThirdPerson::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	if (UThirdPersonMovementComponent* MoveComp = Cast<UThirdPersonMovementComponent>(C->GetCharacterMovement()))
+	{
+		bSavedWantsToSprint = MoveComp->bWantsToSprint;
+	}
+}
+
+void FSavedMove_ThirdPerson::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	// Restore the sprint state before the move is replayed after a correction
+	if (UThirdPersonMovementComponent* MoveComp = Cast<UThirdPersonMovementComponent>(C->GetCharacterMovement()))
+	{
+		MoveComp->bWantsToSprint = bSavedWantsToSprint;
+	}
+}
+
+FNetworkPredictionData_Client_ThirdPerson::FNetworkPredictionData_Client_ThirdPerson(const UCharacterMovementComponent& ClientMovement)
+	: Super(ClientMovement)
+{
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_ThirdPerson::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_ThirdPerson());
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ThirdPersonMovementComponent.generated.h"
+
+/**
+ * Character movement for AThirdPersonCharacter. Sprinting is sent to the server as a compressed flag
+ * in every saved move, so the client can predict the speed change and the server replays it without
+ * extra RPCs or corrections.
+ */
+UCLASS()
+class GAM312_API UThirdPersonMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+	friend class FSavedMove_ThirdPerson;
+
+public:
+	// Sets default values for this component's properties
+	UThirdPersonMovementComponent();
+
+	// Speed used while walking with sprint held
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Movement")
+	float SprintSpeed;
+
+	// Sets whether the owner wants to sprint, called from input on the owning client
+	void SetSprinting(bool bNewSprinting);
+
+	// Returns true if the owner is currently asking to sprint
+	bool IsSprinting() const { return bWantsToSprint; }
+
+	virtual float GetMaxSpeed() const override;
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+private:
+	// Sprint input, part of the saved move so it is replayed on the server and on client corrections
+	uint8 bWantsToSprint : 1;
+};
+
+// Saved move that carries the sprint state
+class FSavedMove_ThirdPerson : public FSavedMove_Character
+{
+	typedef FSavedMove_Character Super;
+
+public:
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+
+	uint8 bSavedWantsToSprint : 1;
+};
+
+// Client prediction data that allocates FSavedMove_ThirdPerson moves
+class FNetworkPredictionData_Client_ThirdPerson : public FNetworkPredictionData_Client_Character
+{
+	typedef FNetworkPredictionData_Client_Character Super;
+
+public:
+	FNetworkPredictionData_Client_ThirdPerson(const UCharacterMovementComponent& ClientMovement);
+
+	virtual FSavedMovePtr AllocateNewMove() override;
+};